@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "gl_stub.hpp"
+#include "../src/gl/hud.hpp"
+#include "../src/util/alloc_track.hpp"
+#include "../src/util/counters.hpp"
+#include "../src/util/memory.hpp"
+#include "../src/util/text.hpp"
+
+// every heap allocation in the process goes through these
+#ifdef ALLOC_TRACK
+// the tracking build already replaces them
+static std::uint64_t heap_allocations() {
+  std::uint64_t n = 0;
+  for (int t = 0; t < int(alloc::tag::count); ++t) {
+    n += alloc::stats(alloc::tag(t)).allocations;
+  }
+  return n;
+}
+#else
+static std::uint64_t allocation_count = 0;
+static std::uint64_t heap_allocations() { return allocation_count; }
+
+void *operator new(std::size_t n) {
+  ++allocation_count;
+  if (void *p = std::malloc(n ? n : 1)) { return p; }
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t n, std::align_val_t a) {
+  ++allocation_count;
+  const std::size_t align = static_cast<std::size_t>(a);
+  if (void *p = std::aligned_alloc(align, (n + align - 1) / align * align)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+#endif
+
+constexpr int warmup = 10;
+constexpr int frames = 1000;
+constexpr int objects = 4096;
+
+template <typename F>
+double time_ms(F f, const int n=1) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+// the transient work of a frame: cull into a list of visible objects, sort
+// it by material, bucket it into draws and name a few of them for a debug
+// overlay. everything is dropped at the end of the frame
+static std::size_t frame_work(
+  const int frame, std::pmr::memory_resource *r, text::run_cache &labels
+) {
+  std::pmr::vector<std::uint32_t> visible(r);
+  for (int i = 0; i < objects; ++i) {
+    if ((i * 7 + frame) % 3 != 0) { visible.push_back(i); }
+  }
+  std::sort(visible.begin(), visible.end(), [](auto a, auto b) {
+    return a % 16 < b % 16 || (a % 16 == b % 16 && a < b);
+  });
+
+  std::pmr::vector<std::pmr::vector<std::uint32_t>> draws(r);
+  for (const std::uint32_t v : visible) {
+    if (draws.size() <= v % 16) { draws.resize(v % 16 + 1); }
+    draws[v % 16].push_back(v);
+  }
+
+  std::size_t glyphs = 0;
+  std::pmr::string name(r);
+  for (std::size_t d = 0; d < draws.size(); ++d) {
+    name = "material ";
+    name += std::to_string(d).c_str();
+    name += " draws this many objects";
+    glyphs += labels.get(name, 16).quads.size();
+  }
+
+  return visible.size() + glyphs;
+}
+
+// what main publishes, moving every frame
+static void publish(const int frame, const counters::id frame_time) {
+  counters::set(frame_time, 16000 + frame * 37 % 900);
+  counters::count(counters::engine::draw_calls, 40 + frame % 9);
+  counters::count(counters::engine::state_changes, 90 + frame % 13);
+  counters::count(counters::engine::bytes_streamed, 65536 + frame * 64);
+}
+
+static void report(
+  const char *label, const std::uint64_t allocations, const double ms
+) {
+  std::cout << "  " << std::left << std::setw(24) << label << std::right;
+  std::cout << std::setw(10) << double(allocations) / frames;
+  std::cout << " allocations/frame " << std::setw(10) << ms << " ms/frame\n";
+}
+
+int main() {
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << objects << " objects, " << frames << " frames after ";
+  std::cout << warmup << " of warmup\n";
+
+  std::size_t sink = 0;
+  text::run_cache labels;
+
+  // plain heap, what the same containers do without a resource
+  for (int f = 0; f < warmup; ++f) {
+    sink += frame_work(f, std::pmr::new_delete_resource(), labels);
+  }
+  std::uint64_t before = heap_allocations();
+  double ms = time_ms([&]() {
+    static int f = warmup;
+    sink += frame_work(f++, std::pmr::new_delete_resource(), labels);
+    counters::end_frame();
+  }, frames);
+  report("heap", heap_allocations() - before, ms);
+
+  // the frame arena, reset where main resets it after the swap
+  mem::arena &arena = mem::frame_arena();
+  for (int f = 0; f < warmup; ++f) {
+    sink += frame_work(f, &arena, labels);
+    arena.reset();
+  }
+  before = heap_allocations();
+  ms = time_ms([&]() {
+    static int f = warmup;
+    sink += frame_work(f++, &arena, labels);
+    counters::end_frame();
+    arena.reset();
+  }, frames);
+  report("frame arena", heap_allocations() - before, ms);
+  std::cout << "    arena " << arena.capacity() / 1024 << " KiB, peak ";
+  std::cout << arena.peak / 1024 << " KiB, " << arena.grows << " grows, ";
+  std::cout << arena.overflows << " overflowing allocations\n";
+
+  // the hud as main draws it, through the text renderer and a quad batch
+  // on stubbed gl. values are reformatted every `refresh_frames`, so the
+  // warmup runs long enough for every digit to have been drawn once
+  gl_stub::install();
+  Hud hud = createHud(0);
+  hud.visible = true;
+  const counters::id frame_time = counters::add(
+    "frame.time_us", counters::kind_t::gauge, counters::unit_t::microseconds
+  );
+  addHudCounter(hud, "frame.time_us", "frame time", true, 0xff60ff60);
+  addHudCounter(hud, "gl.draw_calls", "draw calls", true, 0xffffc060);
+  addHudCounter(hud, "gl.state_changes", "state changes");
+  addHudCounter(hud, "gl.texture_uploads", "texture uploads");
+  addHudCounter(hud, "gl.bytes_streamed", "bytes streamed", true, 0xff60c0ff);
+  addHudCounter(hud, "memory.frame_arena", "frame arena");
+
+  for (int f = 0; f < int(hud.refresh_frames) * 20; ++f) {
+    publish(f, frame_time);
+    counters::end_frame();
+    drawHud(hud, 720);
+    arena.reset();
+  }
+  const std::uint64_t glyphs = hud.text.glyphs_drawn;
+  const std::uint64_t draws = hud.batch.draws;
+  before = heap_allocations();
+  ms = time_ms([&]() {
+    static int f = 0;
+    publish(f++, frame_time);
+    counters::end_frame();
+    drawHud(hud, 720);
+    arena.reset();
+  }, frames);
+  report("hud", heap_allocations() - before, ms);
+  std::cout << "    " << (hud.text.glyphs_drawn - glyphs) / frames;
+  std::cout << " glyphs, " << (hud.batch.draws - draws) / frames;
+  std::cout << " draws per frame\n";
+  destroyHud(hud);
+
+  // a node container churning through handles, with and without a pool
+  std::list<std::uint64_t> heap_nodes;
+  before = heap_allocations();
+  ms = time_ms([&]() {
+    for (int i = 0; i < 256; ++i) { heap_nodes.push_back(i); }
+    for (int i = 0; i < 256; ++i) { heap_nodes.pop_front(); }
+  }, frames);
+  report("list, heap", heap_allocations() - before, ms);
+
+  mem::pool_resource pool(sizeof(std::uint64_t) * 3, 256);
+  std::pmr::list<std::uint64_t> pool_nodes(&pool);
+  for (int i = 0; i < 256; ++i) { pool_nodes.push_back(i); }
+  pool_nodes.clear();
+  before = heap_allocations();
+  ms = time_ms([&]() {
+    for (int i = 0; i < 256; ++i) { pool_nodes.push_back(i); }
+    for (int i = 0; i < 256; ++i) { pool_nodes.pop_front(); }
+  }, frames);
+  report("list, pool", heap_allocations() - before, ms);
+  std::cout << "    pool " << pool.chunks << " chunks, peak ";
+  std::cout << pool.peak_in_use << " blocks, " << pool.fallbacks;
+  std::cout << " fallbacks\n";
+
+  return sink == 0;
+}
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../src/util/asset_db.hpp"
+
+namespace fs = std::filesystem;
+
+constexpr int sources = 2000;
+constexpr int pack_size = 20; // sources per pack
+constexpr std::size_t source_bytes = 16 << 10;
+
+double ms_since(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+void write_file(const fs::path &p, const std::string &data) {
+  std::ofstream(p, std::ios::out | std::ios::binary | std::ios::trunc) << data;
+}
+
+std::string read_file(const fs::path &p) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(ifs), {});
+}
+
+// two stages: each source is summarised (its size and first byte, so
+// some edits leave the summary alone), and every `pack_size` summaries are
+// packed together
+void add_rules(assetdb::db &d, const fs::path &dir) {
+  for (int i = 0; i < sources; ++i) {
+    const std::string n = std::to_string(i);
+
+    assetdb::rule r;
+    r.tool = "summary";
+    r.inputs = {dir / (n + ".src")};
+    r.outputs = {dir / "out" / (n + ".sum")};
+    r.build = [](const auto &in, const auto &out) {
+      const std::string s = read_file(in[0]);
+      write_file(out[0], std::to_string(s.size()) + " " + s.substr(0, 1));
+      return true;
+    };
+    assetdb::add(d, std::move(r));
+  }
+
+  for (int p = 0; p < sources / pack_size; ++p) {
+    assetdb::rule r;
+    r.tool = "pack";
+    for (int i = p * pack_size; i < (p + 1) * pack_size; ++i) {
+      r.inputs.push_back(dir / "out" / (std::to_string(i) + ".sum"));
+    }
+    r.outputs = {dir / "out" / (std::to_string(p) + ".pack")};
+    r.build = [](const auto &in, const auto &out) {
+      std::string packed;
+      for (const auto &p : in) { packed += read_file(p) + "\n"; }
+      write_file(out[0], packed);
+      return true;
+    };
+    assetdb::add(d, std::move(r));
+  }
+}
+
+// one run as a fresh process would do it: load the state, register the
+// rules, bring everything up to date and save. false unless it built and
+// hashed as many as expected
+bool run(
+  const fs::path &dir, const char *what, const std::uint64_t built,
+  const std::uint64_t hashed
+) {
+  const auto start = std::chrono::steady_clock::now();
+
+  auto d = assetdb::open(dir / "assets.db");
+  add_rules(*d, dir);
+  assetdb::build_all(*d);
+  assetdb::save(*d);
+
+  const double ms = ms_since(start);
+  std::cout << "  " << std::left << std::setw(28) << what << std::right;
+  std::cout << std::setw(10) << ms << " ms";
+  std::cout << std::setw(7) << d->built << " built";
+  std::cout << std::setw(7) << d->hashed << " hashed";
+  const bool ok = d->built == built && d->hashed == hashed;
+  if (!ok) {
+    std::cout << ", FAILED: expected " << built << " and " << hashed;
+  }
+  std::cout << "\n";
+
+  return ok;
+}
+
+int main() {
+  const fs::path dir = fs::temp_directory_path() / "qogl-bench-assets";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  for (int i = 0; i < sources; ++i) {
+    write_file(
+      dir / (std::to_string(i) + ".src"),
+      std::string(source_bytes, char('a' + i % 26))
+    );
+  }
+  const fs::path edited = dir / "7.src";
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << sources << " sources of " << (source_bytes >> 10) << " KiB, ";
+  std::cout << sources << " summaries, " << sources / pack_size << " packs\n";
+
+  bool ok = run(
+    dir, "cold", sources + sources / pack_size,
+    sources * 2 + sources / pack_size
+  );
+  ok &= run(dir, "no change", 0, 0);
+
+  // same bytes, new mtime: hashed again, nothing rebuilt
+  fs::last_write_time(
+    edited, fs::last_write_time(edited) + std::chrono::seconds(1)
+  );
+  ok &= run(dir, "touched", 0, 1);
+
+  // the summary comes out the same, so its pack is left alone
+  std::string s = read_file(edited);
+  s.back() = '!';
+  write_file(edited, s);
+  ok &= run(dir, "edit, same summary", 1, 2);
+
+  s[0] = '!';
+  write_file(edited, s);
+  ok &= run(dir, "edit", 2, 3);
+
+  fs::remove(dir / "out" / "3.pack");
+  ok &= run(dir, "output deleted", 1, 1);
+
+  auto d = assetdb::open(dir / "assets.db");
+  const std::size_t dependents = assetdb::dependents(*d, edited).size();
+  std::cout << "  " << dependents << " dependents of one source\n";
+  ok &= dependents == 2;
+
+  fs::remove_all(dir);
+
+  return ok ? 0 : 1;
+}
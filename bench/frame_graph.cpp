@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gl_stub.hpp"
+#include "../src/gl/frame_graph.hpp"
+#include "../src/gl/render_target.hpp"
+
+// the graph runs without a window, on stubbed gl entry points, so the
+// pool's targets and framebuffers can be counted
+constexpr int frames = 10000;
+
+std::vector<std::string> ran;
+
+// a deferred frame declared back to front, so compiling has to sort it.
+// the debug view reaches no output and is culled; ldr has the size and
+// format of albedo and starts after albedo's last reader, so the two share
+// a target
+void build(FrameGraph &g, const Framebuffer &window) {
+  const int w = 1280;
+  const int h = 720;
+  const auto out = importFramebuffer(g, "window", window);
+  const auto ldr = createTransient(g, "ldr", {w, h, GL_RGBA8});
+  const auto bloom_up = createTransient(
+    g, "bloom up", {w / 2, h / 2, GL_RGBA16F}
+  );
+  const auto bloom_down = createTransient(
+    g, "bloom down", {w / 2, h / 2, GL_RGBA16F}
+  );
+  const auto hdr = createTransient(g, "hdr", {w, h, GL_RGBA16F});
+  const auto debug = createTransient(g, "debug", {w, h, GL_RGBA8});
+  const auto albedo = createTransient(g, "albedo", {w, h, GL_RGBA8});
+  const auto normals = createTransient(g, "normals", {w, h, GL_RGBA16F});
+  const auto depth = createTransient(
+    g, "depth", {w, h, GL_DEPTH_COMPONENT24}
+  );
+
+  auto pass = [&](
+    const char *name, std::vector<FrameResource> reads,
+    std::vector<FrameResource> writes
+  ) {
+    const int p = addPass(g, name, [name](FramePassContext &) {
+      ran.push_back(name);
+    });
+    for (const auto r : reads) { passReads(g, p, r); }
+    for (const auto r : writes) { passWrites(g, p, r); }
+  };
+
+  pass("present", {ldr}, {out});
+  pass("tonemap", {hdr, bloom_up}, {ldr});
+  pass("bloom up", {bloom_down}, {bloom_up});
+  pass("bloom down", {hdr}, {bloom_down});
+  pass("debug view", {normals}, {debug});
+  pass("lighting", {albedo, normals, depth}, {hdr});
+  pass("gbuffer", {}, {albedo, normals, depth});
+}
+
+bool check(const char *what, const bool ok) {
+  std::cout << "  " << std::left << std::setw(36) << what << std::right;
+  std::cout << (ok ? "ok" : "FAILED") << "\n";
+  return ok;
+}
+
+int main() {
+  gl_stub::install();
+
+  const Framebuffer window = {0, 1280, 720};
+  RenderTargetPool pool = createRenderTargetPool();
+  FrameGraph g;
+  bool ok = true;
+
+  build(g, window);
+  ok &= check("compiles", compileFrameGraph(g));
+
+  std::vector<std::string> order;
+  for (const int p : g.order) { order.push_back(g.passes[p].name); }
+  ok &= check("sorted", order == std::vector<std::string>{
+    "gbuffer", "lighting", "bloom down", "bloom up", "tonemap", "present"
+  });
+  ok &= check("one pass culled", g.culled_passes == 1);
+
+  beginRenderTargetFrame(pool);
+  executeFrameGraph(g, pool);
+  ok &= check("ran in order", ran == order);
+  ok &= check("8 transients on 6 targets", (
+    g.transient_targets == 8 && g.physical_targets == 6 &&
+    pool.stats.created == 6
+  ));
+
+  beginRenderTargetFrame(pool);
+  executeFrameGraph(g, pool);
+  ok &= check("second frame creates nothing", (
+    pool.stats.created == 0 && pool.stats.reused == 7 &&
+    pool.stats.framebuffers_created == 0
+  ));
+
+  resetFrameGraph(g);
+  ok &= check("reset clears everything", (
+    g.passes.empty() && g.resources.empty() && g.order.empty() &&
+    g.culled_passes == 0 && g.transient_targets == 0 &&
+    g.physical_targets == 0
+  ));
+
+  // the window plus an attachment in one pass
+  const auto out = importFramebuffer(g, "window", window);
+  const auto extra = createTransient(g, "extra", {64, 64, GL_RGBA8});
+  const int p = addPass(g, "both", {});
+  passWrites(g, p, out);
+  passWrites(g, p, extra);
+  ok &= check("import with another write rejected", !compileFrameGraph(g));
+
+  resetFrameGraph(g);
+  const auto a = createTransient(g, "a", {64, 64, GL_RGBA8});
+  const auto b = createTransient(g, "b", {64, 64, GL_RGBA8});
+  const int first = addPass(g, "first", {});
+  passReads(g, first, b);
+  passWrites(g, first, a);
+  const int second = addPass(g, "second", {});
+  passReads(g, second, a);
+  passWrites(g, second, b);
+  ok &= check("cycle rejected", !compileFrameGraph(g));
+
+  const double compile_ms = [&]() {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+      resetFrameGraph(g);
+      build(g, window);
+      compileFrameGraph(g);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  }();
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "  " << std::left << std::setw(36) << "build + compile";
+  std::cout << std::right << compile_ms * 1000 / frames << " us/frame\n";
+
+  destroyRenderTargetPool(pool);
+
+  return ok ? 0 : 1;
+}
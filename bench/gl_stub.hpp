@@ -0,0 +1,131 @@
+#ifndef __GL_STUB_HPP__
+#define __GL_STUB_HPP__
+/*
+  gl entry points for benches that run renderer code without a window
+
+  every function the frame graph, render targets, quad batches, the text
+  renderer and the tilemap renderer call is replaced by a stub: names are
+  handed out in order, syncs are always signalled, framebuffers always
+  complete, and buffer maps point into one block of host memory. nothing
+  is drawn, so only the cpu side of the code is measured.
+*/
+#include <cstddef>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+namespace gl_stub {
+  constexpr std::size_t mapped_size = 16 << 20;
+
+  // backs every glMapBufferRange, at the mapped offset
+  alignas(16) inline unsigned char mapped[mapped_size];
+  inline GLuint next_name = 1;
+
+  inline void APIENTRY gen_names(GLsizei n, GLuint *names) {
+    for (GLsizei i = 0; i < n; ++i) { names[i] = next_name++; }
+  }
+
+  inline GLenum APIENTRY framebuffer_complete(GLenum) {
+    return GL_FRAMEBUFFER_COMPLETE;
+  }
+
+  inline void *APIENTRY map_range(
+    GLenum, GLintptr offset, GLsizeiptr length, GLbitfield
+  ) {
+    return std::size_t(offset + length) <= mapped_size ? mapped + offset
+      : nullptr;
+  }
+
+  inline GLboolean APIENTRY unmap(GLenum) { return GL_TRUE; }
+
+  inline GLsync APIENTRY fence(GLenum, GLbitfield) {
+    return reinterpret_cast<GLsync>(&next_name);
+  }
+
+  inline GLenum APIENTRY client_wait(GLsync, GLbitfield, GLuint64) {
+    return GL_ALREADY_SIGNALED;
+  }
+
+  inline GLint APIENTRY uniform_location(GLuint, const GLchar *) {
+    return 0;
+  }
+
+  template <typename... Args>
+  void APIENTRY ignore(Args...) {}
+
+  inline void install() {
+    glad_glGenTextures = gen_names;
+    glad_glGenRenderbuffers = gen_names;
+    glad_glGenFramebuffers = gen_names;
+    glad_glGenBuffers = gen_names;
+    glad_glGenVertexArrays = gen_names;
+    glad_glGenSamplers = gen_names;
+    glad_glCheckFramebufferStatus = framebuffer_complete;
+    glad_glMapBufferRange = map_range;
+    glad_glUnmapBuffer = unmap;
+    glad_glFenceSync = fence;
+    glad_glClientWaitSync = client_wait;
+
+    glad_glGetIntegerv = ignore<GLenum, GLint *>;
+    glad_glEnable = ignore<GLenum>;
+    glad_glDisable = ignore<GLenum>;
+    glad_glBlendFunc = ignore<GLenum, GLenum>;
+    glad_glPixelStorei = ignore<GLenum, GLint>;
+    glad_glViewport = ignore<GLint, GLint, GLsizei, GLsizei>;
+    glad_glUseProgram = ignore<GLuint>;
+    glad_glGetUniformLocation = uniform_location;
+    glad_glUniform1f = ignore<GLint, GLfloat>;
+    glad_glUniform2f = ignore<GLint, GLfloat, GLfloat>;
+
+    glad_glActiveTexture = ignore<GLenum>;
+    glad_glBindTexture = ignore<GLenum, GLuint>;
+    glad_glBindSampler = ignore<GLuint, GLuint>;
+    glad_glTexParameteri = ignore<GLenum, GLenum, GLint>;
+    glad_glSamplerParameteri = ignore<GLuint, GLenum, GLint>;
+    glad_glTexImage2D = ignore<
+      GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum,
+      const void *
+    >;
+    glad_glTexImage3D = ignore<
+      GLenum, GLint, GLint, GLsizei, GLsizei, GLsizei, GLint, GLenum, GLenum,
+      const void *
+    >;
+    glad_glTexSubImage3D = ignore<
+      GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum,
+      GLenum, const void *
+    >;
+
+    glad_glBindRenderbuffer = ignore<GLenum, GLuint>;
+    glad_glRenderbufferStorage = ignore<GLenum, GLenum, GLsizei, GLsizei>;
+    glad_glBindFramebuffer = ignore<GLenum, GLuint>;
+    glad_glFramebufferTexture2D = ignore<
+      GLenum, GLenum, GLenum, GLuint, GLint
+    >;
+    glad_glFramebufferRenderbuffer = ignore<GLenum, GLenum, GLenum, GLuint>;
+    glad_glDrawBuffers = ignore<GLsizei, const GLenum *>;
+    glad_glDrawBuffer = ignore<GLenum>;
+    glad_glReadBuffer = ignore<GLenum>;
+
+    glad_glBindBuffer = ignore<GLenum, GLuint>;
+    glad_glBufferData = ignore<GLenum, GLsizeiptr, const void *, GLenum>;
+    glad_glFlushMappedBufferRange = ignore<GLenum, GLintptr, GLsizeiptr>;
+    glad_glBindVertexArray = ignore<GLuint>;
+    glad_glEnableVertexAttribArray = ignore<GLuint>;
+    glad_glVertexAttribPointer = ignore<
+      GLuint, GLint, GLenum, GLboolean, GLsizei, const void *
+    >;
+    glad_glVertexAttribDivisor = ignore<GLuint, GLuint>;
+    glad_glDrawElements = ignore<GLenum, GLsizei, GLenum, const void *>;
+    glad_glDrawArraysInstanced = ignore<GLenum, GLint, GLsizei, GLsizei>;
+
+    glad_glDeleteTextures = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteRenderbuffers = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteFramebuffers = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteBuffers = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteVertexArrays = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteSamplers = ignore<GLsizei, const GLuint *>;
+    glad_glDeleteSync = ignore<GLsync>;
+  }
+};
+
+#endif // __GL_STUB_HPP__
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../src/util/image_cache.hpp"
+#include "../src/util/image_decode.hpp"
+
+constexpr int iterations = 5;
+
+double ms_since(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+}
+
+// usage: image_cache [image...], defaults to the shipped textures
+int main(int argc, const char *argv[]) {
+  std::vector<const char *> corpus(argv + 1, argv + argc);
+  if (corpus.empty()) {
+    corpus.push_back("data/textures/wood.jpg");
+  }
+
+  const auto dir = std::filesystem::temp_directory_path() / "qogl-bench-cache";
+  auto cache = imgcache::open(dir);
+  if (!cache) {
+    std::cerr << "could not create " << dir << "\n";
+    return 1;
+  }
+
+  std::vector<std::uint8_t> file;
+  std::vector<std::uint8_t> pixels;
+  std::vector<std::uint8_t> reference;
+  imgdec::options opts;
+  opts.threads = 1;
+
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (const char *path : corpus) {
+    if (!imgdec::decode(path, opts, file, reference)) {
+      std::cerr << "could not read " << path << "\n";
+      continue;
+    }
+    std::cout << path << "\n";
+
+    for (const bool compress : {false, true}) {
+      cache->compress = compress;
+      double cold = 0;
+      double warm = 0;
+      bool equal = true;
+
+      for (int i = 0; i < iterations; ++i) {
+        imgcache::clear(*cache);
+
+        auto start = std::chrono::steady_clock::now();
+        imgcache::decode(*cache, path, opts, file, pixels);
+        cold += ms_since(start);
+
+        start = std::chrono::steady_clock::now();
+        imgcache::decode(*cache, path, opts, file, pixels);
+        warm += ms_since(start);
+        equal = equal && pixels == reference;
+      }
+
+      std::uintmax_t bytes = 0;
+      for (const auto &e : std::filesystem::directory_iterator(dir)) {
+        bytes += e.file_size();
+      }
+
+      std::cout << "  " << (compress ? "lz4 " : "raw ");
+      std::cout << "cold " << std::setw(9) << cold / iterations << " ms, ";
+      std::cout << "warm " << std::setw(8) << warm / iterations << " ms, ";
+      std::cout << bytes / 1024 << " KiB on disk";
+      std::cout << (equal ? "" : " (MISMATCH)") << "\n";
+    }
+  }
+
+  imgcache::clear(*cache);
+  std::filesystem::remove(dir);
+
+  return 0;
+}
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+
+#include "../src/util/image_decode.hpp"
+
+constexpr int iterations = 5;
+// the synthetic jpeg, big enough to be split
+constexpr int synthetic_width = 2048;
+constexpr int synthetic_height = 1024;
+
+template <typename F>
+double time_ms(F f) {
+  f(); // warm caches and buffers
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count()
+    / iterations;
+}
+
+void report(const char *name, const double ms, const double baseline) {
+  std::cout << "  " << std::left << std::setw(34) << name << std::right;
+  std::cout << std::setw(9) << ms << " ms  (" << baseline / ms << "x)\n";
+}
+
+/*
+  a minimal baseline jpeg writer: 4:2:0 ycbcr with a restart marker after
+  every mcu row, which is the layout imgdec splits. the huffman tables are
+  flat (every dc symbol 4 bits, every ac symbol 8), valid if not small
+*/
+class jpeg_writer {
+public:
+  std::vector<std::uint8_t> out;
+
+  void marker(const int m) {
+    out.push_back(0xff);
+    out.push_back(m);
+  }
+
+  void u16(const int v) {
+    out.push_back(v >> 8);
+    out.push_back(v & 0xff);
+  }
+
+  void bits(const std::uint32_t code, const int n) {
+    for (int i = n - 1; i >= 0; --i) {
+      acc = (acc << 1) | ((code >> i) & 1);
+      if (++count == 8) { byte(); }
+    }
+  }
+
+  // pads the last byte with ones
+  void align() {
+    while (count != 0) { bits(1, 1); }
+  }
+
+private:
+  void byte() {
+    out.push_back(acc);
+    if (acc == 0xff) { out.push_back(0); }
+    acc = 0;
+    count = 0;
+  }
+
+  std::uint32_t acc = 0;
+  int count = 0;
+};
+
+static int zigzag[64];
+// basis functions with the dc scale folded in
+static float cosines[8][8];
+
+static void init_tables() {
+  for (int u = 0; u < 8; ++u) {
+    for (int x = 0; x < 8; ++x) {
+      cosines[u][x] = std::cos((2 * x + 1) * u * 3.14159265f / 16) *
+        (u ? 1 : 1 / std::sqrt(2.0f));
+    }
+  }
+
+  int i = 0;
+  for (int s = 0; s < 15; ++s) {
+    for (int k = 0; k <= s; ++k) {
+      const int y = s % 2 ? k : s - k;
+      const int x = s - y;
+      if (x < 8 && y < 8) { zigzag[i++] = y * 8 + x; }
+    }
+  }
+}
+
+static int category(int v) {
+  v = std::abs(v);
+  int n = 0;
+  while (v) { ++n; v >>= 1; }
+  return n;
+}
+
+static void put_value(jpeg_writer &w, const int v, const int n) {
+  w.bits(v < 0 ? v + (1 << n) - 1 : v, n);
+}
+
+// ac symbols in code order: eob, zrl, then every run/size
+static std::vector<std::uint8_t> ac_symbols() {
+  std::vector<std::uint8_t> s{0x00, 0xf0};
+  for (int run = 0; run < 16; ++run) {
+    for (int size = 1; size <= 10; ++size) { s.push_back(run << 4 | size); }
+  }
+  return s;
+}
+
+static void encode_block(
+  jpeg_writer &w, const float *block, const int quant, int &dc,
+  const std::vector<int> &ac_code
+) {
+  // separable dct, rows then columns
+  float rows[64];
+  for (int y = 0; y < 8; ++y) {
+    for (int u = 0; u < 8; ++u) {
+      float sum = 0;
+      for (int x = 0; x < 8; ++x) {
+        sum += (block[y * 8 + x] - 128) * cosines[u][x];
+      }
+      rows[y * 8 + u] = sum;
+    }
+  }
+
+  int coef[64];
+  for (int v = 0; v < 8; ++v) {
+    for (int u = 0; u < 8; ++u) {
+      float sum = 0;
+      for (int y = 0; y < 8; ++y) { sum += rows[y * 8 + u] * cosines[v][y]; }
+      coef[v * 8 + u] = int(std::lround(sum / 4 / quant));
+    }
+  }
+
+  const int diff = coef[0] - dc;
+  dc = coef[0];
+  const int dc_size = category(diff);
+  w.bits(dc_size, 4);
+  put_value(w, diff, dc_size);
+
+  int run = 0;
+  for (int i = 1; i < 64; ++i) {
+    const int v = coef[zigzag[i]];
+    if (v == 0) { ++run; continue; }
+
+    while (run >= 16) {
+      w.bits(ac_code[0xf0], 8);
+      run -= 16;
+    }
+    const int size = category(v);
+    w.bits(ac_code[run << 4 | size], 8);
+    put_value(w, v, size);
+    run = 0;
+  }
+  if (run) { w.bits(ac_code[0x00], 8); }
+}
+
+static std::vector<std::uint8_t> synthetic_jpeg(
+  const int width, const int height
+) {
+  init_tables();
+  constexpr int quant = 6;
+
+  // smooth gradients with some texture, so chroma changes at every seam
+  std::vector<float> planes[3];
+  for (auto &p : planes) { p.resize(std::size_t(width) * height); }
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const float r = 128 + 100 * std::sin(x * 0.011f + y * 0.003f);
+      const float g = 128 + 90 * std::cos(y * 0.017f) * std::sin(x * 0.002f);
+      const float b = float((x * 7 + y * 13) % 256);
+      const std::size_t i = std::size_t(y) * width + x;
+      planes[0][i] = 0.299f * r + 0.587f * g + 0.114f * b;
+      planes[1][i] = 128 - 0.168736f * r - 0.331264f * g + 0.5f * b;
+      planes[2][i] = 128 + 0.5f * r - 0.418688f * g - 0.081312f * b;
+    }
+  }
+
+  const auto symbols = ac_symbols();
+  std::vector<int> ac_code(256, 0);
+  for (std::size_t i = 0; i < symbols.size(); ++i) {
+    ac_code[symbols[i]] = i;
+  }
+
+  jpeg_writer w;
+  w.marker(0xd8);
+
+  w.marker(0xdb); // one flat quantisation table
+  w.u16(67);
+  w.out.push_back(0);
+  for (int i = 0; i < 64; ++i) { w.out.push_back(quant); }
+
+  w.marker(0xc0);
+  w.u16(17);
+  w.out.push_back(8);
+  w.u16(height);
+  w.u16(width);
+  w.out.push_back(3);
+  const std::uint8_t sampling[3] = {0x22, 0x11, 0x11};
+  for (int c = 0; c < 3; ++c) {
+    w.out.insert(w.out.end(), {std::uint8_t(c + 1), sampling[c], 0});
+  }
+
+  w.marker(0xc4); // dc table 0, twelve 4 bit codes
+  w.u16(2 + 17 + 12);
+  w.out.push_back(0x00);
+  for (int len = 1; len <= 16; ++len) { w.out.push_back(len == 4 ? 12 : 0); }
+  for (int s = 0; s < 12; ++s) { w.out.push_back(s); }
+
+  w.marker(0xc4); // ac table 0, every symbol 8 bits
+  w.u16(2 + 17 + symbols.size());
+  w.out.push_back(0x10);
+  for (int len = 1; len <= 16; ++len) {
+    w.out.push_back(len == 8 ? symbols.size() : 0);
+  }
+  w.out.insert(w.out.end(), symbols.begin(), symbols.end());
+
+  const int mcus_x = (width + 15) / 16;
+  const int mcus_y = (height + 15) / 16;
+  w.marker(0xdd);
+  w.u16(4);
+  w.u16(mcus_x);
+
+  w.marker(0xda);
+  w.u16(12);
+  w.out.push_back(3);
+  for (int c = 0; c < 3; ++c) {
+    w.out.insert(w.out.end(), {std::uint8_t(c + 1), 0});
+  }
+  w.out.insert(w.out.end(), {0, 63, 0});
+
+  // samples of plane `p` at (x, y), edges repeated, chroma averaged 2x2
+  auto sample = [&](const int p, int x, int y, const int scale) {
+    float sum = 0;
+    for (int dy = 0; dy < scale; ++dy) {
+      for (int dx = 0; dx < scale; ++dx) {
+        const int sx = std::min(x * scale + dx, width - 1);
+        const int sy = std::min(y * scale + dy, height - 1);
+        sum += planes[p][std::size_t(sy) * width + sx];
+      }
+    }
+    return sum / (scale * scale);
+  };
+
+  float block[64];
+  for (int my = 0; my < mcus_y; ++my) {
+    if (my) {
+      w.align();
+      w.marker(0xd0 + (my - 1) % 8);
+    }
+    int dc[3] = {0, 0, 0};
+
+    for (int mx = 0; mx < mcus_x; ++mx) {
+      for (int b = 0; b < 4; ++b) {
+        const int bx = mx * 16 + (b % 2) * 8;
+        const int by = my * 16 + (b / 2) * 8;
+        for (int i = 0; i < 64; ++i) {
+          block[i] = sample(0, bx + i % 8, by + i / 8, 1);
+        }
+        encode_block(w, block, quant, dc[0], ac_code);
+      }
+      for (int c = 1; c < 3; ++c) {
+        for (int i = 0; i < 64; ++i) {
+          block[i] = sample(c, mx * 8 + i % 8, my * 8 + i / 8, 2);
+        }
+        encode_block(w, block, quant, dc[c], ac_code);
+      }
+    }
+  }
+  w.align();
+  w.marker(0xd9);
+
+  return std::move(w.out);
+}
+
+// imgdec's output must match stbi_load's byte for byte
+bool matches_stb(
+  const std::vector<std::uint8_t> &file, const std::vector<std::uint8_t> &px,
+  const int channels
+) {
+  int w;
+  int h;
+  int c;
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char *ref = stbi_load_from_memory(
+    file.data(), file.size(), &w, &h, &c, channels
+  );
+  stbi_set_flip_vertically_on_load(false);
+  if (ref == nullptr) { return false; }
+
+  const std::size_t size = std::size_t(w) * h * (channels ? channels : c);
+  const bool same = px.size() == size &&
+    std::memcmp(ref, px.data(), size) == 0;
+  stbi_image_free(ref);
+
+  return same;
+}
+
+void run(const std::string &name, const std::vector<std::uint8_t> &file) {
+  int w;
+  int h;
+  int c;
+  if (!stbi_info_from_memory(file.data(), file.size(), &w, &h, &c)) {
+    std::cerr << "could not read " << name << "\n";
+    return;
+  }
+  std::cout << name << " (" << w << "x" << h << "x" << c << ")\n";
+
+  // what loadTexture did before: stb flips in its own pass and mallocs
+  // the result, the driver then expands rgb to rgba during upload
+  const double stb_ms = time_ms([&]() {
+    stbi_set_flip_vertically_on_load(true);
+    stbi_image_free(
+      stbi_load_from_memory(file.data(), file.size(), &w, &h, &c, 0)
+    );
+  });
+  report("stbi_load, flip", stb_ms, stb_ms);
+
+  const double stb_rgba_ms = time_ms([&]() {
+    stbi_set_flip_vertically_on_load(true);
+    stbi_image_free(
+      stbi_load_from_memory(file.data(), file.size(), &w, &h, &c, 4)
+    );
+  });
+  report("stbi_load, flip, rgba", stb_rgba_ms, stb_ms);
+  stbi_set_flip_vertically_on_load(false);
+
+  std::vector<std::uint8_t> pixels;
+  imgdec::options opts;
+  opts.threads = 1;
+
+  const double native_ms = time_ms([&]() {
+    imgdec::decode(file.data(), file.size(), opts, pixels);
+  });
+  report("imgdec, flip", native_ms, stb_ms);
+  bool exact = matches_stb(file, pixels, 0);
+
+  opts.channels = 4;
+  const imgdec::isa_t isas[] = {
+    imgdec::isa_t::scalar, imgdec::isa_t::ssse3, imgdec::isa_t::avx2
+  };
+  for (const auto isa : isas) {
+    imgdec::set_isa(isa);
+    if (imgdec::active_isa() != isa) { continue; }
+
+    const double ms = time_ms([&]() {
+      imgdec::decode(file.data(), file.size(), opts, pixels);
+    });
+    const std::string name = std::string("imgdec, flip, rgba (") +
+      imgdec::isa_name(isa) + ")";
+    report(name.c_str(), ms, stb_rgba_ms);
+    exact = exact && matches_stb(file, pixels, 4);
+  }
+
+  // conversion alone, which is the part the simd kernels replace
+  opts.premultiply = true;
+  opts.srgb_to_linear = true;
+  unsigned char *native = stbi_load_from_memory(
+    file.data(), file.size(), &w, &h, &c, 0
+  );
+  std::vector<std::uint8_t> rgba(std::size_t(w) * h * 4);
+  for (const auto isa : isas) {
+    imgdec::set_isa(isa);
+    if (imgdec::active_isa() != isa) { continue; }
+
+    const double ms = time_ms([&]() {
+      imgdec::convert_rows(
+        native, w, h, c, opts, rgba.data() + std::size_t(h - 1) * w * 4,
+        -std::ptrdiff_t(w) * 4
+      );
+    });
+    const std::string name = std::string("convert rgba+lin+premul (") +
+      imgdec::isa_name(isa) + ")";
+    report(name.c_str(), ms, stb_rgba_ms);
+  }
+  stbi_image_free(native);
+
+  // splitting is asked for explicitly so it is measured on any machine
+  imgdec::set_isa(imgdec::isa_t::avx2);
+  for (const int channels : {0, 4}) {
+    opts = imgdec::options();
+    opts.channels = channels;
+    opts.threads = 4;
+    imgdec::info info;
+    const double split_ms = time_ms([&]() {
+      info = *imgdec::decode(file.data(), file.size(), opts, pixels);
+    });
+    const std::string name = std::string("imgdec, ") +
+      (channels ? "rgba, " : "") + std::to_string(info.chunks) + " chunk(s)";
+    report(name.c_str(), split_ms, channels ? stb_rgba_ms : stb_ms);
+    exact = exact && matches_stb(file, pixels, channels);
+  }
+
+  std::cout << "  output " << (exact ? "matches" : "DIFFERS FROM");
+  std::cout << " stbi_load\n";
+}
+
+// usage: image_decode [image...], defaults to the shipped textures. a
+// synthetic jpeg with restart markers always runs too, for the split path
+int main(int argc, const char *argv[]) {
+  std::vector<const char *> corpus(argv + 1, argv + argc);
+  if (corpus.empty()) {
+    corpus.push_back("data/textures/wood.jpg");
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (const char *path : corpus) {
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    const std::vector<std::uint8_t> file(
+      (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+    );
+    run(path, file);
+  }
+
+  run(
+    "synthetic, restart every mcu row",
+    synthetic_jpeg(synthetic_width, synthetic_height)
+  );
+
+  return 0;
+}
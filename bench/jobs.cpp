@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "../src/math/transform.hpp"
+#include "../src/util/jobs.hpp"
+
+constexpr int spawns = 200000;
+constexpr int steals = 2000;
+constexpr std::size_t object_count = 1 << 20;
+constexpr std::size_t grain = 4096; // objects per job
+constexpr int iterations = 20;
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename F>
+double time_ms(F f, const int n=1) {
+  auto start = clock_type::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = clock_type::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+// submit and run empty jobs, ns per job
+double spawn_ns(jobs::scheduler &s) {
+  const double ms = time_ms([&]() {
+    jobs::counter done;
+    for (int i = 0; i < spawns; ++i) { s.run([] {}, &done); }
+    s.wait(done);
+  });
+
+  return ms * 1e6 / spawns;
+}
+
+// time from pushing one job on the main thread to a worker starting it,
+// median in us. the main thread spins without taking jobs meanwhile
+double steal_us(jobs::scheduler &s) {
+  std::vector<double> samples;
+  samples.reserve(steals);
+
+  for (int i = 0; i < steals; ++i) {
+    std::atomic<std::int64_t> started{0};
+    jobs::counter done;
+
+    const auto pushed = clock_type::now();
+    s.run([&started] {
+      started = clock_type::now().time_since_epoch().count();
+    }, &done);
+    while (started.load() == 0) { std::this_thread::yield(); }
+    s.wait(done);
+
+    const auto start = clock_type::time_point(
+      clock_type::duration(started.load())
+    );
+    samples.push_back(
+      std::chrono::duration<double, std::micro>(start - pushed).count()
+    );
+  }
+
+  std::nth_element(
+    samples.begin(), samples.begin() + samples.size() / 2, samples.end()
+  );
+  return samples[samples.size() / 2];
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> pos(0, 640);
+  std::uniform_real_distribution<float> size(1, 64);
+  std::uniform_real_distribution<float> angle(-6.3, 6.3);
+
+  std::vector<float> x(object_count);
+  std::vector<float> y(object_count);
+  std::vector<float> sx(object_count);
+  std::vector<float> sy(object_count);
+  std::vector<float> rot(object_count);
+  for (std::size_t i = 0; i < object_count; ++i) {
+    x[i] = pos(rng);
+    y[i] = pos(rng);
+    sx[i] = size(rng);
+    sy[i] = size(rng);
+    rot[i] = angle(rng);
+  }
+  std::vector<glm::mat4> matrices(object_count);
+
+  // the same kernel as bench/transform, split into jobs
+  auto transform_all = [&](jobs::scheduler &s) {
+    s.parallel_for(object_count, grain, [&](std::size_t b, std::size_t e) {
+      const xform::soa_view in{
+        x.data() + b, y.data() + b, sx.data() + b, sy.data() + b,
+        rot.data() + b, e - b
+      };
+      xform::model_matrices(in, matrices.data() + b);
+    });
+  };
+
+  const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << spawns << " empty jobs, " << steals << " single job steals, ";
+  std::cout << object_count << " transforms in jobs of " << grain;
+  std::cout << " (" << xform::isa_name(xform::active_isa()) << ")\n";
+  std::cout << "  threads   spawn ns/job   steal us   transform ms   speedup\n";
+
+  double base_ms = 0;
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    jobs::scheduler s(threads - 1);
+
+    const double spawn = spawn_ns(s);
+    const double steal = threads > 1 ? steal_us(s) : 0;
+    transform_all(s);
+    const double ms = time_ms([&]() { transform_all(s); }, iterations);
+    if (threads == 1) { base_ms = ms; }
+
+    std::cout << "  " << std::setw(7) << threads;
+    std::cout << std::setw(15) << spawn;
+    if (threads > 1) {
+      std::cout << std::setw(11) << steal;
+    } else {
+      std::cout << std::setw(11) << "-";
+    }
+    std::cout << std::setw(15) << ms;
+    std::cout << std::setw(10) << base_ms / ms << "\n";
+
+    if (threads * 2 > max_threads && threads != max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+
+  // the table only has steals with more than one core; one worker is
+  // enough to measure them anywhere, though on a single core each one also
+  // waits for the worker to be scheduled
+  jobs::scheduler pair(1);
+  spawn_ns(pair);
+  std::cout << "  steal with one worker on " << max_threads << " core(s): ";
+  std::cout << steal_us(pair) << " us\n";
+
+  return 0;
+}
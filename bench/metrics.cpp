@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../src/util/metrics.hpp"
+
+constexpr int increments = 4000000; // per thread
+
+template <typename F>
+double time_ms(F f, const int n=1) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+template <typename F>
+double threaded_ns(const int threads, F f) {
+  const double ms = time_ms([&]() {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&]() {
+        for (int i = 0; i < increments; ++i) { f(i); }
+      });
+    }
+    for (auto &w : workers) { w.join(); }
+  });
+
+  return ms * 1e6 / (double(threads) * increments);
+}
+
+int main() {
+  const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << increments << " updates per thread, ns per update\n";
+  std::cout << "  threads   shared atomic   sharded counter   histogram\n";
+
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    std::atomic<std::uint64_t> shared{0};
+    metrics::counter counter;
+    metrics::histogram histogram;
+
+    const double shared_ns = threaded_ns(threads, [&](int) {
+      shared.fetch_add(1, std::memory_order_relaxed);
+    });
+    const double counter_ns = threaded_ns(threads, [&](int) {
+      counter.add();
+    });
+    const double histogram_ns = threaded_ns(threads, [&](int i) {
+      histogram.record(std::uint64_t(i & 4095));
+    });
+
+    std::cout << "  " << std::setw(7) << threads;
+    std::cout << std::setw(16) << shared_ns;
+    std::cout << std::setw(18) << counter_ns;
+    std::cout << std::setw(12) << histogram_ns << "\n";
+
+    if (counter.value() != shared.load()) {
+      std::cout << "counter lost updates\n";
+      return 1;
+    }
+  }
+
+  return 0;
+}
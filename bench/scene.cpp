@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/scene/scene.hpp"
+
+constexpr std::size_t object_count = 1 << 20;
+constexpr int iterations = 20;
+
+template <typename F>
+double time_ms(F f, const int n=iterations) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> pos(0, 4096);
+
+  std::vector<scene::renderable> objects(object_count);
+  for (auto &r : objects) {
+    r.x = pos(rng);
+    r.y = pos(rng);
+    r.visible = (rng() % 8) != 0;
+  }
+
+  scene::store store;
+  std::vector<scene::handle> handles(object_count);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << object_count << " renderables\n";
+
+  const double add_ms = time_ms([&]() {
+    store.clear();
+    for (std::size_t i = 0; i < object_count; ++i) {
+      handles[i] = store.add(objects[i]);
+    }
+  }, 5);
+  std::cout << "  add                 " << std::setw(9) << add_ms << " ms\n";
+
+  // the same pass over an array of structs and over the dense columns
+  float sink = 0;
+  const double aos_ms = time_ms([&]() {
+    float sum = 0;
+    for (const auto &r : objects) {
+      if (r.visible) { sum += r.x + r.y; }
+    }
+    sink += sum;
+  });
+  const double soa_ms = time_ms([&]() {
+    const auto &c = store.data();
+    float sum = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+      sum += c.visible[i] ? c.x[i] + c.y[i] : 0;
+    }
+    sink += sum;
+  });
+  std::cout << "  iterate (aos)       " << std::setw(9) << aos_ms << " ms\n";
+  std::cout << "  iterate (soa)       " << std::setw(9) << soa_ms << " ms\n";
+
+  std::vector<float> matrices(object_count * 16);
+  const double xform_ms = time_ms([&]() {
+    xform::model_matrices(store.transforms(), matrices.data());
+  });
+  std::cout << "  model matrices      " << std::setw(9) << xform_ms << " ms\n";
+
+  std::shuffle(handles.begin(), handles.end(), rng);
+  const std::size_t removals = object_count / 10;
+  const double remove_ms = time_ms([&]() {
+    for (std::size_t i = 0; i < removals; ++i) {
+      store.remove(handles[i]);
+    }
+  }, 1);
+  std::cout << "  remove " << removals << "       " << std::setw(9);
+  std::cout << remove_ms << " ms (";
+  std::cout << remove_ms * 1e6 / removals << " ns each)\n";
+
+  std::size_t stale = 0;
+  for (std::size_t i = 0; i < removals; ++i) {
+    stale += !store.valid(handles[i]);
+  }
+  std::cout << "  stale handles " << stale << "/" << removals;
+  std::cout << ", " << store.size() << " live\n";
+
+  return sink == 0;
+}
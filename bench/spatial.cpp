@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "../src/scene/scene.hpp"
+#include "../src/scene/spatial.hpp"
+
+// a 1024 x 1024 tile map of 32px tiles, viewed through a 640 x 480 window
+constexpr int map_tiles = 1024;
+constexpr float tile_size = 32;
+constexpr int view_w = 640;
+constexpr int view_h = 480;
+constexpr int iterations = 20;
+
+template <typename F>
+double time_ms(F f, const int n=iterations) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+int main() {
+  const float world_size = map_tiles * tile_size;
+  std::mt19937 rng(42);
+
+  scene::store store;
+  store.reserve(map_tiles * map_tiles);
+  for (int ty = 0; ty < map_tiles; ++ty) {
+    for (int tx = 0; tx < map_tiles; ++tx) {
+      scene::renderable r;
+      r.x = tx * tile_size;
+      r.y = ty * tile_size;
+      r.sx = tile_size;
+      r.sy = tile_size;
+      r.visible = (rng() % 16) != 0;
+      store.add(r);
+    }
+  }
+
+  spatial::grid grid({0, 0, world_size, world_size}, tile_size * 4);
+  const auto &c = store.data();
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << store.size() << " objects, " << view_w << "x" << view_h;
+  std::cout << " view\n";
+
+  const double build_ms = time_ms([&]() {
+    grid.clear();
+    for (std::size_t i = 0; i < store.size(); ++i) {
+      grid.insert(store.handle_at(i), spatial::rect_bounds(
+        c.x[i], c.y[i], c.sx[i], c.sy[i], c.rot[i]
+      ));
+    }
+  }, 3);
+  std::cout << "  build               " << std::setw(9) << build_ms << " ms\n";
+
+  // move a tenth of the objects by up to a tile each frame
+  std::uniform_real_distribution<float> step(-tile_size, tile_size);
+  std::vector<std::size_t> movers(store.size() / 10);
+  for (auto &m : movers) { m = rng() % store.size(); }
+
+  auto &cm = store.data();
+  const double update_ms = time_ms([&]() {
+    for (const auto i : movers) {
+      cm.x[i] += step(rng);
+      cm.y[i] += step(rng);
+      grid.update(store.handle_at(i), spatial::rect_bounds(
+        cm.x[i], cm.y[i], cm.sx[i], cm.sy[i], cm.rot[i]
+      ));
+    }
+  });
+  std::cout << "  update " << movers.size() << "       " << std::setw(9);
+  std::cout << update_ms << " ms\n";
+
+  std::uniform_real_distribution<float> cam(0, world_size - view_w);
+  std::vector<glm::vec2> cameras(64);
+  for (auto &p : cameras) { p = {cam(rng), cam(rng)}; }
+
+  const glm::mat4 projection = glm::ortho<double>(0, view_w, 0, view_h, 0.1, 100.0);
+  std::vector<std::uint32_t> visible;
+  std::size_t visible_total = 0;
+  std::size_t frame = 0;
+  const double cull_ms = time_ms([&]() {
+    const glm::vec2 p = cameras[frame++ % cameras.size()];
+    const glm::mat4 view = glm::translate(
+      glm::mat4(1.0), glm::vec3(-p.x, -p.y, -1.0)
+    );
+    spatial::cull(store, grid, spatial::view_bounds(projection, view), visible);
+    visible_total += visible.size();
+  }, 192);
+  std::cout << "  cull (grid)         " << std::setw(9) << cull_ms << " ms";
+  std::cout << " (" << visible_total / 192 << " visible)\n";
+
+  std::size_t brute_total = 0;
+  frame = 0;
+  const double brute_ms = time_ms([&]() {
+    const glm::vec2 p = cameras[frame++ % cameras.size()];
+    const glm::mat4 view = glm::translate(
+      glm::mat4(1.0), glm::vec3(-p.x, -p.y, -1.0)
+    );
+    const spatial::aabb v = spatial::view_bounds(projection, view);
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+      n += c.visible[i] && spatial::overlaps(v, spatial::rect_bounds(
+        c.x[i], c.y[i], c.sx[i], c.sy[i], c.rot[i]
+      ));
+    }
+    brute_total += n;
+  }, 64);
+  std::cout << "  cull (brute force)  " << std::setw(9) << brute_ms << " ms";
+  std::cout << " (" << brute_total / 64 << " visible)\n";
+
+  return 0;
+}
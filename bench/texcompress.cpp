@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "../src/util/texture_codec.hpp"
+
+// usage: texcompress [image...], defaults to the shipped textures
+int main(int argc, const char *argv[]) {
+  std::vector<const char *> corpus(argv + 1, argv + argc);
+  if (corpus.empty()) {
+    corpus.push_back("data/textures/wood.jpg");
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+
+  for (const char *path : corpus) {
+    texc::image img;
+    unsigned char *data = stbi_load(
+      path, &img.width, &img.height, &img.channels, 0
+    );
+    if (data == nullptr) {
+      std::cerr << "could not load " << path << "\n";
+      continue;
+    }
+    img.pixels.assign(
+      data, data + std::size_t(img.width) * img.height * img.channels
+    );
+    stbi_image_free(data);
+
+    const double texels = double(img.width) * img.height;
+    std::cout << path << " (" << img.width << "x" << img.height << "x";
+    std::cout << img.channels << ")\n";
+    std::cout << "  format      bytes   bpp   psnr db   encode ms  Mtexel/s\n";
+
+    // rgba8 is the upload loadTexture used to make for every image
+    const texc::format_t formats[] = {
+      texc::format_t::rgba8, texc::format_t::rgb8, texc::format_t::bc1,
+      texc::format_t::bc3, texc::format_t::bc7, texc::format_t::rg8,
+      texc::format_t::bc5, texc::format_t::r8, texc::format_t::bc4
+    };
+    for (const auto f : formats) {
+      auto start = std::chrono::steady_clock::now();
+      const auto c = texc::encode(img, f);
+      auto end = std::chrono::steady_clock::now();
+      const double ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+
+      const auto decoded = texc::decode(c);
+      const int channels = std::min(img.channels, texc::format_channels(f));
+
+      std::cout << "  " << std::left << std::setw(6) << texc::format_name(f);
+      std::cout << std::right << std::setw(11) << c.data.size();
+      std::cout << std::setw(6) << c.data.size() * 8 / texels;
+      std::cout << std::setw(10) << texc::psnr(img, *decoded, channels);
+      std::cout << std::setw(12) << ms;
+      std::cout << std::setw(10) << texels / ms / 1000 << "\n";
+    }
+  }
+
+  return 0;
+}
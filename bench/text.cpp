@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "../src/gl/quad_batch.hpp"
+#include "../src/util/text.hpp"
+
+// a debug overlay's worth of text: 250 lines of 41 characters, 10k
+// characters of which about 7.7k are visible glyphs (spaces get no quad)
+constexpr int lines = 250;
+constexpr int frames = 600;
+
+template <typename F>
+double time_ms(F f, const int n=1) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+int main() {
+  std::vector<std::string> strings(lines);
+  std::size_t characters = 0;
+  for (int i = 0; i < lines; ++i) {
+    char line[64];
+    std::snprintf(
+      line, sizeof(line), "entity %05d pos %8.2f %8.2f hp %3d",
+      i, i * 3.25, i * -1.5, i % 100
+    );
+    strings[i] = line;
+    characters += strings[i].size();
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << lines << " lines, " << characters << " characters per frame\n";
+
+  std::vector<std::uint8_t> cell(text::cell_width * text::cell_height);
+  const double raster_ms = time_ms([&]() {
+    for (int g = 0; g < text::glyph_count; ++g) {
+      text::rasterise(g, cell.data());
+    }
+  });
+  std::cout << "  rasterise              " << std::setw(10);
+  std::cout << raster_ms * 1000 / text::glyph_count << " us/glyph (";
+  std::cout << text::cell_width << "x" << text::cell_height << " cells)\n";
+
+  text::run r;
+  const double layout_ms = time_ms([&]() {
+    for (const auto &s : strings) { text::layout(s, 16, r); }
+  }, frames);
+  std::cout << "  layout, uncached       " << std::setw(10) << layout_ms;
+  std::cout << " ms/frame\n";
+
+  text::run_cache cache;
+  const double cached_ms = time_ms([&]() {
+    for (const auto &s : strings) { cache.get(s, 16); }
+  }, frames);
+  std::cout << "  layout, cached         " << std::setw(10) << cached_ms;
+  std::cout << " ms/frame\n";
+
+  // every glyph's uv rect, as the renderer keeps them once resident
+  std::vector<glm::vec4> uvs(text::glyph_count);
+  for (int g = 0; g < text::glyph_count; ++g) {
+    uvs[g] = glm::vec4(g % 16, g / 16, g % 16 + 1, g / 16 + 1) /
+      glm::vec4(16, 8, 16, 8);
+  }
+
+  // a tenth of the lines change every frame, like counters on a hud
+  std::vector<QuadVertex> vertices(characters * 4);
+  std::size_t written = 0;
+  const double submit_ms = time_ms([&]() {
+    static int frame = 0;
+    for (int i = frame % 10; i < lines; i += 10) {
+      std::snprintf(
+        strings[i].data(), strings[i].size() + 1,
+        "entity %05d pos %8.2f %8.2f hp %3d", i, i * 3.25 + frame,
+        i * -1.5, (i + frame) % 100
+      );
+    }
+    ++frame;
+
+    // drawText's loop, with the batch's mapped vertices in memory
+    QuadVertex *v = vertices.data();
+    for (int i = 0; i < lines; ++i) {
+      const text::run &run = cache.get(strings[i], 16);
+      const glm::vec2 pos(8, 8 + i * 16);
+
+      for (const auto &q : run.quads) {
+        const float x0 = pos.x + q.x0;
+        const float y0 = pos.y + q.y0;
+        const float x1 = pos.x + q.x1;
+        const float y1 = pos.y + q.y1;
+        const float corners[8] = {x0, y1, x0, y0, x1, y0, x1, y1};
+        writeQuad(v, corners, uvs[q.glyph], 0xffffffff, 0);
+        v += 4;
+      }
+    }
+    written += v - vertices.data();
+  }, frames);
+  std::cout << "  layout + submit        " << std::setw(10) << submit_ms;
+  std::cout << " ms/frame, " << written / 4 / frames << " quads, ";
+  std::cout << cache.hits << " hits " << cache.misses << " misses\n";
+
+  return 0;
+}
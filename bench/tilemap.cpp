@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "gl_stub.hpp"
+#include "../src/gl/tilemap_renderer.hpp"
+#include "../src/scene/spatial.hpp"
+#include "../src/scene/tilemap.hpp"
+
+// a 4096 x 4096 tile map of 32px tiles, viewed through a 640 x 480 window
+constexpr int map_tiles = 4096;
+constexpr float tile_size = 32;
+constexpr int view_w = 640;
+constexpr int view_h = 480;
+constexpr int frames = 600;
+
+template <typename F>
+double time_ms(F f, const int n=1) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() / n;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  tilemap::map map(map_tiles, map_tiles, tile_size);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << map_tiles << "x" << map_tiles << " tiles, ";
+  std::cout << map.chunks_x() * map.chunks_y() << " chunks of ";
+  std::cout << tilemap::chunk_size << "x" << tilemap::chunk_size << "\n";
+
+  const double fill_ms = time_ms([&]() {
+    for (int y = 0; y < map_tiles; ++y) {
+      for (int x = 0; x < map_tiles; ++x) {
+        map.set(x, y, 1 + rng() % 64);
+      }
+    }
+  });
+  std::cout << "  fill tile by tile      " << std::setw(10) << fill_ms;
+  std::cout << " ms\n";
+
+  std::vector<float> instances(tilemap::chunk_tiles);
+  const int rebuilds = map.chunks_x() * map.chunks_y();
+  const double rebuild_ms = time_ms([&]() {
+    for (int cy = 0; cy < map.chunks_y(); ++cy) {
+      for (int cx = 0; cx < map.chunks_x(); ++cx) {
+        tilemap::build_instances(map.chunk_at(cx, cy), instances.data());
+      }
+    }
+  });
+  std::cout << "  chunk rebuild          " << std::setw(10);
+  std::cout << rebuild_ms * 1000 / rebuilds << " us/chunk\n";
+
+  // a camera panning diagonally across the map while a few random tiles
+  // change each frame, drawn by drawTilemap on stubbed gl entry points so
+  // only its cpu side is measured
+  gl_stub::install();
+  TilemapRenderer r = createTilemapRenderer(map, 0, {});
+  std::size_t visible = 0;
+  std::size_t draws = 0;
+  std::size_t uploads = 0;
+  const glm::mat4 projection = glm::ortho<float>(
+    0, view_w, 0, view_h, 0.1, 100.0
+  );
+
+  const double frame_ms = time_ms([&]() {
+    static int frame = 0;
+    const float t = float(frame++) / frames;
+    const float pan = t * (map_tiles * tile_size - view_w);
+    const glm::mat4 view = glm::translate(
+      glm::mat4(1), glm::vec3(-pan, -pan * 0.5f, -1)
+    );
+
+    for (int i = 0; i < 16; ++i) {
+      map.set(rng() % map_tiles, rng() % map_tiles, 1 + rng() % 64);
+    }
+
+    drawTilemap(r, map, spatial::view_bounds(projection, view));
+    visible += r.visible;
+    draws += r.draws;
+    uploads += r.uploads;
+  }, frames);
+
+  std::cout << "  frame (drawTilemap)    " << std::setw(10) << frame_ms;
+  std::cout << " ms, " << double(visible) / frames << " chunks visible, ";
+  std::cout << double(draws) / frames << " draws, ";
+  std::cout << double(uploads) / frames << " uploads per frame\n";
+  std::cout << "  resident chunks        " << std::setw(10) << r.resident;
+  std::cout << "\n";
+  std::cout << "  instance data          " << std::setw(10);
+  std::cout << rebuilds * tilemap::chunk_tiles * sizeof(float) / (1 << 20);
+  std::cout << " MiB if every chunk were resident\n";
+
+  destroyTilemapRenderer(r);
+
+  return 0;
+}
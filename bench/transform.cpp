@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "../src/math/transform.hpp"
+
+constexpr std::size_t object_count = 1 << 20;
+constexpr int iterations = 20;
+
+template <typename F>
+double time_ms(F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) { f(); }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count()
+    / iterations;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> pos(0, 640);
+  std::uniform_real_distribution<float> size(1, 64);
+  std::uniform_real_distribution<float> angle(-6.3, 6.3);
+
+  std::vector<float> x(object_count);
+  std::vector<float> y(object_count);
+  std::vector<float> sx(object_count);
+  std::vector<float> sy(object_count);
+  std::vector<float> rot(object_count);
+  for (std::size_t i = 0; i < object_count; ++i) {
+    x[i] = pos(rng);
+    y[i] = pos(rng);
+    sx[i] = size(rng);
+    sy[i] = size(rng);
+    rot[i] = angle(rng);
+  }
+
+  const xform::soa_view in{
+    x.data(), y.data(), sx.data(), sy.data(), rot.data(), object_count
+  };
+  std::vector<glm::mat4> reference(object_count);
+  std::vector<glm::mat4> matrices(object_count);
+  std::vector<float> quads(object_count * 8);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << object_count << " objects, mean of " << iterations << " runs\n";
+
+  const double glm_ms = time_ms([&]() {
+    for (std::size_t i = 0; i < object_count; ++i) {
+      glm::mat4 m = glm::translate(glm::mat4(1.0), glm::vec3(x[i], y[i], 0));
+      m = glm::rotate(m, rot[i], glm::vec3(0, 0, 1));
+      reference[i] = glm::scale(m, glm::vec3(sx[i], sy[i], 1));
+    }
+  });
+  std::cout << "  glm per object     " << std::setw(9) << glm_ms << " ms\n";
+
+  const xform::isa_t isas[] = {
+    xform::isa_t::scalar, xform::isa_t::sse2, xform::isa_t::avx2
+  };
+  for (const auto isa : isas) {
+    xform::set_isa(isa);
+    if (xform::active_isa() != isa) { continue; }
+
+    const double mat_ms = time_ms([&]() {
+      xform::model_matrices(in, matrices.data());
+    });
+    const double quad_ms = time_ms([&]() {
+      xform::quad_vertices(in, quads.data());
+    });
+
+    // largest difference from glm, relative to the object's scale
+    float max_error = 0;
+    for (std::size_t i = 0; i < object_count; ++i) {
+      const float scale = std::max(sx[i], sy[i]);
+      for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+          const float d = std::abs(matrices[i][c][r] - reference[i][c][r]);
+          max_error = std::max(max_error, d / scale);
+        }
+      }
+    }
+
+    std::cout << "  " << std::setw(6) << xform::isa_name(isa);
+    std::cout << " matrices   " << std::setw(9) << mat_ms << " ms";
+    std::cout << "  (" << glm_ms / mat_ms << "x glm, max rel error ";
+    std::cout << std::scientific << max_error << std::fixed << ")\n";
+    std::cout << "  " << std::setw(6) << xform::isa_name(isa);
+    std::cout << " quads      " << std::setw(9) << quad_ms << " ms\n";
+  }
+
+  return 0;
+}
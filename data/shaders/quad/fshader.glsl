@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec4 _colour;
+in vec3 _tex_coords;
+
+out vec4 FragmentColour;
+
+uniform sampler2DArray textures;
+
+void main() {
+  FragmentColour = _colour * texture(textures, _tex_coords);
+}
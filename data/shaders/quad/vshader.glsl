@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec2 attr_pos;
+layout (location = 1) in vec4 attr_colour;
+layout (location = 2) in vec2 attr_tex_coords;
+layout (location = 3) in float attr_layer;
+
+out vec4 _colour;
+out vec3 _tex_coords;
+
+layout (std140) uniform Camera {
+  mat4 projection;
+  mat4 view;
+  vec4 viewport;
+};
+
+void main() {
+  gl_Position = projection * view * vec4(attr_pos, 0.0, 1.0);
+  _colour = attr_colour;
+  _tex_coords = vec3(attr_tex_coords, attr_layer);
+}
@@ -6,9 +6,13 @@ layout (location = 2) in vec2 attr_tex_coords;
 out vec3 _colour;
 out vec2 _tex_coords;
 
+layout (std140) uniform Camera {
+  mat4 projection;
+  mat4 view;
+  vec4 viewport;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
   gl_Position = projection * view * model * vec4(attr_pos, 1.0);
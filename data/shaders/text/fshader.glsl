@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec4 _colour;
+in vec3 _tex_coords;
+
+out vec4 FragmentColour;
+
+uniform sampler2DArray textures;
+
+void main() {
+  // 0.5 is the outline; the edge is a pixel wide at any scale
+  float d = texture(textures, _tex_coords).r;
+  float w = max(fwidth(d), 1e-4) * 0.75;
+  float a = smoothstep(0.5 - w, 0.5 + w, d);
+
+  FragmentColour = vec4(_colour.rgb, _colour.a * a);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec3 _tex_coords;
+
+out vec4 FragmentColour;
+
+uniform sampler2DArray tileset;
+
+void main() {
+  FragmentColour = texture(tileset, _tex_coords);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+layout (location = 0) in vec2 attr_corner;
+layout (location = 1) in float attr_layer;
+
+out vec3 _tex_coords;
+
+layout (std140) uniform Camera {
+  mat4 projection;
+  mat4 view;
+  vec4 viewport;
+};
+
+uniform vec2 chunk_origin;
+uniform float tile_size;
+
+const int chunk_size = 32; // tilemap::chunk_size
+
+void main() {
+  vec2 tile = vec2(gl_InstanceID % chunk_size, gl_InstanceID / chunk_size);
+  // empty tiles (layer -1) collapse to a point and produce no fragments
+  vec2 corner = attr_layer < 0.0 ? vec2(0.0) : attr_corner;
+
+  gl_Position = projection * view *
+    vec4(chunk_origin + (tile + corner) * tile_size, 0.0, 1.0);
+  _tex_coords = vec3(attr_corner, max(attr_layer, 0.0));
+}
@@ -0,0 +1,124 @@
+#ifdef COROUTINES
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "asset_loader.hpp"
+#include "shader_program.hpp"
+#include "texture.hpp"
+#include "texture_residency.hpp"
+#include "../util/async.hpp"
+#include "../util/event_log.hpp"
+#include "../util/file_io.hpp"
+#include "../util/texture_codec.hpp"
+#include "../util/xdg.hpp"
+
+async::task<std::optional<std::string>> readFileAsync(xdg::path p) {
+  co_await async::io();
+
+  std::string contents;
+  if (!fio::read(p, contents)) { co_return std::nullopt; }
+
+  co_return std::move(contents);
+}
+
+async::task<GLuint> loadProgramAsync(
+  xdg::path v, xdg::path f
+  #ifdef DEBUG
+  , fio::log_stream_f *log_stream
+  #endif
+) {
+  auto [v_source, f_source] = co_await async::when_all(
+    readFileAsync(v), readFileAsync(f)
+  );
+
+  co_await async::main_thread();
+  if (!v_source || !f_source) {
+    #ifdef DEBUG
+    *log_stream << "could not read shader " << v << " or " << f << "\n";
+    #endif
+    EVLOG("[w] could not read shader {} or {}", v, f);
+    co_return 0;
+  }
+
+  const GLuint v_shader = createShader(GL_VERTEX_SHADER, *v_source);
+  const GLuint f_shader = createShader(GL_FRAGMENT_SHADER, *f_source);
+
+  co_return createCheckedProgram(v_shader, f_shader
+    #ifdef DEBUG
+    , *log_stream
+    #endif
+  );
+}
+
+async::task<Texture> loadTextureAsync(TextureResidency &r, xdg::path p) {
+  const bool compressed = p.extension() == ".qtex";
+
+  // the caps query is a gl call, and cached after the first
+  texc::caps caps;
+  if (compressed) {
+    co_await async::main_thread();
+    caps = queryCompressionCaps();
+  }
+
+  co_await async::io();
+  auto image = std::make_unique<TextureImage>();
+  bool decoded = false;
+  if (compressed) {
+    auto c = texc::read(p);
+
+    co_await async::workers();
+    decoded = c && convertCompressedImage(*c, caps, *image);
+  } else {
+    std::string file;
+    const bool read = fio::read(p, file);
+
+    co_await async::workers();
+    decoded = read && decodeTextureImage(
+      reinterpret_cast<const std::uint8_t *>(file.data()), file.size(),
+      *image
+    );
+  }
+
+  co_await async::main_thread();
+  if (!decoded) {
+    EVLOG("[w] could not load texture {}", p);
+    co_return Texture{};
+  }
+
+  co_return adoptManagedTexture(r, p.c_str(), std::move(image), compressed);
+}
+
+async::task<Material> loadMaterialAsync(
+  TextureResidency &r, xdg::path v, xdg::path f,
+  std::vector<xdg::path> textures
+  #ifdef DEBUG
+  , fio::log_stream_f *log_stream
+  #endif
+) {
+  std::vector<async::task<Texture>> loads;
+  loads.reserve(textures.size());
+  for (auto &t : textures) {
+    loads.push_back(loadTextureAsync(r, std::move(t)));
+  }
+
+  auto [program, loaded] = co_await async::when_all(
+    loadProgramAsync(
+      std::move(v), std::move(f)
+      #ifdef DEBUG
+      , log_stream
+      #endif
+    ),
+    async::when_all(std::move(loads))
+  );
+
+  co_return Material{program, std::move(loaded)};
+}
+#endif
@@ -0,0 +1,62 @@
+#ifndef __ASSET_LOADER_HPP__
+#define __ASSET_LOADER_HPP__
+/*
+  coroutine asset loading, built with `make COROUTINES=1`
+
+  each loader splits its work over the async executors: files are read on
+  the io threads, images decoded on the job system's workers, and shaders
+  compiled and textures uploaded on the main thread. a material starts its
+  shader and texture loads together with async::when_all, so all of their
+  reads are in flight at once and decoding overlaps with the remaining
+  reads and uploads:
+
+    Material m = async::sync_wait(
+      loadMaterialAsync(residency, v, f, {albedo, normal, roughness})
+    );
+
+  paths are resolved by the caller. decodes here bypass the residency's
+  disk cache, which is not safe to share between threads; reloads after
+  eviction still go through it. failures give a zero program or texture
+  id and are logged as the synchronous loaders log them; in debug builds
+  the program loaders take the log stream, which must outlive the task.
+*/
+
+#ifdef COROUTINES
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "texture_residency.hpp"
+#include "../util/async.hpp"
+#include "../util/file_io.hpp"
+#include "../util/xdg.hpp"
+
+struct Material {
+  GLuint program = 0;
+  std::vector<Texture> textures;
+};
+
+async::task<std::optional<std::string>> readFileAsync(xdg::path p);
+async::task<GLuint> loadProgramAsync(
+  xdg::path v, xdg::path f
+  #ifdef DEBUG
+  , fio::log_stream_f *log_stream
+  #endif
+);
+// a `.qtex` path loads the block compressed texture
+async::task<Texture> loadTextureAsync(TextureResidency &r, xdg::path p);
+async::task<Material> loadMaterialAsync(
+  TextureResidency &r, xdg::path v, xdg::path f,
+  std::vector<xdg::path> textures
+  #ifdef DEBUG
+  , fio::log_stream_f *log_stream
+  #endif
+);
+#endif
+
+#endif // __ASSET_LOADER_HPP__
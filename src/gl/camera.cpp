@@ -0,0 +1,40 @@
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "camera.hpp"
+#include "../util/counters.hpp"
+
+Camera createCamera() {
+  GLuint ubo;
+  glGenBuffers(1, &ubo);
+  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+  glBufferData(
+    GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW
+  );
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, camera_binding, ubo);
+
+  return {ubo};
+}
+
+void destroyCamera(Camera &c) {
+  glDeleteBuffers(1, &c.ubo);
+  c.ubo = 0;
+}
+
+void updateCamera(const Camera &c, const CameraBlock &block) {
+  glBindBuffer(GL_UNIFORM_BUFFER, c.ubo);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+  counters::count(counters::engine::bytes_streamed, sizeof(CameraBlock));
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+bool bindCameraBlock(const GLuint program) {
+  const GLuint index = glGetUniformBlockIndex(program, "Camera");
+  if (index == GL_INVALID_INDEX) { return false; }
+
+  glUniformBlockBinding(program, index, camera_binding);
+
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef __CAMERA_HPP__
+#define __CAMERA_HPP__
+/*
+  per-view uniform block shared by every program
+
+  glsl 330 cannot pick a binding point in the shader, so each program has its
+  `Camera` block pointed at `camera_binding` once after linking. after that
+  a camera update is a single buffer upload, however many programs use it.
+
+  layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec4 viewport; // x, y, width, height
+  };
+*/
+#include <cstddef>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+
+constexpr GLuint camera_binding = 0;
+
+struct CameraBlock {
+  glm::mat4 projection;
+  glm::mat4 view;
+  glm::vec4 viewport;
+};
+
+// std140: mat4 is four vec4 columns, vec4 is 16 byte aligned
+static_assert(offsetof(CameraBlock, projection) == 0);
+static_assert(offsetof(CameraBlock, view) == 64);
+static_assert(offsetof(CameraBlock, viewport) == 128);
+static_assert(sizeof(CameraBlock) == 144);
+
+struct Camera {
+  GLuint ubo = 0;
+};
+
+Camera createCamera();
+void destroyCamera(Camera &c);
+void updateCamera(const Camera &c, const CameraBlock &block);
+
+// returns false if the program has no active `Camera` block
+bool bindCameraBlock(const GLuint program);
+
+#endif // __CAMERA_HPP__
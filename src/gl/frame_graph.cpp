@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "frame_graph.hpp"
+#include "render_target.hpp"
+#include "../util/alloc_track.hpp"
+#include "../util/memory.hpp"
+
+static bool contains(const std::vector<int> &v, const int x) {
+  return std::find(v.begin(), v.end(), x) != v.end();
+}
+
+void resetFrameGraph(FrameGraph &g) {
+  g.resources.clear();
+  g.passes.clear();
+  g.order.clear();
+  g.compiled = false;
+  g.culled_passes = 0;
+  g.transient_targets = 0;
+  g.physical_targets = 0;
+}
+
+FrameResource createTransient(
+  FrameGraph &g, const std::string &name, const RenderTargetDesc &desc
+) {
+  FrameGraph::resource r;
+  r.name = name;
+  r.desc = desc;
+  g.resources.push_back(r);
+  g.compiled = false;
+  ++g.transient_targets;
+
+  return {int(g.resources.size()) - 1};
+}
+
+FrameResource importFramebuffer(
+  FrameGraph &g, const std::string &name, const Framebuffer &f
+) {
+  FrameGraph::resource r;
+  r.name = name;
+  r.desc.width = f.width;
+  r.desc.height = f.height;
+  r.imported = true;
+  r.output = true;
+  r.framebuffer = f;
+  g.resources.push_back(r);
+  g.compiled = false;
+
+  return {int(g.resources.size()) - 1};
+}
+
+void markOutput(FrameGraph &g, const FrameResource r) {
+  g.resources[r.index].output = true;
+  g.compiled = false;
+}
+
+int addPass(
+  FrameGraph &g, const std::string &name,
+  std::function<void(FramePassContext &)> execute, const bool side_effects
+) {
+  FrameGraph::pass p;
+  p.name = name;
+  p.execute = std::move(execute);
+  p.side_effects = side_effects;
+  g.passes.push_back(std::move(p));
+  g.compiled = false;
+
+  return g.passes.size() - 1;
+}
+
+void passReads(FrameGraph &g, const int pass, const FrameResource r) {
+  auto &reads = g.passes[pass].reads;
+  if (!contains(reads, r.index)) { reads.push_back(r.index); }
+  g.compiled = false;
+}
+
+void passWrites(FrameGraph &g, const int pass, const FrameResource r) {
+  auto &writes = g.passes[pass].writes;
+  if (!contains(writes, r.index)) { writes.push_back(r.index); }
+  g.compiled = false;
+}
+
+bool compileFrameGraph(FrameGraph &g) {
+  ALLOC_SCOPE(render);
+  const int n = g.passes.size();
+
+  // an imported framebuffer cannot share a pass with other attachments
+  for (const auto &p : g.passes) {
+    const bool imports = std::any_of(
+      p.writes.begin(), p.writes.end(),
+      [&](const int r) { return g.resources[r].imported; }
+    );
+    if (imports && p.writes.size() > 1) {
+      g.compiled = false;
+      return false;
+    }
+  }
+
+  std::vector<std::vector<int>> next(n);
+  std::vector<int> pending(n, 0); // unfinished prerequisites
+
+  auto edge = [&](const int from, const int to) {
+    if (from != to && !contains(next[from], to)) {
+      next[from].push_back(to);
+      ++pending[to];
+    }
+  };
+
+  // writers of a resource run in declaration order, and every pass that
+  // only reads it runs after the last writer
+  for (int r = 0; r < int(g.resources.size()); ++r) {
+    int last_writer = -1;
+    for (int p = 0; p < n; ++p) {
+      if (!contains(g.passes[p].writes, r)) { continue; }
+      if (last_writer >= 0) { edge(last_writer, p); }
+      last_writer = p;
+    }
+    if (last_writer < 0) { continue; }
+
+    for (int p = 0; p < n; ++p) {
+      if (contains(g.passes[p].reads, r) && !contains(g.passes[p].writes, r)) {
+        edge(last_writer, p);
+      }
+    }
+  }
+
+  // kahn's algorithm, taking the earliest declared ready pass each time so
+  // independent passes keep their declaration order
+  std::vector<int> sorted;
+  std::vector<bool> done(n, false);
+  while (int(sorted.size()) < n) {
+    int ready = -1;
+    for (int p = 0; p < n && ready < 0; ++p) {
+      if (!done[p] && pending[p] == 0) { ready = p; }
+    }
+    if (ready < 0) {
+      g.compiled = false;
+      return false;
+    }
+
+    done[ready] = true;
+    sorted.push_back(ready);
+    for (const int to : next[ready]) { --pending[to]; }
+  }
+
+  // walk back from the outputs; a pass lives if anything needs its writes
+  std::vector<bool> needed(g.resources.size());
+  for (std::size_t r = 0; r < g.resources.size(); ++r) {
+    needed[r] = g.resources[r].output;
+  }
+
+  g.culled_passes = 0;
+  for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+    auto &p = g.passes[*it];
+    p.culled = !p.side_effects && std::none_of(
+      p.writes.begin(), p.writes.end(), [&](const int r) { return needed[r]; }
+    );
+
+    if (p.culled) {
+      ++g.culled_passes;
+    } else {
+      for (const int r : p.reads) { needed[r] = true; }
+    }
+  }
+
+  g.order.clear();
+  for (const int p : sorted) {
+    if (!g.passes[p].culled) { g.order.push_back(p); }
+  }
+
+  for (auto &r : g.resources) { r.first_use = r.last_use = -1; }
+  for (int i = 0; i < int(g.order.size()); ++i) {
+    const auto &p = g.passes[g.order[i]];
+    for (const auto *list : {&p.reads, &p.writes}) {
+      for (const int r : *list) {
+        auto &res = g.resources[r];
+        if (res.first_use < 0) { res.first_use = i; }
+        res.last_use = i;
+      }
+    }
+  }
+
+  g.compiled = true;
+  return true;
+}
+
+static Framebuffer passFramebuffer(
+  FrameGraph &g, RenderTargetPool &pool, const FrameGraph::pass &p
+) {
+  RenderTarget colours[max_colour_attachments];
+  RenderTarget depth;
+  int count = 0;
+
+  for (const int r : p.writes) {
+    const auto &res = g.resources[r];
+    if (res.imported) { return res.framebuffer; }
+
+    if (isDepthTarget(res.desc)) {
+      depth = res.target;
+    } else if (count < max_colour_attachments) {
+      colours[count++] = res.target;
+    }
+  }
+
+  return framebufferFor(pool, colours, count, depth);
+}
+
+void executeFrameGraph(FrameGraph &g, RenderTargetPool &pool) {
+  ALLOC_SCOPE(render);
+  if (!g.compiled && !compileFrameGraph(g)) { return; }
+
+  std::pmr::vector<GLuint> physical(&mem::frame_arena());
+
+  for (int i = 0; i < int(g.order.size()); ++i) {
+    auto &p = g.passes[g.order[i]];
+
+    for (const auto *list : {&p.reads, &p.writes}) {
+      for (const int r : *list) {
+        auto &res = g.resources[r];
+        // a pass may list a resource as both read and written
+        if (res.imported || res.first_use != i || res.target.id != 0) {
+          continue;
+        }
+
+        res.target = acquireRenderTarget(pool, res.desc);
+        if (std::find(physical.begin(), physical.end(), res.target.id) ==
+          physical.end()) {
+          physical.push_back(res.target.id);
+        }
+      }
+    }
+
+    FramePassContext ctx = {g, pool, {}};
+    if (!p.writes.empty()) {
+      ctx.target = passFramebuffer(g, pool, p);
+      bindFramebuffer(ctx.target);
+    }
+    if (p.execute) { p.execute(ctx); }
+
+    for (const auto *list : {&p.reads, &p.writes}) {
+      for (const int r : *list) {
+        auto &res = g.resources[r];
+        if (res.imported || res.last_use != i || res.target.id == 0) {
+          continue;
+        }
+
+        releaseRenderTarget(pool, res.target);
+        res.target = {};
+      }
+    }
+  }
+
+  g.physical_targets = physical.size();
+}
+
+const RenderTarget &frameTarget(const FrameGraph &g, const FrameResource r) {
+  return g.resources[r.index].target;
+}
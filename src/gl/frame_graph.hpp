@@ -0,0 +1,103 @@
+#ifndef __FRAME_GRAPH_HPP__
+#define __FRAME_GRAPH_HPP__
+/*
+  frame graph of render passes
+
+  passes declare the resources they read and write instead of being called
+  in a hand-picked order. compiling the graph orders passes so every read
+  sees a resource's final contents: writers of one resource run in
+  declaration order and every pass that only reads it runs after the last
+  of them, even one declared between two writers. it also culls passes
+  whose results never reach an output and works out the first and last
+  pass using each transient target.
+
+  transients are acquired from the RenderTargetPool just before their first
+  pass and released right after their last, so later transients with the
+  same size and format land on the same gpu memory within the frame;
+  targets whose lifetimes do not overlap are aliased for free.
+
+  imported resources (the window, targets kept across frames) are outputs
+  and are never acquired or released by the graph.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "render_target.hpp"
+
+struct FrameResource {
+  int index = -1;
+};
+
+struct FrameGraph;
+
+struct FramePassContext {
+  FrameGraph &graph;
+  RenderTargetPool &pool;
+  Framebuffer target; // bound before the pass runs, if it writes anything
+};
+
+struct FrameGraph {
+  struct resource {
+    std::string name;
+    RenderTargetDesc desc;
+    bool imported = false;
+    bool output = false;
+    Framebuffer framebuffer; // imported resources only
+    RenderTarget target; // transients, while acquired
+    int first_use = -1; // position in `order`
+    int last_use = -1;
+  };
+
+  struct pass {
+    std::string name;
+    std::vector<int> reads;
+    std::vector<int> writes;
+    std::function<void(FramePassContext &)> execute;
+    bool side_effects = false; // never culled
+    bool culled = false;
+  };
+
+  std::vector<resource> resources;
+  std::vector<pass> passes;
+  std::vector<int> order; // alive passes, in execution order
+  bool compiled = false;
+
+  std::uint32_t culled_passes = 0;
+  std::uint32_t transient_targets = 0; // declared
+  std::uint32_t physical_targets = 0; // distinct targets last execute used
+};
+
+// drops every pass and resource
+void resetFrameGraph(FrameGraph &g);
+
+FrameResource createTransient(
+  FrameGraph &g, const std::string &name, const RenderTargetDesc &desc
+);
+FrameResource importFramebuffer(
+  FrameGraph &g, const std::string &name, const Framebuffer &f
+);
+// keeps the passes writing `r` alive
+void markOutput(FrameGraph &g, const FrameResource r);
+
+int addPass(
+  FrameGraph &g, const std::string &name,
+  std::function<void(FramePassContext &)> execute,
+  const bool side_effects=false
+);
+void passReads(FrameGraph &g, const int pass, const FrameResource r);
+// every write of a pass becomes one attachment of its framebuffer; an
+// imported framebuffer must be the only write
+void passWrites(FrameGraph &g, const int pass, const FrameResource r);
+
+// returns false if the declared reads and writes form a cycle, or a pass
+// writes an imported framebuffer along with anything else
+bool compileFrameGraph(FrameGraph &g);
+void executeFrameGraph(FrameGraph &g, RenderTargetPool &pool);
+
+// the target backing a transient, valid while its passes run
+const RenderTarget &frameTarget(const FrameGraph &g, const FrameResource r);
+
+#endif // __FRAME_GRAPH_HPP__
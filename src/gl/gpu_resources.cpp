@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "gpu_resources.hpp"
+#include "rect.hpp"
+#include "texture_units.hpp"
+#include "../util/counters.hpp"
+
+static const counters::id stale_handles = counters::add("gl.stale_handles");
+static const counters::id deferred_deletes = counters::add(
+  "gl.deferred_deletes"
+);
+
+static void deleteName(const GpuResourceKind kind, GLuint name) {
+  switch (kind) {
+    case GpuResourceKind::texture:
+      glDeleteTextures(1, &name);
+      forgetTexture(name);
+      break;
+    case GpuResourceKind::program:
+      glDeleteProgram(name);
+      break;
+    case GpuResourceKind::shader:
+      glDeleteShader(name);
+      break;
+    case GpuResourceKind::vertex_array:
+      glDeleteVertexArrays(1, &name);
+      if (current_vao == name) { current_vao = 0; }
+      break;
+    case GpuResourceKind::buffer:
+      glDeleteBuffers(1, &name);
+      break;
+    case GpuResourceKind::framebuffer:
+      glDeleteFramebuffers(1, &name);
+      break;
+    case GpuResourceKind::renderbuffer:
+      glDeleteRenderbuffers(1, &name);
+      break;
+  }
+}
+
+static bool matches(const GpuResourceTable &t, const GpuHandle h) {
+  if (!h || h.index > t.slots.size()) { return false; }
+
+  const GpuResourceTable::slot &s = t.slots[h.index - 1];
+  return s.generation == h.generation && s.name != 0;
+}
+
+// the slot `h` refers to if it is still the same object, counting stale
+// handles. the null handle is a valid way to say "nothing"
+static GpuResourceTable::slot *lookup(
+  GpuResourceTable &t, const GpuHandle h
+) {
+  if (matches(t, h)) { return &t.slots[h.index - 1]; }
+
+  if (h) {
+    ++t.stale_lookups;
+    counters::count(stale_handles);
+  }
+  return nullptr;
+}
+
+GpuHandle registerGpuResource(
+  GpuResourceTable &t, const GpuResourceKind kind, const GLuint name
+) {
+  if (name == 0) { return {}; }
+
+  if (t.free_list == 0) {
+    t.slots.emplace_back();
+    t.free_list = t.slots.size();
+  }
+
+  const std::uint32_t index = t.free_list;
+  GpuResourceTable::slot &s = t.slots[index - 1];
+  t.free_list = s.next_free;
+
+  s.name = name;
+  s.kind = kind;
+  s.next_free = 0;
+  s.last_used = t.frame;
+
+  ++t.live;
+  ++t.registered;
+  return {index, s.generation};
+}
+
+GLuint gpuName(GpuResourceTable &t, const GpuHandle h) {
+  GpuResourceTable::slot *s = lookup(t, h);
+  if (s == nullptr) { return 0; }
+
+  s->last_used = t.frame;
+  return s->name;
+}
+
+bool isLive(const GpuResourceTable &t, const GpuHandle h) {
+  return matches(t, h);
+}
+
+void releaseGpuResource(GpuResourceTable &t, const GpuHandle h) {
+  GpuResourceTable::slot *s = lookup(t, h);
+  if (s == nullptr) { return; }
+
+  // frames only move forward, so appending keeps `pending` sorted as long
+  // as the delay does not shrink while names are queued
+  const std::uint64_t delete_at = std::max(
+    s->last_used + t.delay, t.pending.empty() ? 0 : t.pending.back().delete_at
+  );
+  t.pending.push_back({s->name, s->kind, delete_at});
+
+  s->name = 0;
+  ++s->generation;
+  s->next_free = t.free_list;
+  t.free_list = h.index;
+  --t.live;
+}
+
+void advanceGpuFrame(GpuResourceTable &t) {
+  ++t.frame;
+
+  while (!t.pending.empty() && t.pending.front().delete_at <= t.frame) {
+    const auto &r = t.pending.front();
+    deleteName(r.kind, r.name);
+    t.pending.pop_front();
+
+    ++t.deleted;
+    counters::count(deferred_deletes);
+  }
+}
+
+void destroyGpuResourceTable(GpuResourceTable &t) {
+  for (const auto &r : t.pending) { deleteName(r.kind, r.name); }
+  t.deleted += t.pending.size() + t.live;
+  t.pending.clear();
+
+  // slots are kept with new generations, so no old handle matches again
+  t.free_list = 0;
+  for (std::uint32_t i = t.slots.size(); i > 0; --i) {
+    GpuResourceTable::slot &s = t.slots[i - 1];
+    if (s.name != 0) {
+      deleteName(s.kind, s.name);
+      s.name = 0;
+      ++s.generation;
+    }
+    s.next_free = t.free_list;
+    t.free_list = i;
+  }
+  t.live = 0;
+}
+
+GpuResource::GpuResource(
+  GpuResourceTable &t, const GpuResourceKind kind, const GLuint name
+) : table(&t), h(registerGpuResource(t, kind, name)) {}
+
+GpuResource::~GpuResource() {
+  reset();
+}
+
+GpuResource::GpuResource(GpuResource &&other) noexcept :
+  table(other.table), h(std::exchange(other.h, {})) {}
+
+GpuResource &GpuResource::operator=(GpuResource &&other) noexcept {
+  if (this != &other) {
+    reset();
+    table = other.table;
+    h = std::exchange(other.h, {});
+  }
+
+  return *this;
+}
+
+GLuint GpuResource::name() const {
+  return table ? gpuName(*table, h) : 0;
+}
+
+void GpuResource::reset() {
+  if (table && h) { releaseGpuResource(*table, h); }
+  h = {};
+}
@@ -0,0 +1,124 @@
+#ifndef __GPU_RESOURCES_HPP__
+#define __GPU_RESOURCES_HPP__
+/*
+  generational handles for gl objects, with deferred deletion
+
+  a GpuResourceTable owns gl names. registering one returns a GpuHandle, a
+  slot index plus the slot's generation; releasing it bumps the generation,
+  so every copy of the handle goes stale at once and resolves to 0 (and is
+  counted) instead of aliasing whatever the slot or the driver hands out
+  next. slots are recycled through a free list, so churn does not grow the
+  table.
+
+  released names are not deleted straight away: the gpu may still be
+  reading the object for frames already submitted, and deleting it then
+  can stall the driver. they are queued and deleted `delay` frames after
+  the frame they were last resolved in, from `advanceGpuFrame`.
+
+  GpuResource is the owning side, a move-only handle that releases on
+  destruction:
+
+    GpuResource program(gpu, GpuResourceKind::program, createProgram(v, f));
+    glUseProgram(program.name());
+*/
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+enum class GpuResourceKind : std::uint8_t {
+  texture,
+  program,
+  shader,
+  vertex_array,
+  buffer,
+  framebuffer,
+  renderbuffer
+};
+
+struct GpuHandle {
+  std::uint32_t index = 0; // slot + 1, zero is the null handle
+  std::uint32_t generation = 0;
+
+  explicit operator bool() const { return index != 0; }
+};
+
+inline bool operator==(const GpuHandle a, const GpuHandle b) {
+  return a.index == b.index && a.generation == b.generation;
+}
+inline bool operator!=(const GpuHandle a, const GpuHandle b) {
+  return !(a == b);
+}
+
+struct GpuResourceTable {
+  struct slot {
+    GLuint name = 0; // 0 while the slot is free
+    GpuResourceKind kind = GpuResourceKind::texture;
+    std::uint32_t generation = 1;
+    std::uint32_t next_free = 0; // as a handle index
+    std::uint64_t last_used = 0; // frame
+  };
+
+  struct retired {
+    GLuint name;
+    GpuResourceKind kind;
+    std::uint64_t delete_at; // frame
+  };
+
+  std::vector<slot> slots;
+  std::uint32_t free_list = 0; // handle index of the first free slot
+  std::deque<retired> pending; // in `delete_at` order
+  std::uint64_t frame = 0;
+  std::uint32_t delay = 3; // frames
+
+  std::uint32_t live = 0;
+  std::uint64_t registered = 0;
+  std::uint64_t deleted = 0;
+  std::uint64_t stale_lookups = 0;
+};
+
+// takes ownership of `name`. a zero name gives the null handle
+GpuHandle registerGpuResource(
+  GpuResourceTable &t, const GpuResourceKind kind, const GLuint name
+);
+// the gl name, marked as used this frame, or 0 for a null or stale handle
+GLuint gpuName(GpuResourceTable &t, const GpuHandle h);
+bool isLive(const GpuResourceTable &t, const GpuHandle h);
+// invalidates `h` and queues the name for deletion. releasing a stale
+// handle is counted and otherwise ignored
+void releaseGpuResource(GpuResourceTable &t, const GpuHandle h);
+// call once per frame after the swap; deletes the names that are due
+void advanceGpuFrame(GpuResourceTable &t);
+// deletes every name, live or pending, straight away (the context must
+// still be current). handles from before no longer resolve
+void destroyGpuResourceTable(GpuResourceTable &t);
+
+class GpuResource {
+public:
+  GpuResource() = default;
+  GpuResource(
+    GpuResourceTable &t, const GpuResourceKind kind, const GLuint name
+  );
+  ~GpuResource();
+
+  GpuResource(GpuResource &&other) noexcept;
+  GpuResource &operator=(GpuResource &&other) noexcept;
+  GpuResource(const GpuResource &) = delete;
+  GpuResource &operator=(const GpuResource &) = delete;
+
+  GLuint name() const;
+  // non-owning, for anything that only needs to look the object up
+  GpuHandle handle() const { return h; }
+  explicit operator bool() const { return bool(h); }
+
+  // releases the object now
+  void reset();
+
+private:
+  GpuResourceTable *table = nullptr;
+  GpuHandle h;
+};
+
+#endif // __GPU_RESOURCES_HPP__
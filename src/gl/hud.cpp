@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+
+#include "hud.hpp"
+#include "quad_batch.hpp"
+#include "text_renderer.hpp"
+#include "../util/alloc_track.hpp"
+#include "../util/counters.hpp"
+#include "../util/text.hpp"
+
+constexpr float margin = 8;
+constexpr float text_size = 14;
+constexpr float line = text_size * text::line_height / text::em;
+constexpr float char_width = text_size * text::advance / text::em;
+constexpr float label_width = 20 * char_width;
+constexpr float panel_width = label_width + 14 * char_width;
+constexpr float graph_height = 32;
+
+constexpr std::uint32_t panel_colour = 0xb0000000;
+constexpr std::uint32_t graph_colour = 0x40ffffff;
+
+// into `out`, so a refresh reuses the row's string
+static void formatValue(
+  const std::uint64_t v, const counters::unit_t unit, std::string &out
+) {
+  char s[32];
+  const double d = double(v);
+
+  switch (unit) {
+    case counters::unit_t::bytes:
+      if (v >= std::uint64_t(1) << 30) {
+        std::snprintf(s, sizeof(s), "%.2f GiB", d / (1 << 30));
+      } else if (v >= 1 << 20) {
+        std::snprintf(s, sizeof(s), "%.2f MiB", d / (1 << 20));
+      } else if (v >= 1 << 10) {
+        std::snprintf(s, sizeof(s), "%.2f KiB", d / (1 << 10));
+      } else {
+        std::snprintf(s, sizeof(s), "%llu B", (unsigned long long)v);
+      }
+      break;
+    case counters::unit_t::microseconds:
+      std::snprintf(s, sizeof(s), "%.2f ms", d / 1000);
+      break;
+    default:
+      std::snprintf(s, sizeof(s), "%llu", (unsigned long long)v);
+      break;
+  }
+
+  out.assign(s);
+}
+
+Hud createHud(const GLuint program) {
+  Hud h;
+  h.program = program;
+  h.batch = createQuadBatch(4096, 16384);
+  h.text = createTextRenderer();
+
+  return h;
+}
+
+void destroyHud(Hud &h) {
+  destroyQuadBatch(h.batch);
+  destroyTextRenderer(h.text);
+
+  h = Hud();
+}
+
+void addHudCounter(
+  Hud &h, const std::string_view name, const std::string_view label,
+  const bool graph, const std::uint32_t colour
+) {
+  h.rows.push_back({
+    counters::add(name), std::string(label), "", colour, graph
+  });
+}
+
+static void refresh(Hud &h) {
+  for (auto &r : h.rows) {
+    const counters::counter &c = counters::get(r.counter);
+    formatValue(counters::last(r.counter), c.unit, r.value);
+  }
+
+  h.refreshed = counters::frames();
+}
+
+// a bar per frame of history, newest on the right, scaled to the largest
+// value shown
+static void drawGraph(
+  Hud &h, const Hud::row &r, const float x, const float y, const float w
+) {
+  const counters::counter &c = counters::get(r.counter);
+  const std::uint64_t frames = counters::frames();
+  const std::size_t n = std::min<std::uint64_t>(
+    counters::history_length, frames
+  );
+  const float bar_width = w / counters::history_length;
+
+  std::uint64_t peak = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t f = frames - 1 - i;
+    peak = std::max(peak, c.history[f % counters::history_length]);
+  }
+
+  drawSolid(h.text, h.batch, {x, y, x + w, y + graph_height}, graph_colour);
+  const float k = graph_height / peak;
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t v = c.history[
+      (frames - 1 - i) % counters::history_length
+    ];
+    if (v == 0) { continue; }
+
+    const float right = x + w - i * bar_width;
+    drawSolid(
+      h.text, h.batch, {right - bar_width, y, right, y + v * k}, r.colour
+    );
+  }
+}
+
+void drawHud(Hud &h, const int height) {
+  ALLOC_SCOPE(render);
+  if (!h.visible || h.rows.empty()) { return; }
+
+  const std::uint64_t frames = counters::frames();
+  if (h.refreshed == 0 || frames - h.refreshed >= h.refresh_frames) {
+    refresh(h);
+  }
+
+  float panel_height = margin;
+  for (const auto &r : h.rows) {
+    panel_height += line + (r.graph ? graph_height + margin : 0);
+  }
+
+  const float top = height - margin;
+  beginQuadBatch(h.batch);
+  drawSolid(
+    h.text, h.batch,
+    {margin, top - panel_height - margin, margin * 2 + panel_width, top},
+    panel_colour
+  );
+
+  float y = top - margin;
+  for (const auto &r : h.rows) {
+    y -= line;
+    const float baseline = y + (line - text_size) * 0.5f +
+      text_size * text::baseline / text::em;
+    drawText(h.text, h.batch, r.label, {margin * 2, baseline}, text_size);
+    drawText(
+      h.text, h.batch, r.value, {margin * 2 + label_width, baseline},
+      text_size, r.colour, false
+    );
+
+    if (r.graph) {
+      y -= graph_height + margin;
+      drawGraph(h, r, margin * 2, y + margin * 0.5f, panel_width);
+    }
+  }
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glUseProgram(h.program);
+  counters::count(counters::engine::state_changes);
+  endQuadBatch(h.batch);
+  glDisable(GL_BLEND);
+}
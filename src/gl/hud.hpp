@@ -0,0 +1,59 @@
+#ifndef __HUD_HPP__
+#define __HUD_HPP__
+/*
+  on-screen performance overlay
+
+  shows counters from the counters registry as text and rolling graphs of
+  their history, drawn in the top left corner. text, panel and bars all go
+  through one QuadBatch with the text atlas, so the hud is a single draw.
+  values are reformatted a few times a second rather than every frame and
+  laid out without the run cache, which keeps the labels.
+
+  draw it with the program built from data/shaders/quad/vshader.glsl and
+  data/shaders/text/fshader.glsl, under a pixel space camera.
+*/
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "quad_batch.hpp"
+#include "text_renderer.hpp"
+#include "../util/counters.hpp"
+
+struct Hud {
+  struct row {
+    counters::id counter;
+    std::string label;
+    std::string value; // formatted at the last refresh
+    std::uint32_t colour;
+    bool graph;
+  };
+
+  bool visible = false;
+  GLuint program = 0; // may be changed between draws
+  QuadBatch batch;
+  TextRenderer text;
+  std::vector<row> rows;
+
+  std::uint64_t refresh_frames = 15;
+  std::uint64_t refreshed = 0; // counters::frames() when values were made
+};
+
+Hud createHud(const GLuint program);
+void destroyHud(Hud &h);
+
+// adds a row for counter `name`, registering it if nothing has yet. with
+// `graph` the row also gets a rolling graph of its history
+void addHudCounter(
+  Hud &h, const std::string_view name, const std::string_view label,
+  const bool graph=false, const std::uint32_t colour=0xffffffff
+);
+
+// draws into the bound framebuffer, `height` is its height in pixels
+void drawHud(Hud &h, const int height);
+
+#endif // __HUD_HPP__
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "quad_batch.hpp"
+#include "rect.hpp"
+#include "stream_buffer.hpp"
+#include "texture.hpp"
+#include "texture_units.hpp"
+#include "vertex_layout.hpp"
+#include "../util/counters.hpp"
+
+static_assert(vtx::unused_bytes<QuadVertex>() == 0, "padded quad vertex");
+
+constexpr GLsizei max_indexed_quads = 65536 / 4;
+
+QuadBatch createQuadBatch(
+  const GLsizei max_quads, const GLsizei quads_per_frame
+) {
+  QuadBatch b;
+  b.max_quads = std::clamp<GLsizei>(max_quads, 1, max_indexed_quads);
+  b.vertices = createStreamBuffer(
+    GL_ARRAY_BUFFER, GLsizeiptr(quads_per_frame) * 4 * sizeof(QuadVertex)
+  );
+
+  // a___d
+  // |\ |
+  // |_\|
+  // b   c
+  std::vector<std::uint16_t> indices(b.max_quads * 6);
+  for (GLsizei q = 0; q < b.max_quads; ++q) {
+    const std::uint16_t v = q * 4;
+    const std::uint16_t quad[6] = {
+      v, std::uint16_t(v + 1), std::uint16_t(v + 2),
+      v, std::uint16_t(v + 2), std::uint16_t(v + 3)
+    };
+    std::memcpy(&indices[q * 6], quad, sizeof(quad));
+  }
+
+  glGenVertexArrays(1, &b.vao);
+  glGenBuffers(1, &b.indices);
+
+  glBindVertexArray(b.vao);
+  current_vao = b.vao;
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b.indices);
+  glBufferData(
+    GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint16_t),
+    indices.data(), GL_STATIC_DRAW
+  );
+
+  return b;
+}
+
+void destroyQuadBatch(QuadBatch &b) {
+  if (current_vao == b.vao) {
+    glBindVertexArray(0);
+    current_vao = 0;
+  }
+
+  glDeleteVertexArrays(1, &b.vao);
+  glDeleteBuffers(1, &b.indices);
+  destroyStreamBuffer(b.vertices);
+  b.vao = 0;
+  b.indices = 0;
+}
+
+void beginQuadBatch(QuadBatch &b) {
+  beginStreamFrame(b.vertices);
+}
+
+static bool mapQuads(QuadBatch &b) {
+  const GLintptr head = b.vertices.head;
+  const GLsizeiptr left = b.vertices.region_size - head;
+  const GLsizei quads = std::min<GLsizeiptr>(
+    b.max_quads, left / GLsizeiptr(4 * sizeof(QuadVertex))
+  );
+  if (quads == 0) { return false; }
+
+  b.mapped = static_cast<QuadVertex *>(mapStream(
+    b.vertices, GLsizeiptr(quads) * 4 * sizeof(QuadVertex), b.offset,
+    sizeof(QuadVertex)
+  ));
+  b.mapped_quads = b.mapped ? quads : 0;
+
+  return b.mapped != nullptr;
+}
+
+void writeQuad(
+  QuadVertex *v, const float *corners, const glm::vec4 &uv,
+  const std::uint32_t colour, const float layer
+) {
+  const vtx::rgba8 c = {
+    std::uint8_t(colour), std::uint8_t(colour >> 8),
+    std::uint8_t(colour >> 16), std::uint8_t(colour >> 24)
+  };
+  const vtx::unorm16x2 tex_coords[4] = {
+    {vtx::unorm16(uv.x), vtx::unorm16(uv.w)}, // a
+    {vtx::unorm16(uv.x), vtx::unorm16(uv.y)}, // b
+    {vtx::unorm16(uv.z), vtx::unorm16(uv.y)}, // c
+    {vtx::unorm16(uv.z), vtx::unorm16(uv.w)} // d
+  };
+
+  for (int i = 0; i < 4; ++i) {
+    v[i] = {{corners[i * 2], corners[i * 2 + 1]}, tex_coords[i], c, layer};
+  }
+}
+
+void pushQuad(
+  QuadBatch &b, const Texture &t, const float *corners, const glm::vec4 &uv,
+  const std::uint32_t colour
+) {
+  // a plain 2d texture would be bound as an array at the flush
+  if (t.layer < 0) {
+    ++b.rejected;
+    return;
+  }
+  if (b.quads > 0 && (t.id != b.array || b.quads == b.mapped_quads)) {
+    flushQuadBatch(b);
+  }
+  if (b.mapped == nullptr && !mapQuads(b)) {
+    ++b.dropped;
+    return;
+  }
+  b.array = t.id;
+
+  writeQuad(b.mapped + b.quads * 4, corners, uv, colour, float(t.layer));
+  ++b.quads;
+}
+
+void flushQuadBatch(QuadBatch &b) {
+  if (b.mapped == nullptr) { return; }
+
+  unmapStream(b.vertices, GLsizeiptr(b.quads) * 4 * sizeof(QuadVertex));
+  b.mapped = nullptr;
+  b.mapped_quads = 0;
+  if (b.quads == 0) { return; }
+
+  const std::uint64_t binds = textureUnits().binds;
+  bindTexture({b.array, 0}, 0);
+  b.binds += textureUnits().binds - binds;
+  // no sampler, so the array's own parameters apply (the text atlas clamps)
+  bindSampler(0, 0);
+
+  if (current_vao != b.vao) {
+    glBindVertexArray(b.vao);
+    current_vao = b.vao;
+    counters::count(counters::engine::state_changes);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, b.vertices.buffer);
+  setupVertexAttribs<QuadVertex>(b.offset);
+
+  glDrawElements(GL_TRIANGLES, b.quads * 6, GL_UNSIGNED_SHORT, nullptr);
+
+  ++b.draws;
+  counters::count(counters::engine::draw_calls);
+  b.quads_drawn += b.quads;
+  b.quads = 0;
+}
+
+void endQuadBatch(QuadBatch &b) {
+  flushQuadBatch(b);
+  endStreamFrame(b.vertices);
+}
@@ -0,0 +1,86 @@
+#ifndef __QUAD_BATCH_HPP__
+#define __QUAD_BATCH_HPP__
+/*
+  batched textured quads sampling from texture arrays
+
+  every quad carries the array layer it samples in its vertices, so quads
+  using any layer of the same array go out in one draw; a draw is only
+  split when the array changes or `max_quads` is reached. vertices are
+  written into a StreamBuffer region per frame and indexed by a static
+  index buffer shared by every draw.
+
+  draw with the program built from data/shaders/quad, whose
+  `sampler2DArray textures` reads unit 0, with the array's own sampling
+  parameters: flushing binds sampler 0 there.
+*/
+#include <cstdint>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+
+#include "stream_buffer.hpp"
+#include "texture.hpp"
+#include "vertex_layout.hpp"
+
+struct QuadVertex {
+  glm::vec2 pos;
+  vtx::unorm16x2 tex_coords;
+  vtx::rgba8 colour;
+  float layer;
+};
+
+template <> struct vtx::layout<QuadVertex> {
+  static constexpr std::array<vtx::attribute, 4> attributes = {
+    VTX_ATTRIB(0, QuadVertex, pos),
+    VTX_ATTRIB(1, QuadVertex, colour),
+    VTX_ATTRIB(2, QuadVertex, tex_coords),
+    VTX_ATTRIB(3, QuadVertex, layer)
+  };
+};
+
+struct QuadBatch {
+  GLuint vao = 0;
+  GLuint indices = 0;
+  StreamBuffer vertices;
+  GLsizei max_quads = 0; // per draw
+
+  GLuint array = 0; // texture array of the pending quads
+  QuadVertex *mapped = nullptr;
+  GLintptr offset = 0;
+  GLsizei quads = 0; // pending
+  GLsizei mapped_quads = 0;
+
+  std::uint64_t draws = 0;
+  std::uint64_t binds = 0;
+  std::uint64_t quads_drawn = 0;
+  std::uint64_t dropped = 0; // quads that did not fit in the frame's region
+  std::uint64_t rejected = 0; // quads whose texture is not an array layer
+};
+
+// `max_quads` is capped at 16384 so indices fit in 16 bits
+QuadBatch createQuadBatch(
+  const GLsizei max_quads=4096, const GLsizei quads_per_frame=65536
+);
+void destroyQuadBatch(QuadBatch &b);
+
+void beginQuadBatch(QuadBatch &b);
+// `corners` are a, b, c, d as written by xform::quad_vertices, `uv` is
+// (u0, v0, u1, v1) and `colour` rgba8 with r in the lowest byte. `t` must
+// be a layer of a texture array; quads with any other texture are rejected
+void pushQuad(
+  QuadBatch &b, const Texture &t, const float *corners, const glm::vec4 &uv,
+  const std::uint32_t colour=0xffffffff
+);
+void flushQuadBatch(QuadBatch &b);
+// the four vertices pushQuad writes for a quad once the batch has room,
+// without touching gl
+void writeQuad(
+  QuadVertex *v, const float *corners, const glm::vec4 &uv,
+  const std::uint32_t colour, const float layer
+);
+// flushes and fences the frame's vertices
+void endQuadBatch(QuadBatch &b);
+
+#endif // __QUAD_BATCH_HPP__
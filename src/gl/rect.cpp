@@ -1,9 +1,12 @@
 #include <cstddef> // std::size_t
+#include <cstdint>
 
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
 #include "rect.hpp"
+#include "vertex_layout.hpp"
+#include "../util/counters.hpp"
 
 /*
   a___d
@@ -11,12 +14,15 @@
   |_\|
   b   c
 */
-constexpr GLfloat vertex_data[12] = {
-  // vertex/texture cooordinates
-  0.0, 1.0, 0.0, // a
-  0.0, 0.0, 0.0, // b
-  1.0, 0.0, 0.0, // c
-  1.0, 1.0, 0.0, // d
+static_assert(vtx::unused_bytes<RectVertex>() == 0, "padded rect vertex");
+
+constexpr std::uint16_t uv_one = vtx::unorm16(1.0);
+const RectVertex vertex_data[4] = {
+  // position, colour, texture coordinates
+  {{0.0, 1.0, 0.0}, {}, {0, uv_one}}, // a
+  {{0.0, 0.0, 0.0}, {}, {0, 0}}, // b
+  {{1.0, 0.0, 0.0}, {}, {uv_one, 0}}, // c
+  {{1.0, 1.0, 0.0}, {}, {uv_one, uv_one}}, // d
 };
 
 constexpr GLuint indices[6] = {
@@ -36,16 +42,8 @@ Rect createRect() {
   glBufferData(
     GL_ARRAY_BUFFER, sizeof(vertex_data), vertex_data, GL_STATIC_DRAW
   );
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(
-    0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), reinterpret_cast<void *>(0)
-  );
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(
-    2, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), reinterpret_cast<void *>(0)
-  );
+  setupVertexAttribs<RectVertex>();
 
-  GLuint ebo;
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
   glBufferData(
     GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW
@@ -54,16 +52,17 @@ Rect createRect() {
   glBindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  glDeleteBuffers(2, buffers);
 
-  return {vao};
+  return {vao, buffers[0], buffers[1]};
 }
 
 void drawRect(const Rect &r) {
   if (current_vao != r.vao) {
     glBindVertexArray(r.vao);
     current_vao = r.vao;
+    counters::count(counters::engine::state_changes);
   }
 
   glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  counters::count(counters::engine::draw_calls);
 }
@@ -4,12 +4,33 @@
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
-static GLuint current_vao = 0;
+#include "glm/glm.hpp"
+
+#include "vertex_layout.hpp"
+
+inline GLuint current_vao = 0;
+
+struct RectVertex {
+  glm::vec3 pos;
+  vtx::rgba8 colour;
+  vtx::unorm16x2 tex_coords;
+};
+
+template <> struct vtx::layout<RectVertex> {
+  static constexpr std::array<vtx::attribute, 3> attributes = {
+    VTX_ATTRIB(0, RectVertex, pos),
+    VTX_ATTRIB(1, RectVertex, colour),
+    VTX_ATTRIB(2, RectVertex, tex_coords)
+  };
+};
 
 struct Rect {
   GLuint vao = 0;
+  GLuint vbo = 0;
+  GLuint ebo = 0;
 };
 
+// the caller owns all three names
 Rect createRect();
 void drawRect(const Rect &r);
 
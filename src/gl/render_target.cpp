@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "render_target.hpp"
+#include "texture.hpp"
+#include "texture_units.hpp"
+#include "../util/counters.hpp"
+
+static const counters::id target_bytes = counters::add(
+  "memory.render_targets", counters::kind_t::gauge, counters::unit_t::bytes
+);
+
+static bool isDepthFormat(const GLenum f) {
+  switch (f) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool hasStencil(const GLenum f) {
+  return f == GL_DEPTH24_STENCIL8 || f == GL_DEPTH32F_STENCIL8;
+}
+
+bool isDepthTarget(const RenderTargetDesc &desc) {
+  return isDepthFormat(desc.internal_format);
+}
+
+std::size_t renderTargetBytes(const RenderTargetDesc &desc) {
+  std::size_t texel;
+  switch (desc.internal_format) {
+    case GL_R8: texel = 1; break;
+    case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: texel = 2; break;
+    case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: texel = 8; break;
+    case GL_RGBA32F: texel = 16; break;
+    default: texel = 4; // rgba8, rgb10_a2, r11f_g11f_b10f, depth24(_stencil8)
+  }
+
+  return std::size_t(desc.width) * desc.height * texel;
+}
+
+static RenderTarget createTarget(const RenderTargetDesc &desc) {
+  RenderTarget t;
+  t.desc = desc;
+
+  if (desc.renderbuffer) {
+    glGenRenderbuffers(1, &t.id);
+    glBindRenderbuffer(GL_RENDERBUFFER, t.id);
+    glRenderbufferStorage(
+      GL_RENDERBUFFER, desc.internal_format, desc.width, desc.height
+    );
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    return t;
+  }
+
+  t.id = createTexture().id;
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  // no data is uploaded, but format and type still have to match
+  GLenum format = GL_RGBA;
+  GLenum type = GL_UNSIGNED_BYTE;
+  if (hasStencil(desc.internal_format)) {
+    format = GL_DEPTH_STENCIL;
+    type = desc.internal_format == GL_DEPTH24_STENCIL8
+      ? GL_UNSIGNED_INT_24_8 : GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+  } else if (isDepthFormat(desc.internal_format)) {
+    format = GL_DEPTH_COMPONENT;
+    type = GL_FLOAT;
+  }
+
+  glTexImage2D(
+    GL_TEXTURE_2D, 0, desc.internal_format, desc.width, desc.height, 0,
+    format, type, nullptr
+  );
+
+  return t;
+}
+
+static void destroyFramebuffersUsing(RenderTargetPool &p, const GLuint id) {
+  auto uses = [id](const RenderTargetPool::framebuffer_entry &e) {
+    return e.depth == id ||
+      std::find(e.colours.begin(), e.colours.end(), id) != e.colours.end();
+  };
+
+  for (auto &e : p.framebuffers) {
+    if (uses(e)) { glDeleteFramebuffers(1, &e.framebuffer.fbo); }
+  }
+  p.framebuffers.erase(
+    std::remove_if(p.framebuffers.begin(), p.framebuffers.end(), uses),
+    p.framebuffers.end()
+  );
+}
+
+static void destroyTarget(RenderTargetPool &p, RenderTargetPool::slot &s) {
+  destroyFramebuffersUsing(p, s.target.id);
+
+  if (s.target.desc.renderbuffer) {
+    glDeleteRenderbuffers(1, &s.target.id);
+  } else {
+    Texture t = renderTargetTexture(s.target);
+    deleteTexture(t);
+  }
+
+  p.bytes_allocated -= s.bytes;
+  counters::set(target_bytes, p.bytes_allocated);
+  ++p.stats.destroyed;
+}
+
+RenderTargetPool createRenderTargetPool(const std::uint64_t max_idle_frames) {
+  RenderTargetPool p;
+  p.max_idle_frames = max_idle_frames;
+
+  return p;
+}
+
+void destroyRenderTargetPool(RenderTargetPool &p) {
+  for (auto &s : p.slots) { destroyTarget(p, s); }
+
+  p.slots.clear();
+  p.framebuffers.clear();
+}
+
+static void removeIf(
+  RenderTargetPool &p, bool (*drop)(const RenderTargetPool &,
+  const RenderTargetPool::slot &)
+) {
+  auto keep = p.slots.begin();
+  for (auto it = p.slots.begin(); it != p.slots.end(); ++it) {
+    if (drop(p, *it)) {
+      destroyTarget(p, *it);
+    } else {
+      *keep++ = *it;
+    }
+  }
+  p.slots.erase(keep, p.slots.end());
+}
+
+void beginRenderTargetFrame(RenderTargetPool &p) {
+  p.last_frame = p.stats;
+  p.stats = RenderTargetStats();
+  ++p.frame;
+
+  using slot = RenderTargetPool::slot;
+  removeIf(p, [](const RenderTargetPool &pool, const slot &s) {
+    return !s.in_use && pool.frame - s.last_used > pool.max_idle_frames;
+  });
+
+  // targets held across frames still count against this one
+  for (const auto &s : p.slots) {
+    if (s.in_use) { p.stats.bytes_in_use += s.bytes; }
+  }
+  p.stats.peak_bytes_in_use = p.stats.bytes_in_use;
+}
+
+void trimRenderTargets(RenderTargetPool &p) {
+  removeIf(p, [](const RenderTargetPool &, const RenderTargetPool::slot &s) {
+    return !s.in_use;
+  });
+}
+
+static bool sameDesc(const RenderTargetDesc &a, const RenderTargetDesc &b) {
+  return a.width == b.width && a.height == b.height &&
+    a.internal_format == b.internal_format && a.renderbuffer == b.renderbuffer;
+}
+
+RenderTarget acquireRenderTarget(
+  RenderTargetPool &p, const RenderTargetDesc &desc
+) {
+  ++p.stats.acquired;
+
+  RenderTargetPool::slot *slot = nullptr;
+  for (auto &s : p.slots) {
+    if (!s.in_use && sameDesc(s.target.desc, desc)) {
+      slot = &s;
+      ++p.stats.reused;
+      break;
+    }
+  }
+
+  if (slot == nullptr) {
+    RenderTargetPool::slot s;
+    s.target = createTarget(desc);
+    s.bytes = renderTargetBytes(desc);
+    p.bytes_allocated += s.bytes;
+    counters::set(target_bytes, p.bytes_allocated);
+    ++p.stats.created;
+
+    p.slots.push_back(s);
+    slot = &p.slots.back();
+  }
+
+  slot->in_use = true;
+  slot->last_used = p.frame;
+  p.stats.bytes_in_use += slot->bytes;
+  p.stats.peak_bytes_in_use = std::max(
+    p.stats.peak_bytes_in_use, p.stats.bytes_in_use
+  );
+
+  return slot->target;
+}
+
+void releaseRenderTarget(RenderTargetPool &p, const RenderTarget &t) {
+  for (auto &s : p.slots) {
+    if (s.target.id == t.id && s.target.desc.renderbuffer == t.desc.renderbuffer
+      && s.in_use) {
+      s.in_use = false;
+      s.last_used = p.frame;
+      p.stats.bytes_in_use -= std::min(p.stats.bytes_in_use, s.bytes);
+      return;
+    }
+  }
+}
+
+static void attach(const GLenum attachment, const RenderTarget &t) {
+  if (t.desc.renderbuffer) {
+    glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, t.id
+    );
+  } else {
+    glFramebufferTexture2D(
+      GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, t.id, 0
+    );
+  }
+}
+
+Framebuffer framebufferFor(
+  RenderTargetPool &p, const RenderTarget *colours, const int count,
+  const RenderTarget &depth
+) {
+  RenderTargetPool::framebuffer_entry key;
+  const int n = std::clamp(count, 0, max_colour_attachments);
+  for (int i = 0; i < n; ++i) { key.colours[i] = colours[i].id; }
+  key.depth = depth.id;
+
+  for (const auto &e : p.framebuffers) {
+    if (e.colours == key.colours && e.depth == key.depth) {
+      return e.framebuffer;
+    }
+  }
+
+  const RenderTarget &first = n > 0 ? colours[0] : depth;
+  key.framebuffer.width = first.desc.width;
+  key.framebuffer.height = first.desc.height;
+
+  glGenFramebuffers(1, &key.framebuffer.fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, key.framebuffer.fbo);
+
+  GLenum draw_buffers[max_colour_attachments];
+  for (int i = 0; i < n; ++i) {
+    attach(GL_COLOR_ATTACHMENT0 + i, colours[i]);
+    draw_buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+  }
+  if (n > 0) {
+    glDrawBuffers(n, draw_buffers);
+  } else {
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+  }
+  if (depth.id != 0) {
+    attach(
+      hasStencil(depth.desc.internal_format)
+        ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+      depth
+    );
+  }
+
+  const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    glDeleteFramebuffers(1, &key.framebuffer.fbo);
+    return {};
+  }
+
+  ++p.stats.framebuffers_created;
+  p.framebuffers.push_back(key);
+
+  return key.framebuffer;
+}
+
+void bindFramebuffer(const Framebuffer &f) {
+  glBindFramebuffer(GL_FRAMEBUFFER, f.fbo);
+  counters::count(counters::engine::state_changes);
+  glViewport(0, 0, f.width, f.height);
+}
+
+void blitFramebuffer(const Framebuffer &src, const Framebuffer &dst) {
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, src.fbo);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst.fbo);
+  glBlitFramebuffer(
+    0, 0, src.width, src.height, 0, 0, dst.width, dst.height,
+    GL_COLOR_BUFFER_BIT, GL_LINEAR
+  );
+  glBindFramebuffer(GL_FRAMEBUFFER, dst.fbo);
+  counters::count(counters::engine::state_changes, 3);
+}
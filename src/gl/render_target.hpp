@@ -0,0 +1,116 @@
+#ifndef __RENDER_TARGET_HPP__
+#define __RENDER_TARGET_HPP__
+/*
+  offscreen framebuffers backed by a transient render target pool
+
+  passes acquire the targets they draw into for the current frame and
+  release them when the last reader is done. released targets stay
+  allocated and are handed out again to the next request with the same
+  size and format, so a steady frame allocates no gpu memory at all;
+  targets nobody asked for in `max_idle_frames` frames are deleted (which
+  is how targets of an old window size go away after a resize). framebuffer
+  objects are cached per attachment set for the same reason.
+
+  sampled targets are textures (clamped, linear), depth and stencil targets
+  that are never sampled can be renderbuffers instead. the clamping is set
+  on the texture, so read a target with sampler 0 bound on its unit.
+*/
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+
+constexpr int max_colour_attachments = 4;
+
+struct RenderTargetDesc {
+  int width = 0;
+  int height = 0;
+  GLenum internal_format = GL_RGBA8;
+  bool renderbuffer = false;
+};
+
+struct RenderTarget {
+  GLuint id = 0; // texture or renderbuffer name
+  RenderTargetDesc desc;
+};
+
+// sample from a texture backed target
+inline Texture renderTargetTexture(const RenderTarget &t) {
+  return {t.id};
+}
+
+struct Framebuffer {
+  GLuint fbo = 0; // 0 is the window
+  int width = 0;
+  int height = 0;
+};
+
+struct RenderTargetStats {
+  std::uint32_t acquired = 0;
+  std::uint32_t reused = 0;
+  std::uint32_t created = 0;
+  std::uint32_t destroyed = 0;
+  std::uint32_t framebuffers_created = 0;
+  std::size_t bytes_in_use = 0; // acquired and not yet released
+  std::size_t peak_bytes_in_use = 0;
+};
+
+struct RenderTargetPool {
+  struct slot {
+    RenderTarget target;
+    std::size_t bytes = 0;
+    bool in_use = false;
+    std::uint64_t last_used = 0; // frame
+  };
+
+  struct framebuffer_entry {
+    std::array<GLuint, max_colour_attachments> colours = {};
+    GLuint depth = 0;
+    Framebuffer framebuffer;
+  };
+
+  std::vector<slot> slots;
+  std::vector<framebuffer_entry> framebuffers;
+  std::uint64_t frame = 0;
+  std::uint64_t max_idle_frames = 4;
+
+  std::size_t bytes_allocated = 0;
+  RenderTargetStats stats; // of the current frame
+  RenderTargetStats last_frame;
+};
+
+RenderTargetPool createRenderTargetPool(const std::uint64_t max_idle_frames=4);
+void destroyRenderTargetPool(RenderTargetPool &p);
+
+// rolls the frame statistics over and deletes idle targets
+void beginRenderTargetFrame(RenderTargetPool &p);
+// deletes every target not in use, e.g. after the window was resized
+void trimRenderTargets(RenderTargetPool &p);
+
+RenderTarget acquireRenderTarget(
+  RenderTargetPool &p, const RenderTargetDesc &desc
+);
+void releaseRenderTarget(RenderTargetPool &p, const RenderTarget &t);
+
+// a complete framebuffer drawing into `colours` (and `depth` when its id is
+// not 0), created on first use. returns a zero fbo if incomplete
+Framebuffer framebufferFor(
+  RenderTargetPool &p, const RenderTarget *colours, const int count,
+  const RenderTarget &depth={}
+);
+// binds for drawing and sets the viewport to cover it
+void bindFramebuffer(const Framebuffer &f);
+// copies the first colour attachment, scaling if the sizes differ, and
+// leaves `dst` bound
+void blitFramebuffer(const Framebuffer &src, const Framebuffer &dst);
+
+std::size_t renderTargetBytes(const RenderTargetDesc &desc);
+// depth (and depth stencil) formats attach as depth, everything else colour
+bool isDepthTarget(const RenderTargetDesc &desc);
+
+#endif // __RENDER_TARGET_HPP__
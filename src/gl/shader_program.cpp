@@ -1,3 +1,4 @@
+#include <fstream>
 #include <optional>
 #include <string>
 
@@ -5,15 +6,38 @@
 #include <GLFW/glfw3.h>
 
 #include "shader_program.hpp"
+#include "../util/alloc_track.hpp"
+#include "../util/event_log.hpp"
+#include "../util/file_io.hpp"
+#include "../util/metrics.hpp"
+
+static metrics::histogram &compile_time = metrics::add_histogram(
+  "qogl_shader_compile_seconds", "time spent in glCompileShader"
+);
+static metrics::histogram &link_time = metrics::add_histogram(
+  "qogl_program_link_seconds", "time spent in glLinkProgram"
+);
+static metrics::counter &compile_failures = metrics::add_counter(
+  "qogl_shader_compile_failures_total", "shaders found not to compile"
+);
+static metrics::counter &link_failures = metrics::add_counter(
+  "qogl_program_link_failures_total", "programs found not to link"
+);
 
 GLuint createShader(
   const GLenum shader_type, const std::string &shader_string
 ) {
+  ALLOC_SCOPE(shaders);
   const GLchar *shader_str = shader_string.c_str();
 
   GLuint shader = glCreateShader(shader_type);
   glShaderSource(shader, 1, &shader_str, nullptr);
-  glCompileShader(shader);
+  {
+    // drivers may defer the work to the first status query or draw, so
+    // this is a lower bound
+    metrics::timer timer(compile_time);
+    glCompileShader(shader);
+  }
 
   return shader;
 }
@@ -21,10 +45,14 @@ GLuint createShader(
 GLuint createProgram(
   const GLuint v_shader, const GLuint f_shader, const bool delete_shaders
 ) {
+  ALLOC_SCOPE(shaders);
   GLuint program = glCreateProgram();
   glAttachShader(program, v_shader);
   glAttachShader(program, f_shader);
-  glLinkProgram(program);
+  {
+    metrics::timer timer(link_time);
+    glLinkProgram(program);
+  }
   glDetachShader(program, v_shader);
   glDetachShader(program, f_shader);
 
@@ -43,6 +71,7 @@ std::optional<std::string> getCompileStatus(const GLuint shader) {
   glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 
   if(!success) {
+    compile_failures.add();
     glGetShaderInfoLog(shader, 512, nullptr, infoLog);
     return infoLog;
   }
@@ -56,6 +85,7 @@ std::optional<std::string> getLinkStatus(const GLuint program) {
   glGetProgramiv(program, GL_LINK_STATUS, &success);
 
   if(!success) {
+    link_failures.add();
     glGetProgramInfoLog(program, 512, nullptr, infoLog);
     return infoLog;
   }
@@ -63,6 +93,47 @@ std::optional<std::string> getLinkStatus(const GLuint program) {
   return {};
 }
 
+GLuint createCheckedProgram(
+  const GLuint v_shader, const GLuint f_shader
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+) {
+  // status queries wait for the driver, so only builds that log make them
+  #if defined(DEBUG) || defined(EVENT_LOG)
+  const auto v_compile_error = getCompileStatus(v_shader);
+  if (v_compile_error) {
+    #ifdef DEBUG
+    log_stream << "vertex shader compilation failed\n";
+    log_stream << *v_compile_error << "\n";
+    #endif
+    EVLOG("vertex shader compilation failed: {}", *v_compile_error);
+  }
+  const auto f_compile_error = getCompileStatus(f_shader);
+  if (f_compile_error) {
+    #ifdef DEBUG
+    log_stream << "fragment shader compilation failed\n";
+    log_stream << *f_compile_error << "\n";
+    #endif
+    EVLOG("fragment shader compilation failed: {}", *f_compile_error);
+  }
+  #endif
+
+  const GLuint program = createProgram(v_shader, f_shader, true);
+  #if defined(DEBUG) || defined(EVENT_LOG)
+  const auto link_error = getLinkStatus(program);
+  if (link_error) {
+    #ifdef DEBUG
+    log_stream << "shader program link failed\n";
+    log_stream << *link_error << "\n";
+    #endif
+    EVLOG("shader program link failed: {}", *link_error);
+  }
+  #endif
+
+  return program;
+}
+
 void uniformMatrix4fv(
   const GLuint program, const char *name, const GLfloat *matrix
 ) {
@@ -1,11 +1,14 @@
 #ifndef __SHADER_PROGRAM_HPP__
 #define __SHADER_PROGRAM_HPP__
+#include <fstream>
 #include <optional>
 #include <string>
 
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
+#include "../util/file_io.hpp"
+
 GLuint createShader(const GLenum shader_type, const std::string &shader_string);
 
 GLuint createProgram(
@@ -15,6 +18,15 @@ GLuint createProgram(
 std::optional<std::string> getCompileStatus(const GLuint shader);
 std::optional<std::string> getLinkStatus(const GLuint program);
 
+// createProgram, deleting the shaders, after checking that both compiled.
+// in debug and event log builds any compile or link error is logged
+GLuint createCheckedProgram(
+  const GLuint v_shader, const GLuint f_shader
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+);
+
 void uniformMatrix4fv(
   const GLuint program, const char *name, const GLfloat *matrix
 );
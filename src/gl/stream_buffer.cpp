@@ -0,0 +1,107 @@
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "stream_buffer.hpp"
+#include "../util/counters.hpp"
+
+StreamBuffer createStreamBuffer(
+  const GLenum target, const GLsizeiptr region_size
+) {
+  StreamBuffer sb;
+  sb.target = target;
+  sb.region_size = region_size;
+  // start on the last region so the first beginStreamFrame lands on region 0
+  sb.region = stream_regions - 1;
+  sb.head = region_size;
+
+  glGenBuffers(1, &sb.buffer);
+  glBindBuffer(target, sb.buffer);
+  glBufferData(
+    target, region_size * stream_regions, nullptr, GL_STREAM_DRAW
+  );
+  glBindBuffer(target, 0);
+
+  return sb;
+}
+
+void destroyStreamBuffer(StreamBuffer &sb) {
+  for (auto &fence : sb.fences) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  glDeleteBuffers(1, &sb.buffer);
+  sb.buffer = 0;
+}
+
+void beginStreamFrame(StreamBuffer &sb) {
+  sb.region = (sb.region + 1) % stream_regions;
+  sb.head = 0;
+
+  GLsync &fence = sb.fences[sb.region];
+  if (!fence) { return; }
+
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    ++sb.stalls;
+    do {
+      status = glClientWaitSync(
+        fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 // 1ms
+      );
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void endStreamFrame(StreamBuffer &sb) {
+  GLsync &fence = sb.fences[sb.region];
+  if (fence) { glDeleteSync(fence); }
+
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void *mapStream(
+  StreamBuffer &sb, const GLsizeiptr size, GLintptr &offset,
+  const GLsizeiptr alignment
+) {
+  const GLintptr start = (sb.head + alignment - 1) / alignment * alignment;
+  if (sb.mapped >= 0 || start + size > sb.region_size) {
+    return nullptr;
+  }
+
+  const GLintptr at = sb.region * sb.region_size + start;
+  glBindBuffer(sb.target, sb.buffer);
+  void *p = glMapBufferRange(
+    sb.target, at, size,
+    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+    GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT
+  );
+  // a failed map leaves the buffer as it was, ready for the next try
+  if (p == nullptr) { return nullptr; }
+
+  offset = at;
+  sb.head = start + size;
+  sb.mapped = at;
+
+  return p;
+}
+
+void unmapStream(StreamBuffer &sb, const GLsizeiptr used) {
+  if (sb.mapped < 0) { return; }
+
+  glBindBuffer(sb.target, sb.buffer);
+  if (used > 0) {
+    glFlushMappedBufferRange(sb.target, 0, used);
+  }
+  glUnmapBuffer(sb.target);
+
+  // hand the unused tail of the map back to the region
+  sb.head = sb.mapped - sb.region * sb.region_size + used;
+  sb.bytes_streamed += used;
+  counters::count(counters::engine::bytes_streamed, used);
+  sb.mapped = -1;
+}
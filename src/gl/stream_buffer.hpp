@@ -0,0 +1,55 @@
+#ifndef __STREAM_BUFFER_HPP__
+#define __STREAM_BUFFER_HPP__
+/*
+  streaming buffer ring for per-frame dynamic geometry
+
+  one buffer object is split into `stream_regions` equally sized regions,
+  one per frame in flight. each frame suballocates linearly from its region
+  with unsynchronized, range-invalidating maps, and the region is fenced
+  when the frame ends. the fence is only waited on when the ring wraps back
+  around to that region, which with three regions is almost never.
+
+  the context is gl 3.3 core, so buffers cannot stay mapped while drawing
+  (no ARB_buffer_storage); every suballocation is mapped, written and
+  unmapped before the draw that reads it.
+*/
+#include <cstdint>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+constexpr int stream_regions = 3;
+
+struct StreamBuffer {
+  GLuint buffer = 0;
+  GLenum target = GL_ARRAY_BUFFER;
+  GLsizeiptr region_size = 0;
+  int region = 0;
+  GLintptr head = 0; // offset of the next free byte in the current region
+  GLintptr mapped = -1; // offset of the open map, if any
+  GLsync fences[stream_regions] = {};
+
+  std::uint64_t bytes_streamed = 0;
+  std::uint64_t stalls = 0;
+};
+
+StreamBuffer createStreamBuffer(
+  const GLenum target, const GLsizeiptr region_size
+);
+void destroyStreamBuffer(StreamBuffer &sb);
+
+// advances to the next region, waiting for the gpu if it still uses it
+void beginStreamFrame(StreamBuffer &sb);
+// fences everything submitted from the current region
+void endStreamFrame(StreamBuffer &sb);
+
+// maps `size` bytes for writing; `offset` receives the byte offset to use in
+// draw calls. returns nullptr if the region cannot fit the request
+void *mapStream(
+  StreamBuffer &sb, const GLsizeiptr size, GLintptr &offset,
+  const GLsizeiptr alignment=16
+);
+// flushes the first `used` bytes of the open map and unmaps it
+void unmapStream(StreamBuffer &sb, const GLsizeiptr used);
+
+#endif // __STREAM_BUFFER_HPP__
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+
+#include "quad_batch.hpp"
+#include "text_renderer.hpp"
+#include "texture_units.hpp"
+#include "../util/alloc_track.hpp"
+#include "../util/counters.hpp"
+#include "../util/text.hpp"
+
+TextRenderer createTextRenderer(const GLsizei atlas_size) {
+  GLint max_size = 1024; // the 3.3 minimum
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+
+  TextRenderer t;
+  t.atlas_size = std::clamp<GLsizei>(
+    atlas_size, std::max(text::cell_width, text::cell_height), max_size
+  );
+  t.packer = text::shelf_packer(t.atlas_size, t.atlas_size);
+  t.scratch.resize(text::cell_width * text::cell_height);
+
+  glGenTextures(1, &t.atlas.id);
+  t.atlas.layer = 0;
+  bindTextureForUpload(t.atlas);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // zero is as far outside every glyph as the field goes
+  const std::vector<std::uint8_t> clear(
+    std::size_t(t.atlas_size) * t.atlas_size, 0
+  );
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage3D(
+    GL_TEXTURE_2D_ARRAY, 0, GL_R8, t.atlas_size, t.atlas_size, 1, 0, GL_RED,
+    GL_UNSIGNED_BYTE, clear.data()
+  );
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  // past the outline everywhere, for backgrounds and graph bars. sampling
+  // the middle texel keeps linear filtering off the block's edges
+  constexpr int solid = 4;
+  if (const auto r = t.packer.pack(solid, solid)) {
+    const std::vector<std::uint8_t> full(solid * solid, 255);
+    glTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, r->x, r->y, 0, solid, solid, 1, GL_RED,
+      GL_UNSIGNED_BYTE, full.data()
+    );
+
+    const float u = (r->x + solid * 0.5f) / t.atlas_size;
+    const float v = (r->y + solid * 0.5f) / t.atlas_size;
+    t.solid_uv = glm::vec4(u, v, u, v);
+  }
+
+  return t;
+}
+
+void destroyTextRenderer(TextRenderer &t) {
+  glDeleteTextures(1, &t.atlas.id);
+  forgetTexture(t.atlas.id);
+
+  t = TextRenderer();
+}
+
+static bool makeResident(TextRenderer &t, const int glyph) {
+  if (t.resident[glyph]) { return true; }
+
+  const auto r = t.packer.pack(text::cell_width, text::cell_height);
+  if (!r) { return false; } // 95 cells fit in 512x512, so only if tiny
+
+  text::rasterise(glyph, t.scratch.data());
+
+  bindTextureForUpload(t.atlas);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage3D(
+    GL_TEXTURE_2D_ARRAY, 0, r->x, r->y, 0, r->w, r->h, 1, GL_RED,
+    GL_UNSIGNED_BYTE, t.scratch.data()
+  );
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  const float k = 1.0f / t.atlas_size;
+  t.uvs[glyph] = glm::vec4(r->x, r->y, r->x + r->w, r->y + r->h) * k;
+  t.resident[glyph] = true;
+  ++t.glyph_uploads;
+  counters::count(counters::engine::texture_uploads);
+
+  return true;
+}
+
+float drawText(
+  TextRenderer &t, QuadBatch &b, const std::string_view s,
+  const glm::vec2 &pos, const float size, const std::uint32_t colour,
+  const bool cache
+) {
+  ALLOC_SCOPE(text);
+  if (!cache) { text::layout(s, size, t.scratch_run); }
+  const text::run &run = cache ? t.runs.get(s, size) : t.scratch_run;
+
+  for (const auto &q : run.quads) {
+    if (!makeResident(t, q.glyph)) { continue; }
+
+    const float x0 = pos.x + q.x0;
+    const float y0 = pos.y + q.y0;
+    const float x1 = pos.x + q.x1;
+    const float y1 = pos.y + q.y1;
+    const float corners[8] = {x0, y1, x0, y0, x1, y0, x1, y1};
+    pushQuad(b, t.atlas, corners, t.uvs[q.glyph], colour);
+  }
+
+  t.glyphs_drawn += run.quads.size();
+  return run.width;
+}
+
+void drawSolid(
+  TextRenderer &t, QuadBatch &b, const glm::vec4 &rect,
+  const std::uint32_t colour
+) {
+  const float corners[8] = {
+    rect.x, rect.w, rect.x, rect.y, rect.z, rect.y, rect.z, rect.w
+  };
+  pushQuad(b, t.atlas, corners, t.solid_uv, colour);
+}
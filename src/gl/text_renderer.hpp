@@ -0,0 +1,69 @@
+#ifndef __TEXT_RENDERER_HPP__
+#define __TEXT_RENDERER_HPP__
+/*
+  signed distance field text through a QuadBatch
+
+  glyph distance fields are rasterised the first time a glyph is drawn and
+  shelf-packed into a single-layer r8 texture array, so text shares the
+  quad batch path and a frame's text, whatever its sizes, is one draw.
+  layouts come from a text::run_cache, so a string drawn every frame is
+  laid out once.
+
+  give text its own QuadBatch (createQuadBatch(16384) keeps up to 16k
+  glyphs in one draw) and draw it with the program built from
+  data/shaders/quad/vshader.glsl and data/shaders/text/fshader.glsl, with
+  blending enabled:
+
+    beginQuadBatch(batch);
+    drawText(t, batch, "fps 60", {8, 8}, 16);
+    glUseProgram(text_program);
+    endQuadBatch(batch);
+*/
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+
+#include "quad_batch.hpp"
+#include "texture.hpp"
+#include "../util/text.hpp"
+
+struct TextRenderer {
+  Texture atlas;
+  GLsizei atlas_size = 0;
+  text::shelf_packer packer{0, 0};
+  std::array<glm::vec4, text::glyph_count> uvs; // (u0, v0, u1, v1)
+  std::array<bool, text::glyph_count> resident{};
+  glm::vec4 solid_uv{0}; // inside a block that is all 255
+  text::run_cache runs;
+  text::run scratch_run; // for text laid out without the cache
+  std::vector<std::uint8_t> scratch;
+
+  std::uint64_t glyphs_drawn = 0;
+  std::uint64_t glyph_uploads = 0;
+};
+
+TextRenderer createTextRenderer(const GLsizei atlas_size=512);
+void destroyTextRenderer(TextRenderer &t);
+
+// `pos` is the baseline at the start of the first line and `size` the em
+// height, both in pixels; `colour` is rgba8 with r in the lowest byte.
+// text that changes often (counters, timers) should pass `cache` false so
+// it does not churn the run cache. returns the width of the widest line
+float drawText(
+  TextRenderer &t, QuadBatch &b, const std::string_view s,
+  const glm::vec2 &pos, const float size,
+  const std::uint32_t colour=0xffffffff, const bool cache=true
+);
+// a filled rectangle (x0, y0, x1, y1) in the same draw as the text
+void drawSolid(
+  TextRenderer &t, QuadBatch &b, const glm::vec4 &rect,
+  const std::uint32_t colour
+);
+
+#endif // __TEXT_RENDERER_HPP__
@@ -1,48 +1,279 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
 #include "texture.hpp"
+#include "texture_units.hpp"
+#include "../util/alloc_track.hpp"
+#include "../util/counters.hpp"
+#include "../util/image_cache.hpp"
+#include "../util/image_decode.hpp"
+#include "../util/metrics.hpp"
+
+// not part of the 3.3 core headers, only usable when the extension exists
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB 0x8E8C
 
-Texture loadTexture(const char *texture_path) {
+static metrics::histogram &load_time = metrics::add_histogram(
+  "qogl_texture_load_seconds", "time to read and decode a texture image"
+);
+static metrics::counter &loads = metrics::add_counter(
+  "qogl_texture_loads_total", "texture images read"
+);
+static metrics::counter &load_failures = metrics::add_counter(
+  "qogl_texture_load_failures_total", "texture images that failed to read"
+);
+static metrics::counter &loaded_bytes = metrics::add_counter(
+  "qogl_texture_loaded_bytes_total", "bytes of texture data read"
+);
+
+static bool countLoad(const bool ok, const TextureImage &image) {
+  loads.add();
+  if (ok) {
+    loaded_bytes.add(image.data.size());
+  } else {
+    load_failures.add();
+  }
+
+  return ok;
+}
+
+Texture createTexture() {
   GLuint texture;
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  bindTextureForUpload({texture});
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-  int width;
-  int height;
-  int channels;
-  GLenum fmt;
+  return {texture};
+}
+
+void deleteTexture(Texture &t) {
+  glDeleteTextures(1, &t.id);
+  forgetTexture(t.id);
+  t.id = 0;
+}
+
+Texture loadTexture(const char *texture_path, imgcache::cache *cache) {
+  ALLOC_SCOPE(textures);
+  const Texture t = createTexture();
+
+  // decode scratch is kept between loads to avoid reallocating it
+  static TextureImage image;
+  if (!readTextureImage(texture_path, image, cache)) {
+    image.width = image.height = 0;
+    image.internal_format = GL_RGB8;
+    image.format = GL_RGB;
+  }
+  uploadTextureImage(t, image);
+
+  return t;
+}
 
-  stbi_set_flip_vertically_on_load(true);
-  unsigned char *data = stbi_load(texture_path, &width, &height, &channels, 0);
+static void setImageFormat(TextureImage &out, const imgdec::info &image) {
+  out.width = image.width;
+  out.height = image.height;
 
-  switch (channels) {
-    case 1: fmt = GL_RED; break;
-    case 4: fmt = GL_RGBA; break;
-    default: fmt = GL_RGB;
+  // size vram to the source instead of always expanding to rgba
+  switch (image.channels) {
+    case 1: out.format = GL_RED; out.internal_format = GL_R8; break;
+    case 2: out.format = GL_RG; out.internal_format = GL_RG8; break;
+    case 4: out.format = GL_RGBA; out.internal_format = GL_RGBA8; break;
+    default: out.format = GL_RGB; out.internal_format = GL_RGB8;
   }
+}
+
+bool readTextureImage(
+  const char *texture_path, TextureImage &out, imgcache::cache *cache
+) {
+  ALLOC_SCOPE(textures);
+  static std::vector<std::uint8_t> file;
+  metrics::timer timer(load_time);
+
+  const auto image = cache
+    ? imgcache::decode(*cache, texture_path, {}, file, out.data)
+    : imgdec::decode(texture_path, {}, file, out.data);
+  if (!image) { return countLoad(false, out); }
+
+  setImageFormat(out, *image);
+  return countLoad(true, out);
+}
+
+bool decodeTextureImage(
+  const std::uint8_t *data, const std::size_t size, TextureImage &out
+) {
+  ALLOC_SCOPE(textures);
+  metrics::timer timer(load_time);
+
+  const auto image = imgdec::decode(data, size, {}, out.data);
+  if (!image) { return countLoad(false, out); }
+
+  setImageFormat(out, *image);
+  return countLoad(true, out);
+}
+
+texc::caps queryCompressionCaps() {
+  static std::optional<texc::caps> caps;
+  if (caps) { return *caps; }
+
+  caps = texc::caps();
+  caps->bptc = GLVersion.major > 4 ||
+    (GLVersion.major == 4 && GLVersion.minor >= 2);
+
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; ++i) {
+    const char *ext = reinterpret_cast<const char *>(
+      glGetStringi(GL_EXTENSIONS, i)
+    );
+
+    if (std::strcmp(ext, "GL_EXT_texture_compression_s3tc") == 0) {
+      caps->s3tc = true;
+    } else if (std::strcmp(ext, "GL_ARB_texture_compression_bptc") == 0) {
+      caps->bptc = true;
+    }
+  }
+
+  return *caps;
+}
 
+static GLenum compressedFormat(const texc::format_t f) {
+  switch (f) {
+    case texc::format_t::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case texc::format_t::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case texc::format_t::bc4: return GL_COMPRESSED_RED_RGTC1;
+    case texc::format_t::bc5: return GL_COMPRESSED_RG_RGTC2;
+    case texc::format_t::bc7: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+    default: return 0;
+  }
+}
+
+static bool isSupported(const texc::format_t f, const texc::caps &caps) {
+  switch (f) {
+    case texc::format_t::bc1: case texc::format_t::bc3: return caps.s3tc;
+    case texc::format_t::bc7: return caps.bptc;
+    default: return true;
+  }
+}
+
+Texture loadCompressedTexture(const char *texture_path) {
+  ALLOC_SCOPE(textures);
+  TextureImage image;
+  if (!readCompressedTextureImage(texture_path, image)) { return {}; }
+
+  const Texture t = createTexture();
+  uploadTextureImage(t, image);
+
+  return t;
+}
+
+bool readCompressedTextureImage(const char *texture_path, TextureImage &out) {
+  ALLOC_SCOPE(textures);
+  metrics::timer timer(load_time);
+
+  auto image = texc::read(texture_path);
+  if (!image) { return countLoad(false, out); }
+
+  return convertCompressedImage(*image, queryCompressionCaps(), out);
+}
+
+bool convertCompressedImage(
+  texc::compressed_image &image, const texc::caps &caps, TextureImage &out
+) {
+  out.width = image.width;
+  out.height = image.height;
+  out.mipmaps = false;
+
+  if (!texc::is_block_format(image.format)) {
+    constexpr GLenum fmts[4] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    constexpr GLenum internal_fmts[4] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    const int n = texc::format_channels(image.format) - 1;
+
+    out.format = fmts[n];
+    out.internal_format = internal_fmts[n];
+    out.data = std::move(image.data);
+  } else if (isSupported(image.format, caps)) {
+    out.format = 0;
+    out.internal_format = compressedFormat(image.format);
+    out.data = std::move(image.data);
+  } else if (auto pixels = texc::decode(image)) {
+    // the driver lacks the extension, fall back to uncompressed rgba
+    out.format = GL_RGBA;
+    out.internal_format = GL_RGBA8;
+    out.data = std::move(pixels->pixels);
+  } else {
+    return countLoad(false, out);
+  }
+
+  return countLoad(true, out);
+}
+
+void uploadTextureImage(const Texture &t, const TextureImage &image) {
+  ALLOC_SCOPE(textures);
+  bindTextureForUpload(t);
+  counters::count(counters::engine::texture_uploads);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  if (image.format == 0) {
+    glCompressedTexImage2D(
+      GL_TEXTURE_2D, 0, image.internal_format, image.width, image.height, 0,
+      image.data.size(), image.data.data()
+    );
+  } else {
+    glTexImage2D(
+      GL_TEXTURE_2D, 0, image.internal_format, image.width, image.height, 0,
+      image.format, GL_UNSIGNED_BYTE,
+      image.data.empty() ? nullptr : image.data.data()
+    );
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (image.mipmaps && image.format != 0) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(
+      GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR
+    );
+  }
+}
+
+void releaseTextureStorage(const Texture &t) {
+  bindTextureForUpload(t);
+  // respecifying level 0 as empty drops the old storage and any mip chain
   glTexImage2D(
-    GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, fmt, GL_UNSIGNED_BYTE, data
+    GL_TEXTURE_2D, 0, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr
   );
-  stbi_image_free(data);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+}
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+std::size_t textureBytes(const TextureImage &image) {
+  if (image.format == 0) { return image.data.size(); }
 
-  return {texture};
-}
+  std::size_t texel;
+  switch (image.internal_format) {
+    case GL_R8: texel = 1; break;
+    case GL_RG8: texel = 2; break;
+    default: texel = 4; // drivers pad rgb8 out to four bytes
+  }
 
-void bindTexture(const Texture &t) {
-  if (current_texture != t.id) {
-    glBindTexture(GL_TEXTURE_2D, t.id);
-    current_texture = t.id;
+  std::size_t bytes = 0;
+  int w = image.width;
+  int h = image.height;
+  for (;;) {
+    bytes += std::size_t(w) * h * texel;
+    if (!image.mipmaps || (w <= 1 && h <= 1)) { break; }
+    w = std::max(w / 2, 1);
+    h = std::max(h / 2, 1);
   }
+
+  return bytes;
 }
@@ -1,15 +1,64 @@
 #ifndef __TEXTURE_HPP__
 #define __TEXTURE_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
-static GLuint current_texture = 0;
+#include "../util/image_cache.hpp"
+#include "../util/texture_codec.hpp"
 
+// a GL_TEXTURE_2D, or one layer of a GL_TEXTURE_2D_ARRAY when `layer` is set
 struct Texture {
   GLuint id = 0;
+  GLint layer = -1;
+};
+
+// a decoded image in the form it is handed to the driver
+struct TextureImage {
+  int width = 0;
+  int height = 0;
+  GLenum internal_format = GL_RGBA8;
+  GLenum format = GL_RGBA; // 0 for block compressed data
+  bool mipmaps = false; // generate a full chain after upload
+  std::vector<std::uint8_t> data;
 };
 
-Texture loadTexture(const char *path);
-void bindTexture(const Texture &t);
+// empty texture with the default sampling parameters, left bound
+Texture createTexture();
+void deleteTexture(Texture &t);
+// decoded pixels come from `cache` when given, see util/image_cache.hpp
+Texture loadTexture(const char *path, imgcache::cache *cache=nullptr);
+// uploads a `.qtex` written by texcompress, decoding it on the cpu if the
+// driver does not support its block format
+Texture loadCompressedTexture(const char *path);
+texc::caps queryCompressionCaps();
+
+// `out` keeps its capacity between calls. returns false if the file could
+// not be read
+bool readTextureImage(
+  const char *path, TextureImage &out, imgcache::cache *cache=nullptr
+);
+bool readCompressedTextureImage(const char *path, TextureImage &out);
+// the cpu side of the two above, for encoded bytes already in memory. no
+// gl calls and no shared state, so safe on any thread
+bool decodeTextureImage(
+  const std::uint8_t *data, const std::size_t size, TextureImage &out
+);
+// `caps` must come from queryCompressionCaps on the gl thread. unsupported
+// block formats are decoded to rgba. the data of `image` may be moved out
+bool convertCompressedImage(
+  texc::compressed_image &image, const texc::caps &caps, TextureImage &out
+);
+// (re)specifies the storage of `t` from `image` and leaves it bound to the
+// active unit
+void uploadTextureImage(const Texture &t, const TextureImage &image);
+// frees the storage of `t` but keeps the name valid, so anything holding
+// the id can still bind it once it is uploaded again
+void releaseTextureStorage(const Texture &t);
+// estimated vram use, including the mip chain
+std::size_t textureBytes(const TextureImage &image);
 
 #endif // __TEXTURE_HPP__
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstddef>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "texture_array.hpp"
+#include "texture_units.hpp"
+#include "../util/counters.hpp"
+
+TextureArrays createTextureArrays(const GLsizei layers_per_array) {
+  GLint max_layers = 256; // the 3.3 minimum
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+
+  TextureArrays a;
+  a.layers_per_array = std::clamp<GLsizei>(layers_per_array, 1, max_layers);
+
+  return a;
+}
+
+void destroyTextureArrays(TextureArrays &a) {
+  for (auto &array : a.arrays) {
+    glDeleteTextures(1, &array.id);
+    forgetTexture(array.id);
+  }
+
+  a.arrays.clear();
+}
+
+static std::size_t layerBytes(const TextureImage &image) {
+  // block formats upload exactly what was read, so its size is one layer
+  return image.data.size();
+}
+
+static TextureArray createArray(
+  const TextureImage &image, const GLsizei capacity
+) {
+  TextureArray array;
+  array.width = image.width;
+  array.height = image.height;
+  array.internal_format = image.internal_format;
+  array.capacity = capacity;
+
+  glGenTextures(1, &array.id);
+  bindTextureForUpload({array.id, 0});
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  if (image.format == 0) {
+    glCompressedTexImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, image.internal_format, image.width,
+      image.height, capacity, 0, layerBytes(image) * capacity, nullptr
+    );
+  } else {
+    glTexImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, image.internal_format, image.width,
+      image.height, capacity, 0, image.format, GL_UNSIGNED_BYTE, nullptr
+    );
+  }
+
+  return array;
+}
+
+Texture addTextureLayer(TextureArrays &a, const TextureImage &image) {
+  if (image.data.empty()) { return {}; }
+
+  TextureArray *array = nullptr;
+  GLint layer = -1;
+  for (auto &candidate : a.arrays) {
+    if (candidate.width != image.width || candidate.height != image.height ||
+      candidate.internal_format != image.internal_format) {
+      continue;
+    }
+
+    if (!candidate.free_layers.empty()) {
+      array = &candidate;
+      layer = candidate.free_layers.back();
+      candidate.free_layers.pop_back();
+      break;
+    }
+    if (candidate.used < candidate.capacity) {
+      array = &candidate;
+      layer = candidate.used++;
+      break;
+    }
+  }
+
+  if (array == nullptr) {
+    a.arrays.push_back(createArray(image, a.layers_per_array));
+    array = &a.arrays.back();
+    layer = array->used++;
+  }
+
+  bindTextureForUpload({array->id, 0});
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  if (image.format == 0) {
+    glCompressedTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, image.width, image.height, 1,
+      image.internal_format, layerBytes(image), image.data.data()
+    );
+  } else {
+    glTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, image.width, image.height, 1,
+      image.format, GL_UNSIGNED_BYTE, image.data.data()
+    );
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  ++a.uploads;
+  counters::count(counters::engine::texture_uploads);
+
+  return {array->id, layer};
+}
+
+Texture loadArrayTexture(
+  TextureArrays &a, const char *path, imgcache::cache *cache
+) {
+  static TextureImage image;
+  if (!readTextureImage(path, image, cache)) { return {}; }
+
+  return addTextureLayer(a, image);
+}
+
+void removeTextureLayer(TextureArrays &a, const Texture &t) {
+  for (auto &array : a.arrays) {
+    if (array.id == t.id && t.layer >= 0 && t.layer < array.used) {
+      array.free_layers.push_back(t.layer);
+      return;
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef __TEXTURE_ARRAY_HPP__
+#define __TEXTURE_ARRAY_HPP__
+/*
+  many small textures packed into GL_TEXTURE_2D_ARRAY layers
+
+  images are grouped by size and internal format; each group fills fixed
+  capacity arrays (gl 3.3 has no glCopyImageSubData, so an array cannot
+  grow in place) and starts a new one when the last is full. the returned
+  `Texture` is (array, layer), so everything in one array can be drawn with
+  a single bind by passing the layer per vertex, see quad_batch.hpp.
+*/
+#include <cstdint>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "../util/image_cache.hpp"
+
+struct TextureArray {
+  GLuint id = 0;
+  int width = 0;
+  int height = 0;
+  GLenum internal_format = GL_RGBA8;
+  GLsizei capacity = 0;
+  GLsizei used = 0; // layers handed out, including freed ones
+  std::vector<GLint> free_layers;
+};
+
+struct TextureArrays {
+  GLsizei layers_per_array = 64;
+  std::vector<TextureArray> arrays;
+
+  std::uint64_t uploads = 0;
+};
+
+// `layers_per_array` is clamped to GL_MAX_ARRAY_TEXTURE_LAYERS
+TextureArrays createTextureArrays(const GLsizei layers_per_array=64);
+void destroyTextureArrays(TextureArrays &a);
+
+// returns a zero id if the image has no pixels
+Texture addTextureLayer(TextureArrays &a, const TextureImage &image);
+Texture loadArrayTexture(
+  TextureArrays &a, const char *path, imgcache::cache *cache=nullptr
+);
+// the layer is reused by a later add of the same size and format
+void removeTextureLayer(TextureArrays &a, const Texture &t);
+
+#endif // __TEXTURE_ARRAY_HPP__
@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "texture_residency.hpp"
+#include "texture_units.hpp"
+#include "../util/counters.hpp"
+
+static const counters::id texture_bytes = counters::add(
+  "memory.textures", counters::kind_t::gauge, counters::unit_t::bytes
+);
+
+TextureResidency createTextureResidency(
+  const std::size_t budget, const std::size_t cache_budget
+) {
+  TextureResidency r;
+  r.budget = budget;
+  r.cache_budget = cache_budget;
+
+  return r;
+}
+
+void destroyTextureResidency(TextureResidency &r) {
+  for (auto &[id, e] : r.textures) {
+    Texture t = {id};
+    deleteTexture(t);
+  }
+
+  r.textures.clear();
+  r.recency.clear();
+  r.cache.clear();
+  r.resident_bytes = 0;
+  counters::set(texture_bytes, 0);
+  r.cached_bytes = 0;
+}
+
+static void dropImage(TextureResidency &r, TextureResidency::entry &e) {
+  r.cached_bytes -= e.image->data.size();
+  r.cache.erase(e.cached);
+  e.image.reset();
+}
+
+static void trimCache(TextureResidency &r) {
+  while (r.cached_bytes > r.cache_budget && !r.cache.empty()) {
+    dropImage(r, r.textures[r.cache.back()]);
+  }
+}
+
+static void evict(TextureResidency &r, const GLuint id) {
+  auto &e = r.textures[id];
+
+  releaseTextureStorage({id});
+  r.recency.erase(e.lru);
+  r.resident_bytes -= e.bytes;
+  counters::set(texture_bytes, r.resident_bytes);
+  e.resident = false;
+  ++r.evictions;
+
+  // a kept image is now worth more than any resident texture's
+  if (e.image) {
+    r.cache.splice(r.cache.begin(), r.cache, e.cached);
+  }
+}
+
+// frees room for `bytes` more, never touching `keep`
+static bool evictFor(
+  TextureResidency &r, const std::size_t bytes, const GLuint keep
+) {
+  while (r.resident_bytes + bytes > r.budget && !r.recency.empty()) {
+    const GLuint victim = r.recency.back();
+    if (victim == keep) { break; }
+
+    evict(r, victim);
+  }
+
+  return r.resident_bytes + bytes <= r.budget;
+}
+
+// `image`, when given, is the texture's image already decoded
+static bool makeResident(
+  TextureResidency &r, const GLuint id,
+  std::unique_ptr<TextureImage> image=nullptr
+) {
+  auto &e = r.textures[id];
+
+  if (image) {
+    // decoded by the caller
+  } else if (e.image) {
+    ++r.cache_hits;
+    image = std::move(e.image);
+    r.cached_bytes -= image->data.size();
+    r.cache.erase(e.cached);
+  } else {
+    image = std::make_unique<TextureImage>();
+    const bool read = e.compressed
+      ? readCompressedTextureImage(e.path.c_str(), *image)
+      : readTextureImage(e.path.c_str(), *image, r.disk_cache);
+    if (!read) { return false; }
+  }
+  image->mipmaps = e.mipmaps;
+
+  e.bytes = textureBytes(*image);
+  if (!evictFor(r, e.bytes, id)) { ++r.over_budget; }
+
+  uploadTextureImage({id}, *image);
+  e.resident = true;
+  r.resident_bytes += e.bytes;
+  counters::set(texture_bytes, r.resident_bytes);
+  r.recency.push_front(id);
+  e.lru = r.recency.begin();
+
+  // resident textures do not need their image, so it goes to the back of
+  // the cache and is the first thing dropped
+  if (image->data.size() <= r.cache_budget) {
+    r.cached_bytes += image->data.size();
+    r.cache.push_back(id);
+    e.cached = std::prev(r.cache.end());
+    e.image = std::move(image);
+    trimCache(r);
+  }
+
+  return true;
+}
+
+Texture loadManagedTexture(
+  TextureResidency &r, const char *path, const bool compressed,
+  const bool mipmaps
+) {
+  Texture t = createTexture();
+
+  auto &e = r.textures[t.id];
+  e.path = path;
+  e.compressed = compressed;
+  e.mipmaps = mipmaps;
+
+  if (!makeResident(r, t.id)) {
+    r.textures.erase(t.id);
+    deleteTexture(t);
+  }
+
+  return t;
+}
+
+Texture adoptManagedTexture(
+  TextureResidency &r, const char *path, std::unique_ptr<TextureImage> image,
+  const bool compressed
+) {
+  Texture t = createTexture();
+
+  auto &e = r.textures[t.id];
+  e.path = path;
+  e.compressed = compressed;
+  e.mipmaps = image->mipmaps;
+
+  if (!makeResident(r, t.id, std::move(image))) {
+    r.textures.erase(t.id);
+    deleteTexture(t);
+  }
+
+  return t;
+}
+
+void deleteManagedTexture(TextureResidency &r, Texture &t) {
+  auto it = r.textures.find(t.id);
+  if (it == r.textures.end()) { return; }
+
+  auto &e = it->second;
+  if (e.resident) {
+    r.recency.erase(e.lru);
+    r.resident_bytes -= e.bytes;
+    counters::set(texture_bytes, r.resident_bytes);
+  }
+  if (e.image) { dropImage(r, e); }
+
+  r.textures.erase(it);
+  deleteTexture(t);
+}
+
+void setTextureBudget(TextureResidency &r, const std::size_t budget) {
+  r.budget = budget;
+  evictFor(r, 0, 0);
+}
+
+void bindTexture(TextureResidency &r, const Texture &t, const GLuint unit) {
+  auto it = r.textures.find(t.id);
+  if (it != r.textures.end()) {
+    auto &e = it->second;
+    if (e.resident) {
+      r.recency.splice(r.recency.begin(), r.recency, e.lru);
+    } else if (makeResident(r, t.id)) {
+      ++r.reloads;
+    }
+  }
+
+  bindTexture(t, unit);
+}
+
+bool isResident(const TextureResidency &r, const Texture &t) {
+  auto it = r.textures.find(t.id);
+
+  return it != r.textures.end() && it->second.resident;
+}
@@ -0,0 +1,87 @@
+#ifndef __TEXTURE_RESIDENCY_HPP__
+#define __TEXTURE_RESIDENCY_HPP__
+/*
+  texture residency under a vram budget
+
+  every texture loaded through the manager has its size estimated (mips
+  included) and is kept on a recency list that `bindTexture` refreshes. when
+  a load or reload would exceed the budget, the least recently bound
+  textures lose their storage until it fits. the gl name survives eviction,
+  so ids held elsewhere (scene renderables) stay valid; binding an evicted
+  texture uploads it again, from the decoded image cache when it is still
+  there and from disk otherwise.
+
+  the decoded image cache is a second, cpu side budget of images kept after
+  upload. evicted textures move to its front since they are the ones most
+  likely to be asked for again.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "texture_units.hpp"
+#include "../util/image_cache.hpp"
+
+struct TextureResidency {
+  struct entry {
+    std::string path;
+    bool compressed = false;
+    bool mipmaps = false;
+    bool resident = false;
+    std::size_t bytes = 0;
+    std::list<GLuint>::iterator lru; // into `recency`
+    std::list<GLuint>::iterator cached; // into `cache`, if the image is kept
+    std::unique_ptr<TextureImage> image;
+  };
+
+  imgcache::cache *disk_cache = nullptr; // for decoding from disk, optional
+
+  std::size_t budget = 0; // vram bytes
+  std::size_t cache_budget = 0; // cpu bytes of decoded images
+  std::size_t resident_bytes = 0;
+  std::size_t cached_bytes = 0;
+
+  std::unordered_map<GLuint, entry> textures;
+  std::list<GLuint> recency; // resident textures, most recently bound first
+  std::list<GLuint> cache; // textures with a kept image, most useful first
+
+  std::uint64_t evictions = 0;
+  std::uint64_t reloads = 0;
+  std::uint64_t cache_hits = 0;
+  std::uint64_t over_budget = 0; // loads that could not evict enough
+};
+
+TextureResidency createTextureResidency(
+  const std::size_t budget, const std::size_t cache_budget
+);
+// deletes every texture the manager owns
+void destroyTextureResidency(TextureResidency &r);
+
+// `compressed` selects a `.qtex` file. returns a zero id on failure
+Texture loadManagedTexture(
+  TextureResidency &r, const char *path, const bool compressed=false,
+  const bool mipmaps=false
+);
+// for images decoded elsewhere (off the gl thread): uploads `image` and
+// manages it as if it had been loaded from `path`, which reloads use
+Texture adoptManagedTexture(
+  TextureResidency &r, const char *path, std::unique_ptr<TextureImage> image,
+  const bool compressed=false
+);
+void deleteManagedTexture(TextureResidency &r, Texture &t);
+
+// evicts down to the new budget straight away
+void setTextureBudget(TextureResidency &r, const std::size_t budget);
+// marks `t` as most recently used, uploading it again if it was evicted.
+// textures the manager does not own are bound as usual
+void bindTexture(TextureResidency &r, const Texture &t, const GLuint unit=0);
+bool isResident(const TextureResidency &r, const Texture &t);
+
+#endif // __TEXTURE_RESIDENCY_HPP__
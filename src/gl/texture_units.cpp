@@ -0,0 +1,134 @@
+#include <cstddef>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "texture_units.hpp"
+#include "../util/counters.hpp"
+
+TextureUnits &textureUnits() {
+  static TextureUnits tu;
+
+  if (tu.units.empty()) {
+    GLint count = 48; // the 3.3 minimum
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &count);
+    tu.units.resize(count);
+  }
+
+  return tu;
+}
+
+static void bindOnActive(TextureUnits &tu, const Texture &t) {
+  TextureUnit &u = tu.units[tu.active];
+  GLuint &bound = t.layer >= 0 ? u.texture_array : u.texture;
+
+  if (bound == t.id) {
+    ++tu.elided;
+    return;
+  }
+
+  glBindTexture(t.layer >= 0 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, t.id);
+  bound = t.id;
+  ++tu.binds;
+  counters::count(counters::engine::state_changes);
+}
+
+static bool isBound(
+  const TextureUnits &tu, const Texture &t, const GLuint unit
+) {
+  const TextureUnit &u = tu.units[unit];
+
+  return (t.layer >= 0 ? u.texture_array : u.texture) == t.id;
+}
+
+void bindTexture(const Texture &t, const GLuint unit) {
+  TextureUnits &tu = textureUnits();
+
+  // skip the unit switch too when there is nothing to bind
+  if (isBound(tu, t, unit)) {
+    ++tu.elided;
+    return;
+  }
+
+  if (tu.active != unit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    tu.active = unit;
+    ++tu.unit_switches;
+    counters::count(counters::engine::state_changes);
+  }
+  bindOnActive(tu, t);
+}
+
+void bindTextureForUpload(const Texture &t) {
+  bindOnActive(textureUnits(), t);
+}
+
+void bindSampler(const GLuint unit, const GLuint sampler) {
+  TextureUnits &tu = textureUnits();
+  GLuint &bound = tu.units[unit].sampler;
+
+  if (bound == sampler) {
+    ++tu.elided;
+    return;
+  }
+
+  // samplers are bound by unit index, no glActiveTexture needed
+  glBindSampler(unit, sampler);
+  bound = sampler;
+  ++tu.sampler_binds;
+  counters::count(counters::engine::state_changes);
+}
+
+void bindTextures(const TextureBinding *bindings, const std::size_t count) {
+  TextureUnits &tu = textureUnits();
+
+  // whatever targets the active unit goes first, saving a switch back
+  const GLuint start = tu.active;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (bindings[i].unit == start) { bindOnActive(tu, bindings[i].texture); }
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const TextureBinding &b = bindings[i];
+    if (b.unit != start) { bindTexture(b.texture, b.unit); }
+    bindSampler(b.unit, b.sampler);
+  }
+}
+
+void forgetTexture(const GLuint id) {
+  TextureUnits &tu = textureUnits();
+
+  for (auto &u : tu.units) {
+    if (u.texture == id) { u.texture = 0; }
+    if (u.texture_array == id) { u.texture_array = 0; }
+  }
+}
+
+GLuint getSampler(const SamplerDesc &desc) {
+  TextureUnits &tu = textureUnits();
+
+  for (const auto &[d, sampler] : tu.samplers) {
+    if (d == desc) { return sampler; }
+  }
+
+  GLuint sampler;
+  glGenSamplers(1, &sampler);
+  glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, desc.min_filter);
+  glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.mag_filter);
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, desc.wrap_s);
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, desc.wrap_t);
+  tu.samplers.emplace_back(desc, sampler);
+
+  return sampler;
+}
+
+void destroySamplers() {
+  TextureUnits &tu = textureUnits();
+
+  for (auto &[d, sampler] : tu.samplers) {
+    glDeleteSamplers(1, &sampler);
+  }
+  for (auto &u : tu.units) { u.sampler = 0; }
+  tu.samplers.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef __TEXTURE_UNITS_HPP__
+#define __TEXTURE_UNITS_HPP__
+/*
+  texture unit binding cache and shared sampler objects
+
+  the texture bound to each target of every unit, and the sampler bound to
+  every unit, is mirrored on the cpu so redundant binds never reach the
+  driver, and glActiveTexture is only called when a bind actually needs a
+  different unit. sampling state lives in sampler objects shared by every
+  texture with the same filtering and wrap modes; the parameters set on the
+  texture objects themselves only apply while unit's sampler is 0.
+
+  gl 3.3 has no ARB_multi_bind, so `bindTextures` is a loop over the units
+  with the redundant binds dropped.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+
+struct SamplerDesc {
+  GLenum min_filter = GL_LINEAR;
+  GLenum mag_filter = GL_LINEAR;
+  GLenum wrap_s = GL_REPEAT;
+  GLenum wrap_t = GL_REPEAT;
+};
+
+inline bool operator==(const SamplerDesc &a, const SamplerDesc &b) {
+  return a.min_filter == b.min_filter && a.mag_filter == b.mag_filter &&
+    a.wrap_s == b.wrap_s && a.wrap_t == b.wrap_t;
+}
+
+struct TextureUnit {
+  GLuint texture = 0; // GL_TEXTURE_2D
+  GLuint texture_array = 0; // GL_TEXTURE_2D_ARRAY
+  GLuint sampler = 0;
+};
+
+struct TextureBinding {
+  GLuint unit = 0;
+  Texture texture;
+  GLuint sampler = 0; // from getSampler, 0 uses the texture's parameters
+};
+
+struct TextureUnits {
+  std::vector<TextureUnit> units;
+  GLuint active = 0;
+  std::vector<std::pair<SamplerDesc, GLuint>> samplers;
+
+  std::uint64_t binds = 0;
+  std::uint64_t elided = 0; // binds that matched the cached state
+  std::uint64_t unit_switches = 0;
+  std::uint64_t sampler_binds = 0;
+};
+
+// the cache for the current context, sized from
+// GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS on first use
+TextureUnits &textureUnits();
+
+void bindTexture(const Texture &t, const GLuint unit=0);
+// binds on whichever unit is active, for uploads that do not care which
+void bindTextureForUpload(const Texture &t);
+void bindSampler(const GLuint unit, const GLuint sampler);
+void bindTextures(const TextureBinding *bindings, const std::size_t count);
+// must be called when a texture is deleted, gl unbinds it from every unit
+void forgetTexture(const GLuint id);
+
+// one sampler object per distinct description, created on first request
+GLuint getSampler(const SamplerDesc &desc);
+void destroySamplers();
+
+#endif // __TEXTURE_UNITS_HPP__
@@ -0,0 +1,147 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "rect.hpp"
+#include "texture_units.hpp"
+#include "tilemap_renderer.hpp"
+#include "vertex_layout.hpp"
+#include "../util/counters.hpp"
+
+// sweeping a slice per frame keeps idle checks off the per-chunk path
+constexpr std::size_t sweep_per_frame = 256;
+
+const TileCorner corner_data[4] = {
+  {{0.0, 0.0}}, {{1.0, 0.0}}, {{0.0, 1.0}}, {{1.0, 1.0}}
+};
+
+TilemapRenderer createTilemapRenderer(
+  const tilemap::map &m, const GLuint program, const Texture &tileset
+) {
+  TilemapRenderer r;
+  r.program = program;
+  r.chunk_origin = glGetUniformLocation(program, "chunk_origin");
+  r.tile_size = glGetUniformLocation(program, "tile_size");
+  r.tileset = tileset;
+  r.chunks_x = m.chunks_x();
+  r.chunks.resize(std::size_t(m.chunks_x()) * m.chunks_y());
+  r.scratch.resize(tilemap::chunk_tiles);
+
+  glGenBuffers(1, &r.corners);
+  glBindBuffer(GL_ARRAY_BUFFER, r.corners);
+  glBufferData(
+    GL_ARRAY_BUFFER, sizeof(corner_data), corner_data, GL_STATIC_DRAW
+  );
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  return r;
+}
+
+static void releaseChunk(TilemapRenderer &r, TilemapRenderer::gpu_chunk &c) {
+  if (current_vao == c.vao) {
+    glBindVertexArray(0);
+    current_vao = 0;
+  }
+
+  glDeleteVertexArrays(1, &c.vao);
+  glDeleteBuffers(1, &c.instances);
+  c = TilemapRenderer::gpu_chunk();
+  --r.resident;
+}
+
+void destroyTilemapRenderer(TilemapRenderer &r) {
+  for (auto &c : r.chunks) {
+    if (c.vao != 0) { releaseChunk(r, c); }
+  }
+
+  glDeleteBuffers(1, &r.corners);
+  r.corners = 0;
+}
+
+static void createChunk(TilemapRenderer &r, TilemapRenderer::gpu_chunk &c) {
+  glGenVertexArrays(1, &c.vao);
+  glGenBuffers(1, &c.instances);
+
+  glBindVertexArray(c.vao);
+  current_vao = c.vao;
+
+  glBindBuffer(GL_ARRAY_BUFFER, r.corners);
+  setupVertexAttribs<TileCorner>();
+
+  glBindBuffer(GL_ARRAY_BUFFER, c.instances);
+  glBufferData(
+    GL_ARRAY_BUFFER, tilemap::chunk_tiles * sizeof(TileInstance), nullptr,
+    GL_DYNAMIC_DRAW
+  );
+  setupVertexAttribs<TileInstance>(0, 1);
+
+  ++r.resident;
+}
+
+static void uploadChunk(
+  TilemapRenderer &r, TilemapRenderer::gpu_chunk &c, const tilemap::chunk &t
+) {
+  static_assert(sizeof(TileInstance) == sizeof(float));
+  tilemap::build_instances(t, r.scratch.data());
+
+  // respecifying the whole store lets the driver orphan it instead of
+  // waiting on a draw from last frame that still reads it
+  const GLsizeiptr bytes = tilemap::chunk_tiles * sizeof(TileInstance);
+  glBindBuffer(GL_ARRAY_BUFFER, c.instances);
+  glBufferData(GL_ARRAY_BUFFER, bytes, r.scratch.data(), GL_DYNAMIC_DRAW);
+
+  c.version = t.version;
+  ++r.uploads;
+  r.bytes_uploaded += bytes;
+  counters::count(counters::engine::bytes_streamed, bytes);
+}
+
+void drawTilemap(
+  TilemapRenderer &r, const tilemap::map &m, const spatial::aabb &view
+) {
+  ++r.frame;
+  r.visible = 0;
+  r.draws = 0;
+  r.uploads = 0;
+
+  glUseProgram(r.program);
+  counters::count(counters::engine::state_changes);
+  glUniform1f(r.tile_size, m.tile_size());
+  bindTexture(r.tileset, 0);
+
+  const tilemap::chunk_range range = m.visible(view);
+  for (int y = range.y0; y < range.y1; ++y) {
+    for (int x = range.x0; x < range.x1; ++x) {
+      const tilemap::chunk &tiles = m.chunk_at(x, y);
+      ++r.visible;
+      if (tiles.filled == 0) { continue; }
+
+      auto &c = r.chunks[std::size_t(y) * r.chunks_x + x];
+      if (c.vao == 0) { createChunk(r, c); }
+      if (c.version != tiles.version) { uploadChunk(r, c, tiles); }
+      c.last_drawn = r.frame;
+
+      if (current_vao != c.vao) {
+        glBindVertexArray(c.vao);
+        current_vao = c.vao;
+        counters::count(counters::engine::state_changes);
+      }
+
+      const spatial::aabb b = m.chunk_bounds(x, y);
+      glUniform2f(r.chunk_origin, b.x0, b.y0);
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, tilemap::chunk_tiles);
+      ++r.draws;
+      counters::count(counters::engine::draw_calls);
+    }
+  }
+
+  for (std::size_t i = 0; i < sweep_per_frame && !r.chunks.empty(); ++i) {
+    r.sweep = (r.sweep + 1) % r.chunks.size();
+    auto &c = r.chunks[r.sweep];
+    if (c.vao != 0 && r.frame - c.last_drawn > r.idle_frames) {
+      releaseChunk(r, c);
+    }
+  }
+}
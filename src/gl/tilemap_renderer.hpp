@@ -0,0 +1,87 @@
+#ifndef __TILEMAP_RENDERER_HPP__
+#define __TILEMAP_RENDERER_HPP__
+/*
+  instanced drawing of tilemap::map chunks
+
+  each chunk is one instanced draw of a shared unit quad: the instance
+  buffer holds a float array layer per tile and the vertex shader places
+  instance i at (i % chunk_size, i / chunk_size), so a 32x32 chunk is 4KiB
+  of vram. gpu chunks are created the first time they are visible,
+  re-uploaded only when the map's chunk version moved on, and freed after
+  `idle_frames` frames off screen.
+
+  draw with the program built from data/shaders/tilemap and a tileset
+  texture array holding one tile per layer.
+*/
+#include <cstdint>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "texture.hpp"
+#include "vertex_layout.hpp"
+#include "../scene/spatial.hpp"
+#include "../scene/tilemap.hpp"
+
+struct TileCorner {
+  glm::vec2 pos;
+};
+
+struct TileInstance {
+  float layer;
+};
+
+template <> struct vtx::layout<TileCorner> {
+  static constexpr std::array<vtx::attribute, 1> attributes = {
+    VTX_ATTRIB(0, TileCorner, pos)
+  };
+};
+
+template <> struct vtx::layout<TileInstance> {
+  static constexpr std::array<vtx::attribute, 1> attributes = {
+    VTX_ATTRIB(1, TileInstance, layer)
+  };
+};
+
+struct TilemapRenderer {
+  struct gpu_chunk {
+    GLuint vao = 0;
+    GLuint instances = 0;
+    std::uint32_t version = 0; // of the uploaded tiles
+    std::uint64_t last_drawn = 0;
+  };
+
+  GLuint program = 0;
+  GLint chunk_origin = -1;
+  GLint tile_size = -1;
+  GLuint corners = 0;
+  Texture tileset;
+
+  int chunks_x = 0;
+  std::vector<gpu_chunk> chunks;
+  std::vector<float> scratch;
+  std::uint64_t frame = 0;
+  std::uint64_t idle_frames = 600;
+  std::size_t sweep = 0; // next chunk checked for idleness
+
+  // last frame
+  std::uint32_t visible = 0;
+  std::uint32_t draws = 0;
+  std::uint32_t uploads = 0;
+
+  std::uint32_t resident = 0;
+  std::uint64_t bytes_uploaded = 0;
+};
+
+TilemapRenderer createTilemapRenderer(
+  const tilemap::map &m, const GLuint program, const Texture &tileset
+);
+void destroyTilemapRenderer(TilemapRenderer &r);
+
+// `view` is spatial::view_bounds of the camera
+void drawTilemap(
+  TilemapRenderer &r, const tilemap::map &m, const spatial::aabb &view
+);
+
+#endif // __TILEMAP_RENDERER_HPP__
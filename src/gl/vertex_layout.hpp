@@ -0,0 +1,158 @@
+#ifndef __VERTEX_LAYOUT_HPP__
+#define __VERTEX_LAYOUT_HPP__
+/*
+  compile-time vertex format descriptions
+
+  a vertex type describes its attributes once, next to the struct:
+
+    struct V { glm::vec3 pos; vtx::rgba8 colour; };
+    template <> struct vtx::layout<V> {
+      static constexpr std::array<vtx::attribute, 2> attributes = {
+        VTX_ATTRIB(0, V, pos), VTX_ATTRIB(1, V, colour)
+      };
+    };
+
+  component count, gl type and normalisation are deduced from the member
+  type, offsets come from offsetof, and `setupVertexAttribs<V>()` refuses to
+  compile if attributes overlap, fall outside the struct, share a location
+  or are not 4 byte aligned.
+*/
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/packing.hpp"
+
+namespace vtx {
+  // two ieee half floats, fed to the shader as vec2
+  struct half2 {
+    std::uint16_t x = 0;
+    std::uint16_t y = 0;
+  };
+
+  // two 16 bit unsigned normalised values (e.g. texture coordinates)
+  struct unorm16x2 {
+    std::uint16_t x = 0;
+    std::uint16_t y = 0;
+  };
+
+  // 8 bit per channel normalised colour
+  struct rgba8 {
+    std::uint8_t r = 255;
+    std::uint8_t g = 255;
+    std::uint8_t b = 255;
+    std::uint8_t a = 255;
+  };
+
+  constexpr std::uint16_t unorm16(const float f) {
+    return f <= 0 ? 0 : f >= 1 ? 0xffff : std::uint16_t(f * 65535.0f + 0.5f);
+  }
+  inline half2 to_half2(const float x, const float y) {
+    return {glm::packHalf1x16(x), glm::packHalf1x16(y)};
+  }
+
+  template <typename T>
+  struct component_traits;
+
+  template <GLint N, GLenum Type, GLboolean Normalized>
+  struct component_desc {
+    static constexpr GLint size = N;
+    static constexpr GLenum type = Type;
+    static constexpr GLboolean normalized = Normalized;
+  };
+
+  template <> struct component_traits<float>
+    : component_desc<1, GL_FLOAT, GL_FALSE> {};
+  template <> struct component_traits<glm::vec2>
+    : component_desc<2, GL_FLOAT, GL_FALSE> {};
+  template <> struct component_traits<glm::vec3>
+    : component_desc<3, GL_FLOAT, GL_FALSE> {};
+  template <> struct component_traits<glm::vec4>
+    : component_desc<4, GL_FLOAT, GL_FALSE> {};
+  template <> struct component_traits<half2>
+    : component_desc<2, GL_HALF_FLOAT, GL_FALSE> {};
+  template <> struct component_traits<unorm16x2>
+    : component_desc<2, GL_UNSIGNED_SHORT, GL_TRUE> {};
+  template <> struct component_traits<rgba8>
+    : component_desc<4, GL_UNSIGNED_BYTE, GL_TRUE> {};
+
+  struct attribute {
+    GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    std::size_t offset;
+    std::size_t bytes;
+  };
+
+  template <typename T>
+  constexpr attribute make_attribute(
+    const GLuint location, const std::size_t offset
+  ) {
+    return {
+      location, component_traits<T>::size, component_traits<T>::type,
+      component_traits<T>::normalized, offset, sizeof(T)
+    };
+  }
+
+  // specialise with `static constexpr std::array<attribute, N> attributes`
+  template <typename V>
+  struct layout;
+
+  template <typename V>
+  constexpr bool is_valid_layout() {
+    constexpr auto &attribs = layout<V>::attributes;
+
+    for (std::size_t i = 0; i < attribs.size(); ++i) {
+      const attribute &a = attribs[i];
+      if (a.offset % 4 != 0 || a.offset + a.bytes > sizeof(V)) {
+        return false;
+      }
+
+      for (std::size_t j = i + 1; j < attribs.size(); ++j) {
+        const attribute &b = attribs[j];
+        if (a.location == b.location) { return false; }
+        if (a.offset < b.offset + b.bytes && b.offset < a.offset + a.bytes) {
+          return false;
+        }
+      }
+    }
+
+    return sizeof(V) % 4 == 0;
+  }
+
+  template <typename V>
+  constexpr std::size_t unused_bytes() {
+    std::size_t used = 0;
+    for (const auto &a : layout<V>::attributes) { used += a.bytes; }
+
+    return sizeof(V) - used;
+  }
+};
+
+#define VTX_ATTRIB(location, type, member) \
+  vtx::make_attribute<decltype(type::member)>(location, offsetof(type, member))
+
+// enables and describes every attribute of V for the bound vao and vbo. a
+// non-zero `divisor` makes them per instance
+template <typename V>
+void setupVertexAttribs(
+  const GLintptr base_offset=0, const GLuint divisor=0
+) {
+  static_assert(vtx::is_valid_layout<V>(), "invalid vertex layout");
+
+  for (const auto &a : vtx::layout<V>::attributes) {
+    glEnableVertexAttribArray(a.location);
+    glVertexAttribPointer(
+      a.location, a.size, a.type, a.normalized, sizeof(V),
+      reinterpret_cast<void *>(base_offset + a.offset)
+    );
+    glVertexAttribDivisor(a.location, divisor);
+  }
+}
+
+#endif // __VERTEX_LAYOUT_HPP__
@@ -19,3 +19,27 @@ GLFWwindow *createWindow(
 
   return glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
 }
+
+FramebufferSize &framebufferSize() {
+  static FramebufferSize size;
+  return size;
+}
+
+static void framebufferSizeCallback(
+  GLFWwindow *window, const int width, const int height
+) {
+  (void)window;
+
+  FramebufferSize &size = framebufferSize();
+  size.width = width;
+  size.height = height;
+  size.resized = true;
+}
+
+void trackFramebufferSize(GLFWwindow *window) {
+  FramebufferSize &size = framebufferSize();
+  glfwGetFramebufferSize(window, &size.width, &size.height);
+  size.resized = false;
+
+  glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+}
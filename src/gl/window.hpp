@@ -5,9 +5,18 @@
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
+struct FramebufferSize {
+  int width = 0;
+  int height = 0;
+  bool resized = false; // set by the callback, cleared by whoever handles it
+};
+
 GLFWwindow *createWindow(
   const int major, const int minor, const bool is_core,
   const int width, const int height, const std::string &title
 );
+// installs a framebuffer size callback updating `framebufferSize()`
+void trackFramebufferSize(GLFWwindow *window);
+FramebufferSize &framebufferSize();
 
 #endif // __WINDOW_HPP__
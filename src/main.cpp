@@ -1,11 +1,19 @@
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include <unistd.h>
+
 #include "glad.h"
 #include <GLFW/glfw3.h>
 
@@ -13,42 +21,82 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "gl/asset_loader.hpp"
+#include "gl/camera.hpp"
+#include "gl/frame_graph.hpp"
+#include "gl/gpu_resources.hpp"
+#include "gl/hud.hpp"
 #include "gl/rect.hpp"
+#include "gl/render_target.hpp"
 #include "gl/shader_program.hpp"
 #include "gl/texture.hpp"
+#include "gl/texture_residency.hpp"
+#include "gl/texture_units.hpp"
 #include "gl/window.hpp"
+#include "util/alloc_track.hpp"
+#include "util/asset_db.hpp"
+#include "util/async.hpp"
+#include "util/counters.hpp"
 #include "util/error.hpp"
+#include "util/event_log.hpp"
 #include "util/file_io.hpp"
+#include "util/image_cache.hpp"
+#include "util/jobs.hpp"
+#include "util/memory.hpp"
+#include "util/metrics.hpp"
 #include "util/xdg.hpp"
 
 const int window_width = 640;
 const int window_height = 480;
 
+// estimates, the driver does not report how much vram is actually free
+const std::size_t texture_budget = std::size_t(256) << 20;
+const std::size_t texture_cache_budget = std::size_t(64) << 20;
+
 const int gl_major_version = 3;
 const int gl_minor_version = 3;
 
-void processInput(GLFWwindow *window);
-std::string get_path(
+void processInput(GLFWwindow *window, Hud &hud);
+xdg::path get_path(
   const xdg::base &b, const std::string &n, const std::string &p
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
   #endif
 );
-std::string load_string_from_file(
-  const xdg::base &b, const std::string &n, const std::string &p
+bool load_string_from_file(
+  const xdg::base &b, const std::string &n, const std::string &p,
+  std::string &out
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+);
+GLuint load_program(
+  const xdg::base &b, const std::string &n, const std::string &v,
+  const std::string &f
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+);
+xdg::path get_texture_path(
+  const xdg::base &b, const std::string &n, const std::string &p,
+  assetdb::db *assets
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
   #endif
 );
 Texture load_texture_from_file(
-  const xdg::base &b, const std::string &n, const std::string &p
+  TextureResidency &r, const xdg::base &b, const std::string &n,
+  const std::string &p, assetdb::db *assets
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
   #endif
 );
 std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h);
+std::size_t resident_set_bytes();
 
 int main(int argc, const char *argv[]) {
+  // created here so this thread is its main thread, the one gl jobs run on
+  jobs::scheduler &scheduler = jobs::global();
   xdg::base base_dirs = xdg::get_base_directories();
 
   #ifdef DEBUG
@@ -57,6 +105,12 @@ int main(int argc, const char *argv[]) {
   std::cout << "RUNNING IN DEBUG MODE" << std::endl;
   #endif
 
+  #ifdef EVENT_LOG
+  evlog::open(
+    *xdg::get_data_path(base_dirs, "qogl", "logs/qogl.evlog", true)
+  );
+  #endif
+
   GLFWwindow *window = createWindow(
     gl_major_version, gl_minor_version, true, window_width, window_height,
     "Hello, OpenGL!"
@@ -66,11 +120,13 @@ int main(int argc, const char *argv[]) {
   log_stream << "Attempting to create context: ";
   log_stream << gl_major_version << "." << gl_minor_version << "...\n";
   #endif
+  EVLOG("create context {}.{}", gl_major_version, gl_minor_version);
 
   if (window == nullptr) {
     #ifdef DEBUG
     log_stream << "failed to create window\n";
     #endif
+    EVLOG("failed to create window");
 
     glfwDestroyWindow(window);
     return to_underlying(error_code_t::window_failed);
@@ -82,6 +138,7 @@ int main(int argc, const char *argv[]) {
     #ifdef DEBUG
     log_stream << "failed to initialise GLAD\n";
     #endif
+    EVLOG("failed to initialise GLAD");
 
     return to_underlying(error_code_t::glad_failed);
   }
@@ -90,89 +147,344 @@ int main(int argc, const char *argv[]) {
   log_stream << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
   log_stream << "GLFW Version: " << glfwGetVersionString() << "\n";
   #endif
+  EVLOG("OpenGL Version: {}", glGetString(GL_VERSION));
+  EVLOG("GLFW Version: {}", glfwGetVersionString());
 
-  glViewport(0, 0, window_width, window_height);
+  trackFramebufferSize(window);
+  glViewport(0, 0, framebufferSize().width, framebufferSize().height);
   glClearColor(0.1, 0.1, 0.2, 1.0);
 
-  std::string v_shader_string = load_string_from_file(
-    base_dirs, "qogl", "shaders/tex/vshader.glsl"
+  // gl objects created here are owned through the table and deleted a few
+  // frames after they are released
+  GpuResourceTable gpu;
+
+  TextureResidency textures = createTextureResidency(
+    texture_budget, texture_cache_budget
+  );
+  auto image_cache = imgcache::open(
+    base_dirs.xdg_cache_home / "qogl" / "images"
+  );
+  if (image_cache) {
+    textures.disk_cache = &*image_cache;
+  }
+  // what `bake` recorded, to tell a stale baked texture from a current one.
+  // read only: bake owns the file, so it is never saved from here
+  auto assets = assetdb::open(base_dirs.xdg_cache_home / "qogl" / "assets.db");
+
+  // the sdf text shading runs over the quad batch vertex shader
+  GLuint scene_program_name = 0;
+  GLuint text_program_name = 0;
+  Texture texture;
+  #ifdef COROUTINES
+  {
+    auto path = [&](const std::string &p) {
+      return get_path(base_dirs, "qogl", p
+        #ifdef DEBUG
+        , log_stream
+        #endif
+      );
+    };
+    const xdg::path texture_path = get_texture_path(
+      base_dirs, "qogl", "textures/wood.jpg", assets ? &*assets : nullptr
+      #ifdef DEBUG
+      , log_stream
+      #endif
+    );
+
+    // all five files are read at once, and the image decodes on a worker
+    // while the shaders compile here
+    std::tie(scene_program_name, text_program_name, texture) =
+      async::sync_wait(async::when_all(
+        loadProgramAsync(
+          path("shaders/tex/vshader.glsl"), path("shaders/tex/fshader.glsl")
+          #ifdef DEBUG
+          , &log_stream
+          #endif
+        ),
+        loadProgramAsync(
+          path("shaders/quad/vshader.glsl"), path("shaders/text/fshader.glsl")
+          #ifdef DEBUG
+          , &log_stream
+          #endif
+        ),
+        loadTextureAsync(textures, texture_path)
+      ));
+  }
+  #else
+  scene_program_name = load_program(
+    base_dirs, "qogl", "shaders/tex/vshader.glsl", "shaders/tex/fshader.glsl"
     #ifdef DEBUG
     , log_stream
     #endif
   );
-  std::string f_shader_string = load_string_from_file(
-    base_dirs, "qogl", "shaders/tex/fshader.glsl"
+  text_program_name = load_program(
+    base_dirs, "qogl", "shaders/quad/vshader.glsl",
+    "shaders/text/fshader.glsl"
     #ifdef DEBUG
     , log_stream
     #endif
   );
-
-  GLuint v_shader = createShader(GL_VERTEX_SHADER, v_shader_string);
-  GLuint f_shader = createShader(GL_FRAGMENT_SHADER, f_shader_string);
-  #ifdef DEBUG
-  const auto v_compile_error = getCompileStatus(v_shader);
-  if (v_compile_error) {
-    log_stream << "vertex shader compilation failed\n";
-    log_stream << *v_compile_error << "\n";
-  }
-  const auto f_compile_error = getCompileStatus(f_shader);
-  if (f_compile_error) {
-    log_stream << "fragment shader compilation failed\n";
-    log_stream << *f_compile_error << "\n";
-  }
-  #endif
-
-  GLuint shader_program = createProgram(v_shader, f_shader, true);
-  #ifdef DEBUG
-  const auto link_error = getLinkStatus(shader_program);
-  if (link_error) {
-    log_stream << "shader program link failed\n";
-    log_stream << *link_error << "\n";
-  }
-  #endif
-
-  glUseProgram(shader_program);
-
-  Rect rect = createRect();
-
-  Texture texture = load_texture_from_file(
-    base_dirs, "qogl", "textures/wood.jpg"
+  texture = load_texture_from_file(
+    textures, base_dirs, "qogl", "textures/wood.jpg",
+    assets ? &*assets : nullptr
     #ifdef DEBUG
     , log_stream
     #endif
   );
+  #endif
   // Texture texture = loadTexture(texture_path.c_str());
 
-  auto [projection, view, model] = fullscreen_rect_matrices(
-    window_width, window_height
+  GpuResource scene_program(
+    gpu, GpuResourceKind::program, scene_program_name
+  );
+  // names are looked up at every use, so the table knows the last frame
+  // each was used in and delays their deletion past it
+  bindCameraBlock(scene_program.name());
+  glUseProgram(scene_program.name());
+  counters::count(counters::engine::state_changes);
+
+  GpuResource text_program(gpu, GpuResourceKind::program, text_program_name);
+  bindCameraBlock(text_program.name());
+
+  const counters::id frame_time = counters::add(
+    "frame.time_us", counters::kind_t::gauge, counters::unit_t::microseconds
+  );
+  const counters::id rss = counters::add(
+    "memory.rss", counters::kind_t::gauge, counters::unit_t::bytes
+  );
+  const counters::id frame_arena_bytes = counters::add(
+    "memory.frame_arena", counters::kind_t::gauge, counters::unit_t::bytes
+  );
+
+  Hud hud = createHud(text_program.name());
+  addHudCounter(hud, "frame.time_us", "frame time", true, 0xff60ff60);
+  addHudCounter(hud, "gl.draw_calls", "draw calls", true, 0xffffc060);
+  addHudCounter(hud, "gl.state_changes", "state changes");
+  addHudCounter(hud, "gl.texture_uploads", "texture uploads");
+  addHudCounter(hud, "gl.bytes_streamed", "bytes streamed", true, 0xff60c0ff);
+  addHudCounter(hud, "memory.textures", "texture memory");
+  addHudCounter(hud, "memory.render_targets", "render targets");
+  addHudCounter(hud, "memory.rss", "resident set");
+  addHudCounter(hud, "memory.frame_arena", "frame arena");
+
+  const Rect rect = createRect();
+  GpuResource rect_vao(gpu, GpuResourceKind::vertex_array, rect.vao);
+  GpuResource rect_vbo(gpu, GpuResourceKind::buffer, rect.vbo);
+  GpuResource rect_ebo(gpu, GpuResourceKind::buffer, rect.ebo);
+
+  RenderTargetPool targets = createRenderTargetPool();
+  FrameGraph graph;
+
+  // passes only change with the framebuffer size, so the graph is rebuilt
+  // and compiled on resize rather than every frame
+  auto build_graph = [&](const int w, const int h) {
+    resetFrameGraph(graph);
+    const FrameResource window_target = importFramebuffer(
+      graph, "window", {0, w, h}
+    );
+    const FrameResource scene_colour = createTransient(
+      graph, "scene colour", {w, h, GL_RGBA8}
+    );
+
+    const int scene = addPass(
+      graph, "scene",
+      [&scene_program, &textures, &texture, &rect_vao](FramePassContext &) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(scene_program.name());
+        counters::count(counters::engine::state_changes);
+        bindTexture(textures, texture);
+        // the shared linear, repeating sampler, only for this draw: the
+        // text atlas and render targets keep their own clamped parameters
+        bindSampler(0, getSampler({}));
+        drawRect({rect_vao.name()});
+      }
+    );
+    passWrites(graph, scene, scene_colour);
+
+    // drawn into the scene rather than the window, so it is in anything
+    // the scene target is captured from
+    const int overlay = addPass(
+      graph, "hud", [&hud, &text_program, h](FramePassContext &) {
+        hud.program = text_program.name();
+        drawHud(hud, h);
+      }
+    );
+    passWrites(graph, overlay, scene_colour);
+
+    const int present = addPass(
+      graph, "present", [scene_colour](FramePassContext &ctx) {
+        const RenderTarget &src = frameTarget(ctx.graph, scene_colour);
+        blitFramebuffer(framebufferFor(ctx.pool, &src, 1), ctx.target);
+      }
+    );
+    passReads(graph, present, scene_colour);
+    passWrites(graph, present, window_target);
+
+    compileFrameGraph(graph);
+  };
+
+  Camera camera = createCamera();
+  auto resize = [&](const int w, const int h) {
+    auto [projection, view, model] = fullscreen_rect_matrices(w, h);
+    updateCamera(camera, {projection, view, glm::vec4(0, 0, w, h)});
+    uniformMatrix4fv(scene_program.name(), "model", glm::value_ptr(model));
+    build_graph(w, h);
+  };
+  resize(framebufferSize().width, framebufferSize().height);
+
+  metrics::histogram &frame_times = metrics::add_histogram(
+    "qogl_frame_seconds", "time from one frame's start to the next"
+  );
+  metrics::counter &frames = metrics::add_counter(
+    "qogl_frames_total", "frames presented"
   );
 
-  uniformMatrix4fv(shader_program, "projection", glm::value_ptr(projection));
-  uniformMatrix4fv(shader_program, "view", glm::value_ptr(view));
-  uniformMatrix4fv(shader_program, "model", glm::value_ptr(model));
+  // every hud counter as a gauge holding its last completed frame
+  std::vector<std::pair<counters::id, metrics::gauge *>> frame_gauges;
+  for (counters::id c = 0; c < counters::size(); ++c) {
+    const std::string &name = counters::get(c).name;
+    std::string metric = "qogl_" + name;
+    std::replace(metric.begin(), metric.end(), '.', '_');
+    frame_gauges.emplace_back(
+      c, &metrics::add_gauge(metric, name + ", last frame")
+    );
+  }
+
+  // the runtime dir is per user and usually tmpfs, so dumps are cheap
+  std::optional<metrics::exporter> exporter;
+  if (!base_dirs.xdg_runtime_dir.empty()) {
+    const xdg::path dir = base_dirs.xdg_runtime_dir / "qogl";
+    exporter.emplace(
+      std::vector<std::pair<xdg::path, metrics::format_t>>{
+        {dir / "metrics.prom", metrics::format_t::prometheus},
+        {dir / "metrics.json", metrics::format_t::json}
+      },
+      std::chrono::seconds(1)
+    );
+  } else {
+    #ifdef DEBUG
+    log_stream << "[w] XDG_RUNTIME_DIR is not set, metrics not exported\n";
+    #endif
+    EVLOG("[w] XDG_RUNTIME_DIR is not set, metrics not exported");
+  }
+
+  #ifdef EVENT_LOG
+  std::uint64_t frame = 0;
+  #endif
+  auto frame_start = std::chrono::steady_clock::now();
 
   while (!glfwWindowShouldClose(window)) {
-    glClear(GL_COLOR_BUFFER_BIT);
     glfwPollEvents();
-    processInput(window);
-
-    glUseProgram(shader_program);
-    bindTexture(texture);
-    drawRect(rect);
+    processInput(window, hud);
+    scheduler.run_main_thread_jobs();
+
+    FramebufferSize &size = framebufferSize();
+    if (size.resized) {
+      size.resized = false;
+      resize(size.width, size.height);
+      // the old size's targets would otherwise idle for a few frames
+      trimRenderTargets(targets);
+      EVLOG("framebuffer resized to {}x{}", size.width, size.height);
+    }
+
+    // minimised
+    if (size.width == 0 || size.height == 0) {
+      glfwWaitEvents();
+      continue;
+    }
+
+    beginRenderTargetFrame(targets);
+    executeFrameGraph(graph, targets);
 
     glfwSwapBuffers(window);
+
+    advanceGpuFrame(gpu);
+
+    // nothing allocated from the frame arena outlives the frame
+    counters::set(frame_arena_bytes, mem::frame_arena().used());
+    mem::frame_arena().reset();
+
+    const auto frame_end = std::chrono::steady_clock::now();
+    const auto frame_us = std::chrono::duration_cast<
+      std::chrono::microseconds
+    >(frame_end - frame_start).count();
+    frame_start = frame_end;
+    EVLOG("frame {} took {}us", frame++, frame_us);
+
+    counters::set(frame_time, frame_us);
+    // a read of /proc per frame is more than the number is worth
+    if (counters::frames() % 30 == 0) {
+      counters::set(rss, resident_set_bytes());
+    }
+    counters::end_frame();
+
+    frames.add();
+    frame_times.record(frame_us);
+    for (const auto &[c, g] : frame_gauges) { g->set(counters::last(c)); }
+  }
+
+  EVLOG(
+    "textures: {} bytes resident, {} evictions, {} reloads, {} cache hits",
+    textures.resident_bytes, textures.evictions, textures.reloads,
+    textures.cache_hits
+  );
+  if (image_cache) {
+    EVLOG(
+      "image cache: {} hits, {} misses, {} rehashes", image_cache->hits,
+      image_cache->misses, image_cache->rehashes
+    );
   }
+  EVLOG(
+    "render targets: {} bytes allocated, last frame {} acquired, {} created",
+    targets.bytes_allocated, targets.last_frame.acquired,
+    targets.last_frame.created
+  );
+  EVLOG(
+    "gpu resources: {} live, {} deleted, {} stale lookups", gpu.live,
+    gpu.deleted, gpu.stale_lookups
+  );
+  EVLOG(
+    "jobs: {} executed, {} stolen, {} threads", scheduler.executed.load(),
+    scheduler.stolen.load(), scheduler.threads()
+  );
+  destroyHud(hud);
+  destroyRenderTargetPool(targets);
+  destroyTextureResidency(textures);
+  destroySamplers();
+  // released first, so the table deletes them with everything else
+  scene_program.reset();
+  text_program.reset();
+  rect_vao.reset();
+  rect_vbo.reset();
+  rect_ebo.reset();
+  destroyGpuResourceTable(gpu);
+
+  #ifdef EVENT_LOG
+  evlog::close();
+  #endif
+
+  #ifdef ALLOC_TRACK
+  alloc::report(stderr);
+  #endif
 
   return 0;
 }
 
-void processInput(GLFWwindow *window) {
+void processInput(GLFWwindow *window, Hud &hud) {
   if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
     glfwSetWindowShouldClose(window, true);
   }
+
+  // toggles on the press, not every frame the key is held
+  static bool f3_held = false;
+  const bool f3 = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+  if (f3 && !f3_held) {
+    hud.visible = !hud.visible;
+  }
+  f3_held = f3;
 }
 
-std::string get_path(
+xdg::path get_path(
   const xdg::base &b, const std::string &n, const std::string &p
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
@@ -181,24 +493,29 @@ std::string get_path(
   #ifdef DEBUG
   log_stream << "Fetching path...\n";
   #endif
+  EVLOG("fetching path {}", p);
   auto path = xdg::get_data_path(b, n, p);
   if (!path) {
     #ifdef DEBUG
     log_stream << "[w] `" << p << "` not found...\n";
     #endif
+    EVLOG("[w] `{}` not found", p);
 
-    return "";
+    return {};
   }
 
   #ifdef DEBUG
   log_stream << "--> " << *path << "\n";
   #endif
+  EVLOG("--> {}", *path);
 
-  return *path;
+  return std::move(*path);
 }
 
-std::string load_string_from_file(
-  const xdg::base &b, const std::string &n, const std::string &p
+// reads into `out` so one buffer can serve several files
+bool load_string_from_file(
+  const xdg::base &b, const std::string &n, const std::string &p,
+  std::string &out
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
   #endif
@@ -206,26 +523,95 @@ std::string load_string_from_file(
   #ifdef DEBUG
   log_stream << "Loading file: " << p << "\n";
   #endif
+  EVLOG("loading file {}", p);
 
-  std::string path = get_path(b, n, p
+  const xdg::path path = get_path(b, n, p
     #ifdef DEBUG
     , log_stream
     #endif
   );
-  auto data = fio::read(path);
-  if (!data) {
+  if (!fio::read(path, out)) {
     #ifdef DEBUG
     log_stream << "[w] Could not read file...\n";
     #endif
+    EVLOG("[w] could not read file {}", path);
 
-    return "";
+    out.clear();
+    return false;
   }
 
-  return *data;
+  return true;
+}
+
+GLuint load_program(
+  const xdg::base &b, const std::string &n, const std::string &v,
+  const std::string &f
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+) {
+  ALLOC_SCOPE(shaders);
+  // each source is compiled before the next is read into the same buffer
+  std::string source;
+  load_string_from_file(b, n, v, source
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
+  GLuint v_shader = createShader(GL_VERTEX_SHADER, source);
+  load_string_from_file(b, n, f, source
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
+  GLuint f_shader = createShader(GL_FRAGMENT_SHADER, source);
+
+  return createCheckedProgram(v_shader, f_shader
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
+}
+
+// prefers a block compressed copy baked by texcompress or bake, unless
+// `assets` knows it was baked from an older source
+xdg::path get_texture_path(
+  const xdg::base &b, const std::string &n, const std::string &p,
+  assetdb::db *assets
+  #ifdef DEBUG
+  , fio::log_stream_f &log_stream
+  #endif
+) {
+  auto baked = xdg::get_data_path(
+    b, n, xdg::path(p).replace_extension(".qtex")
+  );
+  if (baked && assets && !assetdb::up_to_date(*assets, *baked)) {
+    #ifdef DEBUG
+    log_stream << "[w] `" << *baked << "` is out of date\n";
+    #endif
+    EVLOG("[w] `{}` is out of date", *baked);
+
+    baked.reset();
+  }
+  if (baked) {
+    #ifdef DEBUG
+    log_stream << "--> " << *baked << "\n";
+    #endif
+    EVLOG("--> {}", *baked);
+
+    return std::move(*baked);
+  }
+
+  return get_path(b, n, p
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
 }
 
 Texture load_texture_from_file(
-  const xdg::base &b, const std::string &n, const std::string &p
+  TextureResidency &r, const xdg::base &b, const std::string &n,
+  const std::string &p, assetdb::db *assets
   #ifdef DEBUG
   , fio::log_stream_f &log_stream
   #endif
@@ -233,14 +619,17 @@ Texture load_texture_from_file(
   #ifdef DEBUG
   log_stream << "Loading file: " << p << "\n";
   #endif
+  EVLOG("loading file {}", p);
 
-  std::string path = get_path(b, n, p
+  const xdg::path path = get_texture_path(b, n, p, assets
     #ifdef DEBUG
     , log_stream
     #endif
   );
 
-  return loadTexture(path.c_str());
+  return loadManagedTexture(
+    r, path.c_str(), path.extension() == ".qtex"
+  );
 }
 
 std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h) {
@@ -254,3 +643,13 @@ std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h) {
 
   return {projection, view, model};
 }
+
+std::size_t resident_set_bytes() {
+  // statm is in pages: total size, then resident
+  std::ifstream statm("/proc/self/statm");
+  std::size_t size = 0;
+  std::size_t resident = 0;
+  if (!(statm >> size >> resident)) { return 0; }
+
+  return resident * std::size_t(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,469 @@
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define XFORM_X86 1
+#include <immintrin.h>
+#endif
+
+#include "glm/glm.hpp"
+
+#include "transform.hpp"
+
+#if defined(XFORM_X86) && (defined(__GNUC__) || defined(__clang__))
+#define XFORM_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+using kernel_f = void (*)(const xform::soa_view &, float *, std::size_t);
+
+/*
+  scalar
+*/
+static void matrices_scalar(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  for (; i < in.count; ++i) {
+    const float c = std::cos(in.rot[i]);
+    const float s = std::sin(in.rot[i]);
+    float *m = out + i * 16;
+
+    m[0] = c * in.sx[i];  m[1] = s * in.sx[i];  m[2] = 0;  m[3] = 0;
+    m[4] = -s * in.sy[i]; m[5] = c * in.sy[i];  m[6] = 0;  m[7] = 0;
+    m[8] = 0;             m[9] = 0;             m[10] = 1; m[11] = 0;
+    m[12] = in.x[i];      m[13] = in.y[i];      m[14] = 0; m[15] = 1;
+  }
+}
+
+static void quads_scalar(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  for (; i < in.count; ++i) {
+    const float c = std::cos(in.rot[i]);
+    const float s = std::sin(in.rot[i]);
+    const float ux = c * in.sx[i];
+    const float uy = s * in.sx[i];
+    const float vx = -s * in.sy[i];
+    const float vy = c * in.sy[i];
+    float *q = out + i * 8;
+
+    q[0] = in.x[i] + vx;      q[1] = in.y[i] + vy;      // a (0, 1)
+    q[2] = in.x[i];           q[3] = in.y[i];           // b (0, 0)
+    q[4] = in.x[i] + ux;      q[5] = in.y[i] + uy;      // c (1, 0)
+    q[6] = in.x[i] + ux + vx; q[7] = in.y[i] + uy + vy; // d (1, 1)
+  }
+}
+
+#ifdef XFORM_X86
+/*
+  sincos for packed floats, after the cephes single precision implementation
+  (the same reduction and polynomials as sse_mathfun.h). accurate to a few
+  ulp for |x| < 8192, which is far more range than a sprite rotation needs.
+*/
+namespace sincos_k {
+  constexpr float fopi = 1.27323954473516f;
+  constexpr float dp1 = -0.78515625f;
+  constexpr float dp2 = -2.4187564849853515625e-4f;
+  constexpr float dp3 = -3.77489497744594108e-8f;
+  constexpr float cos_p0 = 2.443315711809948e-5f;
+  constexpr float cos_p1 = -1.388731625493765e-3f;
+  constexpr float cos_p2 = 4.166664568298827e-2f;
+  constexpr float sin_p0 = -1.9515295891e-4f;
+  constexpr float sin_p1 = 8.3321608736e-3f;
+  constexpr float sin_p2 = -1.6666654611e-1f;
+};
+
+static inline void sincos_sse2(__m128 x, __m128 &s, __m128 &c) {
+  using namespace sincos_k;
+  const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+  __m128 sign_sin = _mm_and_ps(x, sign_mask);
+  x = _mm_andnot_ps(sign_mask, x);
+
+  __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(fopi)));
+  j = _mm_add_epi32(j, _mm_set1_epi32(1));
+  j = _mm_and_si128(j, _mm_set1_epi32(~1));
+  const __m128 y = _mm_cvtepi32_ps(j);
+
+  const __m128 swap_sign_sin = _mm_castsi128_ps(
+    _mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)
+  );
+  const __m128 sign_cos = _mm_castsi128_ps(_mm_slli_epi32(
+    _mm_andnot_si128(
+      _mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)
+    ), 29
+  ));
+  const __m128 poly_mask = _mm_castsi128_ps(_mm_cmpeq_epi32(
+    _mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()
+  ));
+  sign_sin = _mm_xor_ps(sign_sin, swap_sign_sin);
+
+  x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(dp1)));
+  x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(dp2)));
+  x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(dp3)));
+  const __m128 z = _mm_mul_ps(x, x);
+
+  __m128 pc = _mm_set1_ps(cos_p0);
+  pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(cos_p1));
+  pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(cos_p2));
+  pc = _mm_mul_ps(_mm_mul_ps(pc, z), z);
+  pc = _mm_sub_ps(pc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  pc = _mm_add_ps(pc, _mm_set1_ps(1.0f));
+
+  __m128 ps = _mm_set1_ps(sin_p0);
+  ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(sin_p1));
+  ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(sin_p2));
+  ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), x), x);
+
+  const __m128 sin_v = _mm_or_ps(
+    _mm_and_ps(poly_mask, ps), _mm_andnot_ps(poly_mask, pc)
+  );
+  const __m128 cos_v = _mm_or_ps(
+    _mm_and_ps(poly_mask, pc), _mm_andnot_ps(poly_mask, ps)
+  );
+
+  s = _mm_xor_ps(sin_v, sign_sin);
+  c = _mm_xor_ps(cos_v, sign_cos);
+}
+
+static void matrices_sse2(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 zero_one = _mm_setr_ps(0, 1, 0, 1);
+  const __m128 col2 = _mm_setr_ps(0, 0, 1, 0);
+
+  for (; i + 4 <= in.count; i += 4) {
+    __m128 s;
+    __m128 c;
+    sincos_sse2(_mm_loadu_ps(in.rot + i), s, c);
+
+    const __m128 sx = _mm_loadu_ps(in.sx + i);
+    const __m128 sy = _mm_loadu_ps(in.sy + i);
+
+    // (ux, uy) is the first column, (vx, vy) the second, (tx, ty) the fourth
+    const __m128 ux = _mm_mul_ps(c, sx);
+    const __m128 uy = _mm_mul_ps(s, sx);
+    const __m128 vx = _mm_sub_ps(zero, _mm_mul_ps(s, sy));
+    const __m128 vy = _mm_mul_ps(c, sy);
+
+    const __m128 u[2] = {_mm_unpacklo_ps(ux, uy), _mm_unpackhi_ps(ux, uy)};
+    const __m128 v[2] = {_mm_unpacklo_ps(vx, vy), _mm_unpackhi_ps(vx, vy)};
+    const __m128 t[2] = {
+      _mm_unpacklo_ps(_mm_loadu_ps(in.x + i), _mm_loadu_ps(in.y + i)),
+      _mm_unpackhi_ps(_mm_loadu_ps(in.x + i), _mm_loadu_ps(in.y + i))
+    };
+
+    float *m = out + i * 16;
+    for (int h = 0; h < 2; ++h, m += 32) {
+      _mm_storeu_ps(m + 0, _mm_movelh_ps(u[h], zero));
+      _mm_storeu_ps(m + 4, _mm_movelh_ps(v[h], zero));
+      _mm_storeu_ps(m + 8, col2);
+      _mm_storeu_ps(m + 12, _mm_movelh_ps(t[h], zero_one));
+
+      _mm_storeu_ps(m + 16, _mm_movehl_ps(zero, u[h]));
+      _mm_storeu_ps(m + 20, _mm_movehl_ps(zero, v[h]));
+      _mm_storeu_ps(m + 24, col2);
+      _mm_storeu_ps(m + 28, _mm_shuffle_ps(t[h], zero_one, 0x4e));
+    }
+  }
+
+  matrices_scalar(in, out, i);
+}
+
+static void quads_sse2(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  const __m128 zero = _mm_setzero_ps();
+
+  for (; i + 4 <= in.count; i += 4) {
+    __m128 s;
+    __m128 c;
+    sincos_sse2(_mm_loadu_ps(in.rot + i), s, c);
+
+    const __m128 sx = _mm_loadu_ps(in.sx + i);
+    const __m128 sy = _mm_loadu_ps(in.sy + i);
+    const __m128 ux = _mm_mul_ps(c, sx);
+    const __m128 uy = _mm_mul_ps(s, sx);
+    const __m128 vx = _mm_sub_ps(zero, _mm_mul_ps(s, sy));
+    const __m128 vy = _mm_mul_ps(c, sy);
+
+    const __m128 bx = _mm_loadu_ps(in.x + i);
+    const __m128 by = _mm_loadu_ps(in.y + i);
+    const __m128 ax = _mm_add_ps(bx, vx);
+    const __m128 ay = _mm_add_ps(by, vy);
+    const __m128 cx = _mm_add_ps(bx, ux);
+    const __m128 cy = _mm_add_ps(by, uy);
+    const __m128 dx = _mm_add_ps(cx, vx);
+    const __m128 dy = _mm_add_ps(cy, vy);
+
+    const __m128 a[2] = {_mm_unpacklo_ps(ax, ay), _mm_unpackhi_ps(ax, ay)};
+    const __m128 b[2] = {_mm_unpacklo_ps(bx, by), _mm_unpackhi_ps(bx, by)};
+    const __m128 cc[2] = {_mm_unpacklo_ps(cx, cy), _mm_unpackhi_ps(cx, cy)};
+    const __m128 d[2] = {_mm_unpacklo_ps(dx, dy), _mm_unpackhi_ps(dx, dy)};
+
+    float *q = out + i * 8;
+    for (int h = 0; h < 2; ++h, q += 16) {
+      _mm_storeu_ps(q + 0, _mm_movelh_ps(a[h], b[h]));
+      _mm_storeu_ps(q + 4, _mm_movelh_ps(cc[h], d[h]));
+      _mm_storeu_ps(q + 8, _mm_movehl_ps(b[h], a[h]));
+      _mm_storeu_ps(q + 12, _mm_movehl_ps(d[h], cc[h]));
+    }
+  }
+
+  quads_scalar(in, out, i);
+}
+#endif // XFORM_X86
+
+#ifdef XFORM_AVX2
+TARGET_AVX2 static inline void sincos_avx2(__m256 x, __m256 &s, __m256 &c) {
+  using namespace sincos_k;
+  const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+  __m256 sign_sin = _mm256_and_ps(x, sign_mask);
+  x = _mm256_andnot_ps(sign_mask, x);
+
+  __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(fopi)));
+  j = _mm256_add_epi32(j, _mm256_set1_epi32(1));
+  j = _mm256_and_si256(j, _mm256_set1_epi32(~1));
+  const __m256 y = _mm256_cvtepi32_ps(j);
+
+  const __m256 swap_sign_sin = _mm256_castsi256_ps(
+    _mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)
+  );
+  const __m256 sign_cos = _mm256_castsi256_ps(_mm256_slli_epi32(
+    _mm256_andnot_si256(
+      _mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)
+    ), 29
+  ));
+  const __m256 poly_mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+    _mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()
+  ));
+  sign_sin = _mm256_xor_ps(sign_sin, swap_sign_sin);
+
+  x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(dp1)));
+  x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(dp2)));
+  x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(dp3)));
+  const __m256 z = _mm256_mul_ps(x, x);
+
+  __m256 pc = _mm256_set1_ps(cos_p0);
+  pc = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(cos_p1));
+  pc = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(cos_p2));
+  pc = _mm256_mul_ps(_mm256_mul_ps(pc, z), z);
+  pc = _mm256_sub_ps(pc, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+  pc = _mm256_add_ps(pc, _mm256_set1_ps(1.0f));
+
+  __m256 ps = _mm256_set1_ps(sin_p0);
+  ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(sin_p1));
+  ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(sin_p2));
+  ps = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ps, z), x), x);
+
+  s = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, poly_mask), sign_sin);
+  c = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, poly_mask), sign_cos);
+}
+
+TARGET_AVX2 static void matrices_avx2(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 zero_one = _mm256_setr_ps(0, 1, 0, 1, 0, 1, 0, 1);
+  const __m256 col2 = _mm256_setr_ps(0, 0, 1, 0, 0, 0, 1, 0);
+
+  for (; i + 8 <= in.count; i += 8) {
+    __m256 s;
+    __m256 c;
+    sincos_avx2(_mm256_loadu_ps(in.rot + i), s, c);
+
+    const __m256 sx = _mm256_loadu_ps(in.sx + i);
+    const __m256 sy = _mm256_loadu_ps(in.sy + i);
+    const __m256 ux = _mm256_mul_ps(c, sx);
+    const __m256 uy = _mm256_mul_ps(s, sx);
+    const __m256 vx = _mm256_sub_ps(zero, _mm256_mul_ps(s, sy));
+    const __m256 vy = _mm256_mul_ps(c, sy);
+    const __m256 tx = _mm256_loadu_ps(in.x + i);
+    const __m256 ty = _mm256_loadu_ps(in.y + i);
+
+    // pairs for objects {0, 1 | 4, 5} then {2, 3 | 6, 7}
+    const __m256 u[2] = {
+      _mm256_unpacklo_ps(ux, uy), _mm256_unpackhi_ps(ux, uy)
+    };
+    const __m256 v[2] = {
+      _mm256_unpacklo_ps(vx, vy), _mm256_unpackhi_ps(vx, vy)
+    };
+    const __m256 t[2] = {
+      _mm256_unpacklo_ps(tx, ty), _mm256_unpackhi_ps(tx, ty)
+    };
+
+    float *m = out + i * 16;
+    for (int h = 0; h < 2; ++h) {
+      for (int odd = 0; odd < 2; ++odd) {
+        __m256 uc;
+        __m256 vc;
+        __m256 tc;
+        if (odd) {
+          uc = _mm256_castpd_ps(_mm256_unpackhi_pd(
+            _mm256_castps_pd(u[h]), _mm256_castps_pd(zero)
+          ));
+          vc = _mm256_castpd_ps(_mm256_unpackhi_pd(
+            _mm256_castps_pd(v[h]), _mm256_castps_pd(zero)
+          ));
+          tc = _mm256_castpd_ps(_mm256_unpackhi_pd(
+            _mm256_castps_pd(t[h]), _mm256_castps_pd(zero_one)
+          ));
+        } else {
+          uc = _mm256_castpd_ps(_mm256_unpacklo_pd(
+            _mm256_castps_pd(u[h]), _mm256_castps_pd(zero)
+          ));
+          vc = _mm256_castpd_ps(_mm256_unpacklo_pd(
+            _mm256_castps_pd(v[h]), _mm256_castps_pd(zero)
+          ));
+          tc = _mm256_castpd_ps(_mm256_unpacklo_pd(
+            _mm256_castps_pd(t[h]), _mm256_castps_pd(zero_one)
+          ));
+        }
+
+        // object index within the block of 8 for the low and high lanes
+        const int lo = h * 2 + odd;
+        const int hi = lo + 4;
+        _mm256_storeu_ps(m + lo * 16, _mm256_permute2f128_ps(uc, vc, 0x20));
+        _mm256_storeu_ps(m + lo * 16 + 8, _mm256_permute2f128_ps(col2, tc, 0x20));
+        _mm256_storeu_ps(m + hi * 16, _mm256_permute2f128_ps(uc, vc, 0x31));
+        _mm256_storeu_ps(m + hi * 16 + 8, _mm256_permute2f128_ps(col2, tc, 0x31));
+      }
+    }
+  }
+
+  matrices_sse2(in, out, i);
+}
+
+TARGET_AVX2 static void quads_avx2(
+  const xform::soa_view &in, float *out, std::size_t i
+) {
+  const __m256 zero = _mm256_setzero_ps();
+
+  for (; i + 8 <= in.count; i += 8) {
+    __m256 s;
+    __m256 c;
+    sincos_avx2(_mm256_loadu_ps(in.rot + i), s, c);
+
+    const __m256 sx = _mm256_loadu_ps(in.sx + i);
+    const __m256 sy = _mm256_loadu_ps(in.sy + i);
+    const __m256 ux = _mm256_mul_ps(c, sx);
+    const __m256 uy = _mm256_mul_ps(s, sx);
+    const __m256 vx = _mm256_sub_ps(zero, _mm256_mul_ps(s, sy));
+    const __m256 vy = _mm256_mul_ps(c, sy);
+
+    const __m256 bx = _mm256_loadu_ps(in.x + i);
+    const __m256 by = _mm256_loadu_ps(in.y + i);
+    const __m256 ax = _mm256_add_ps(bx, vx);
+    const __m256 ay = _mm256_add_ps(by, vy);
+    const __m256 cx = _mm256_add_ps(bx, ux);
+    const __m256 cy = _mm256_add_ps(by, uy);
+    const __m256 dx = _mm256_add_ps(cx, vx);
+    const __m256 dy = _mm256_add_ps(cy, vy);
+
+    const __m256 a[2] = {_mm256_unpacklo_ps(ax, ay), _mm256_unpackhi_ps(ax, ay)};
+    const __m256 b[2] = {_mm256_unpacklo_ps(bx, by), _mm256_unpackhi_ps(bx, by)};
+    const __m256 cc[2] = {_mm256_unpacklo_ps(cx, cy), _mm256_unpackhi_ps(cx, cy)};
+    const __m256 d[2] = {_mm256_unpacklo_ps(dx, dy), _mm256_unpackhi_ps(dx, dy)};
+
+    float *q = out + i * 8;
+    for (int h = 0; h < 2; ++h) {
+      for (int odd = 0; odd < 2; ++odd) {
+        __m256 ab;
+        __m256 cd;
+        if (odd) {
+          ab = _mm256_castpd_ps(_mm256_unpackhi_pd(
+            _mm256_castps_pd(a[h]), _mm256_castps_pd(b[h])
+          ));
+          cd = _mm256_castpd_ps(_mm256_unpackhi_pd(
+            _mm256_castps_pd(cc[h]), _mm256_castps_pd(d[h])
+          ));
+        } else {
+          ab = _mm256_castpd_ps(_mm256_unpacklo_pd(
+            _mm256_castps_pd(a[h]), _mm256_castps_pd(b[h])
+          ));
+          cd = _mm256_castpd_ps(_mm256_unpacklo_pd(
+            _mm256_castps_pd(cc[h]), _mm256_castps_pd(d[h])
+          ));
+        }
+
+        const int lo = h * 2 + odd;
+        const int hi = lo + 4;
+        _mm256_storeu_ps(q + lo * 8, _mm256_permute2f128_ps(ab, cd, 0x20));
+        _mm256_storeu_ps(q + hi * 8, _mm256_permute2f128_ps(ab, cd, 0x31));
+      }
+    }
+  }
+
+  quads_sse2(in, out, i);
+}
+#endif // XFORM_AVX2
+
+struct kernels {
+  xform::isa_t isa;
+  kernel_f matrices;
+  kernel_f quads;
+};
+
+static kernels kernels_for(const xform::isa_t isa) {
+  switch (isa) {
+    #ifdef XFORM_AVX2
+    case xform::isa_t::avx2:
+      return {isa, matrices_avx2, quads_avx2};
+    #endif
+    #ifdef XFORM_X86
+    case xform::isa_t::sse2:
+      return {isa, matrices_sse2, quads_sse2};
+    #endif
+    default:
+      return {xform::isa_t::scalar, matrices_scalar, quads_scalar};
+  }
+}
+
+static kernels &active() {
+  static kernels k = kernels_for(xform::best_isa());
+  return k;
+}
+
+xform::isa_t xform::best_isa() {
+  #ifdef XFORM_AVX2
+  if (__builtin_cpu_supports("avx2")) { return isa_t::avx2; }
+  #endif
+  #ifdef XFORM_X86
+  return isa_t::sse2;
+  #else
+  return isa_t::scalar;
+  #endif
+}
+
+xform::isa_t xform::active_isa() {
+  return active().isa;
+}
+
+void xform::set_isa(const isa_t isa) {
+  active() = kernels_for(
+    static_cast<int>(isa) > static_cast<int>(best_isa()) ? best_isa() : isa
+  );
+}
+
+const char *xform::isa_name(const isa_t isa) {
+  switch (isa) {
+    case isa_t::avx2: return "avx2";
+    case isa_t::sse2: return "sse2";
+    default: return "scalar";
+  }
+}
+
+void xform::model_matrices(const soa_view &in, float *out) {
+  active().matrices(in, out, 0);
+}
+
+void xform::model_matrices(const soa_view &in, glm::mat4 *out) {
+  static_assert(sizeof(glm::mat4) == 16 * sizeof(float));
+  model_matrices(in, &(*out)[0][0]);
+}
+
+void xform::quad_vertices(const soa_view &in, float *out) {
+  active().quads(in, out, 0);
+}
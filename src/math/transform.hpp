@@ -0,0 +1,49 @@
+#ifndef __TRANSFORM_HPP__
+#define __TRANSFORM_HPP__
+/*
+  bulk 2d transforms over structure-of-arrays input
+
+  every object is translated by (x, y), rotated by rot radians about the z
+  axis, then scaled by (sx, sy), i.e. model = T * R * S, which is the same
+  matrix `glm::translate(glm::rotate(glm::scale(...)))` would produce.
+
+  the kernel is picked once at runtime from the best instruction set the cpu
+  supports (avx2, sse2, scalar).
+*/
+
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+namespace xform {
+  struct soa_view {
+    const float *x;
+    const float *y;
+    const float *sx;
+    const float *sy;
+    const float *rot;
+    std::size_t count;
+  };
+
+  enum class isa_t {
+    scalar,
+    sse2,
+    avx2
+  };
+
+  // 16 floats (one column major glm::mat4) per object
+  void model_matrices(const soa_view &in, float *out);
+  void model_matrices(const soa_view &in, glm::mat4 *out);
+
+  // 8 floats per object: the a, b, c, d corners of the unit rect (see
+  // gl/rect.cpp) as (x, y) pairs, already transformed into world space
+  void quad_vertices(const soa_view &in, float *out);
+
+  isa_t best_isa();
+  isa_t active_isa();
+  // falls back to the best supported isa if the requested one is unavailable
+  void set_isa(const isa_t isa);
+  const char *isa_name(const isa_t isa);
+};
+
+#endif // __TRANSFORM_HPP__
@@ -0,0 +1,170 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scene.hpp"
+
+constexpr std::uint32_t no_slot = 0xffffffff;
+
+void scene::store::reserve(const std::size_t n) {
+  cols.x.reserve(n);
+  cols.y.reserve(n);
+  cols.sx.reserve(n);
+  cols.sy.reserve(n);
+  cols.rot.reserve(n);
+  cols.texture.reserve(n);
+  cols.uv.reserve(n);
+  cols.colour.reserve(n);
+  cols.layer.reserve(n);
+  cols.visible.reserve(n);
+  dense_to_slot.reserve(n);
+  sparse.reserve(n);
+  generations.reserve(n);
+}
+
+void scene::store::clear() {
+  // bump every live generation so outstanding handles become stale
+  for (const auto slot : dense_to_slot) {
+    ++generations[slot];
+    sparse[slot] = free_head;
+    free_head = slot;
+  }
+
+  cols.x.clear();
+  cols.y.clear();
+  cols.sx.clear();
+  cols.sy.clear();
+  cols.rot.clear();
+  cols.texture.clear();
+  cols.uv.clear();
+  cols.colour.clear();
+  cols.layer.clear();
+  cols.visible.clear();
+  dense_to_slot.clear();
+}
+
+scene::handle scene::store::add(const renderable &r) {
+  std::uint32_t slot;
+  if (free_head != no_slot) {
+    slot = free_head;
+    free_head = sparse[slot];
+  } else {
+    slot = sparse.size();
+    sparse.push_back(0);
+    generations.push_back(0);
+  }
+
+  const std::size_t i = size();
+  sparse[slot] = i;
+  dense_to_slot.push_back(slot);
+
+  cols.x.push_back(r.x);
+  cols.y.push_back(r.y);
+  cols.sx.push_back(r.sx);
+  cols.sy.push_back(r.sy);
+  cols.rot.push_back(r.rot);
+  cols.texture.push_back(r.texture);
+  cols.uv.push_back(r.uv);
+  cols.colour.push_back(r.colour);
+  cols.layer.push_back(r.layer);
+  cols.visible.push_back(r.visible);
+
+  return {slot, generations[slot]};
+}
+
+template <typename T>
+static void swap_pop(std::vector<T> &v, const std::size_t i) {
+  v[i] = v.back();
+  v.pop_back();
+}
+
+bool scene::store::remove(const handle h) {
+  if (!valid(h)) { return false; }
+
+  const std::size_t i = sparse[h.index];
+  const std::uint32_t moved = dense_to_slot.back();
+
+  swap_pop(cols.x, i);
+  swap_pop(cols.y, i);
+  swap_pop(cols.sx, i);
+  swap_pop(cols.sy, i);
+  swap_pop(cols.rot, i);
+  swap_pop(cols.texture, i);
+  swap_pop(cols.uv, i);
+  swap_pop(cols.colour, i);
+  swap_pop(cols.layer, i);
+  swap_pop(cols.visible, i);
+  swap_pop(dense_to_slot, i);
+  sparse[moved] = i;
+
+  ++generations[h.index];
+  sparse[h.index] = free_head;
+  free_head = h.index;
+
+  return true;
+}
+
+bool scene::store::valid(const handle h) const {
+  if (h.index >= sparse.size() || generations[h.index] != h.generation) {
+    return false;
+  }
+
+  const std::uint32_t i = sparse[h.index];
+  return i < dense_to_slot.size() && dense_to_slot[i] == h.index;
+}
+
+scene::handle scene::store::handle_at(const std::size_t i) const {
+  const std::uint32_t slot = dense_to_slot[i];
+  return {slot, generations[slot]};
+}
+
+scene::renderable scene::store::get(const handle h) const {
+  const std::size_t i = sparse[h.index];
+  renderable r;
+  r.x = cols.x[i];
+  r.y = cols.y[i];
+  r.sx = cols.sx[i];
+  r.sy = cols.sy[i];
+  r.rot = cols.rot[i];
+  r.texture = cols.texture[i];
+  r.uv = cols.uv[i];
+  r.colour = cols.colour[i];
+  r.layer = cols.layer[i];
+  r.visible = cols.visible[i];
+
+  return r;
+}
+
+void scene::store::set(const handle h, const renderable &r) {
+  write(sparse[h.index], r);
+}
+
+void scene::store::set_position(const handle h, const float x, const float y) {
+  const std::size_t i = sparse[h.index];
+  cols.x[i] = x;
+  cols.y[i] = y;
+}
+
+void scene::store::set_visible(const handle h, const bool v) {
+  cols.visible[sparse[h.index]] = v;
+}
+
+xform::soa_view scene::store::transforms() const {
+  return {
+    cols.x.data(), cols.y.data(), cols.sx.data(), cols.sy.data(),
+    cols.rot.data(), size()
+  };
+}
+
+void scene::store::write(const std::size_t i, const renderable &r) {
+  cols.x[i] = r.x;
+  cols.y[i] = r.y;
+  cols.sx[i] = r.sx;
+  cols.sy[i] = r.sy;
+  cols.rot[i] = r.rot;
+  cols.texture[i] = r.texture;
+  cols.uv[i] = r.uv;
+  cols.colour[i] = r.colour;
+  cols.layer[i] = r.layer;
+  cols.visible[i] = r.visible;
+}
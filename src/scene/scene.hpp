@@ -0,0 +1,99 @@
+#ifndef __SCENE_HPP__
+#define __SCENE_HPP__
+/*
+  structure-of-arrays storage for renderable rects
+
+  every column is densely packed, so systems (transforms, culling, batching)
+  can stream through exactly the fields they need. handles stay valid while
+  the dense index of a renderable changes: removal moves the last element
+  into the hole (swap and pop) and patches the handle table.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../math/transform.hpp"
+
+namespace scene {
+  struct handle {
+    std::uint32_t index = 0xffffffff;
+    std::uint32_t generation = 0;
+  };
+
+  inline bool operator==(const handle &a, const handle &b) {
+    return a.index == b.index && a.generation == b.generation;
+  }
+  inline bool operator!=(const handle &a, const handle &b) {
+    return !(a == b);
+  }
+
+  struct uv_rect {
+    float u0 = 0;
+    float v0 = 0;
+    float u1 = 1;
+    float v1 = 1;
+  };
+
+  struct renderable {
+    float x = 0;
+    float y = 0;
+    float sx = 1;
+    float sy = 1;
+    float rot = 0;
+    std::uint32_t texture = 0; // Texture::id
+    uv_rect uv;
+    std::uint32_t colour = 0xffffffff; // rgba8, r in the lowest byte
+    std::int16_t layer = 0;
+    bool visible = true;
+  };
+
+  struct columns {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> sx;
+    std::vector<float> sy;
+    std::vector<float> rot;
+    std::vector<std::uint32_t> texture;
+    std::vector<uv_rect> uv;
+    std::vector<std::uint32_t> colour;
+    std::vector<std::int16_t> layer;
+    std::vector<std::uint8_t> visible;
+  };
+
+  class store {
+  public:
+    void reserve(const std::size_t n);
+    void clear();
+
+    handle add(const renderable &r);
+    bool remove(const handle h);
+    bool valid(const handle h) const;
+
+    std::size_t size() const { return cols.x.size(); }
+    // dense index of a valid handle; invalidated by any remove
+    std::size_t index_of(const handle h) const { return sparse[h.index]; }
+    handle handle_at(const std::size_t i) const;
+
+    renderable get(const handle h) const;
+    void set(const handle h, const renderable &r);
+    void set_position(const handle h, const float x, const float y);
+    void set_visible(const handle h, const bool v);
+
+    // columns may be modified in place but must not be resized
+    const columns &data() const { return cols; }
+    columns &data() { return cols; }
+    xform::soa_view transforms() const;
+
+  private:
+    void write(const std::size_t i, const renderable &r);
+
+    columns cols;
+    std::vector<std::uint32_t> dense_to_slot;
+    std::vector<std::uint32_t> sparse; // slot -> dense index or next free
+    std::vector<std::uint32_t> generations;
+    std::uint32_t free_head = 0xffffffff;
+  };
+};
+
+#endif // __SCENE_HPP__
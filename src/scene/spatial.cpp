@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "spatial.hpp"
+
+spatial::aabb spatial::rect_bounds(
+  const float x, const float y, const float sx, const float sy,
+  const float rot
+) {
+  if (rot == 0) {
+    return {
+      std::min(x, x + sx), std::min(y, y + sy),
+      std::max(x, x + sx), std::max(y, y + sy)
+    };
+  }
+
+  const float c = std::cos(rot);
+  const float s = std::sin(rot);
+  const float ux = c * sx;
+  const float uy = s * sx;
+  const float vx = -s * sy;
+  const float vy = c * sy;
+
+  return {
+    x + std::min(0.0f, ux) + std::min(0.0f, vx),
+    y + std::min(0.0f, uy) + std::min(0.0f, vy),
+    x + std::max(0.0f, ux) + std::max(0.0f, vx),
+    y + std::max(0.0f, uy) + std::max(0.0f, vy)
+  };
+}
+
+spatial::aabb spatial::view_bounds(
+  const glm::mat4 &projection, const glm::mat4 &view
+) {
+  const glm::mat4 inv = glm::inverse(projection * view);
+  const glm::vec4 a = inv * glm::vec4(-1, -1, 0, 1);
+  const glm::vec4 b = inv * glm::vec4(1, 1, 0, 1);
+
+  return {
+    std::min(a.x, b.x), std::min(a.y, b.y),
+    std::max(a.x, b.x), std::max(a.y, b.y)
+  };
+}
+
+spatial::grid::grid(const aabb &world, const float cell_size)
+  : world(world), inv_cell_size(1 / cell_size) {
+  columns = std::max(1, int(std::ceil((world.x1 - world.x0) / cell_size)));
+  rows = std::max(1, int(std::ceil((world.y1 - world.y0) / cell_size)));
+  cells.resize(std::size_t(columns) * rows);
+}
+
+std::uint32_t spatial::grid::cell_of(const aabb &b) const {
+  const float cx = (b.x0 + b.x1) * 0.5f;
+  const float cy = (b.y0 + b.y1) * 0.5f;
+  const int col = std::clamp(
+    int(std::floor((cx - world.x0) * inv_cell_size)), 0, columns - 1
+  );
+  const int row = std::clamp(
+    int(std::floor((cy - world.y0) * inv_cell_size)), 0, rows - 1
+  );
+
+  return row * columns + col;
+}
+
+void spatial::grid::insert(const scene::handle h, const aabb &b) {
+  if (h.index >= items.size()) {
+    items.resize(h.index + 1);
+  }
+  if (items[h.index].cell != none) {
+    unlink(items[h.index]);
+    --count;
+  }
+
+  const std::uint32_t c = cell_of(b);
+  items[h.index] = {c, std::uint32_t(cells[c].size()), h.generation};
+  cells[c].push_back({b, h.index});
+  ++count;
+
+  max_half_extent = std::max(
+    max_half_extent, std::max(b.x1 - b.x0, b.y1 - b.y0) * 0.5f
+  );
+}
+
+void spatial::grid::update(const scene::handle h, const aabb &b) {
+  if (!contains(h)) {
+    insert(h, b);
+    return;
+  }
+
+  item &it = items[h.index];
+  const std::uint32_t c = cell_of(b);
+  if (c == it.cell) {
+    cells[c][it.slot].bounds = b;
+    max_half_extent = std::max(
+      max_half_extent, std::max(b.x1 - b.x0, b.y1 - b.y0) * 0.5f
+    );
+    return;
+  }
+
+  unlink(it);
+  it.cell = none;
+  --count;
+  insert(h, b);
+}
+
+void spatial::grid::remove(const scene::handle h) {
+  if (!contains(h)) { return; }
+
+  unlink(items[h.index]);
+  items[h.index].cell = none;
+  --count;
+}
+
+bool spatial::grid::contains(const scene::handle h) const {
+  return h.index < items.size() && items[h.index].cell != none
+    && items[h.index].generation == h.generation;
+}
+
+void spatial::grid::clear() {
+  for (auto &c : cells) { c.clear(); }
+  items.clear();
+  count = 0;
+  max_half_extent = 0;
+}
+
+void spatial::grid::unlink(const item &it) {
+  auto &c = cells[it.cell];
+  const entry &moved = c.back();
+
+  items[moved.index].slot = it.slot;
+  c[it.slot] = moved;
+  c.pop_back();
+}
+
+void spatial::grid::query(
+  const aabb &v, std::vector<scene::handle> &out
+) const {
+  const aabb wide = {
+    v.x0 - max_half_extent, v.y0 - max_half_extent,
+    v.x1 + max_half_extent, v.y1 + max_half_extent
+  };
+
+  const int col0 = std::clamp(
+    int(std::floor((wide.x0 - world.x0) * inv_cell_size)), 0, columns - 1
+  );
+  const int col1 = std::clamp(
+    int(std::floor((wide.x1 - world.x0) * inv_cell_size)), 0, columns - 1
+  );
+  const int row0 = std::clamp(
+    int(std::floor((wide.y0 - world.y0) * inv_cell_size)), 0, rows - 1
+  );
+  const int row1 = std::clamp(
+    int(std::floor((wide.y1 - world.y0) * inv_cell_size)), 0, rows - 1
+  );
+
+  for (int row = row0; row <= row1; ++row) {
+    for (int col = col0; col <= col1; ++col) {
+      for (const entry &e : cells[row * columns + col]) {
+        if (overlaps(e.bounds, v)) {
+          out.push_back({e.index, items[e.index].generation});
+        }
+      }
+    }
+  }
+}
+
+void spatial::cull(
+  const scene::store &s, const grid &g, const aabb &v,
+  std::vector<std::uint32_t> &out
+) {
+  static thread_local std::vector<scene::handle> candidates;
+  candidates.clear();
+  g.query(v, candidates);
+
+  const auto &visible = s.data().visible;
+  out.clear();
+  for (const auto h : candidates) {
+    if (!s.valid(h)) { continue; }
+
+    const std::size_t i = s.index_of(h);
+    if (visible[i]) { out.push_back(i); }
+  }
+
+  // ascending dense order keeps the batcher's reads linear
+  std::sort(out.begin(), out.end());
+}
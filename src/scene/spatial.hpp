@@ -0,0 +1,91 @@
+#ifndef __SPATIAL_HPP__
+#define __SPATIAL_HPP__
+/*
+  loose uniform grid over the orthographic world space used by
+  `fullscreen_rect_matrices` (one unit per pixel, y up)
+
+  each object lives in the single cell containing the centre of its bounds,
+  so moving an object touches at most two cells. queries are widened by the
+  largest half extent seen so far, then every candidate is tested exactly.
+  objects outside the world bounds are clamped into the border cells.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "scene.hpp"
+
+namespace spatial {
+  struct aabb {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+  };
+
+  inline bool overlaps(const aabb &a, const aabb &b) {
+    return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+  }
+
+  // bounds of a unit rect transformed the same way as xform::model_matrices
+  aabb rect_bounds(
+    const float x, const float y, const float sx, const float sy,
+    const float rot
+  );
+  // world space region visible through an orthographic projection * view
+  aabb view_bounds(const glm::mat4 &projection, const glm::mat4 &view);
+
+  class grid {
+  public:
+    grid(const aabb &world, const float cell_size);
+
+    void insert(const scene::handle h, const aabb &b);
+    void update(const scene::handle h, const aabb &b);
+    void remove(const scene::handle h);
+    bool contains(const scene::handle h) const;
+    void clear();
+
+    // appends every object whose bounds overlap v
+    void query(const aabb &v, std::vector<scene::handle> &out) const;
+
+    std::size_t size() const { return count; }
+
+  private:
+    struct entry {
+      aabb bounds;
+      std::uint32_t index;
+    };
+
+    struct item {
+      std::uint32_t cell = none;
+      std::uint32_t slot = 0;
+      std::uint32_t generation = 0;
+    };
+
+    static constexpr std::uint32_t none = 0xffffffff;
+
+    std::uint32_t cell_of(const aabb &b) const;
+    void unlink(const item &it);
+
+    aabb world;
+    float inv_cell_size;
+    int columns;
+    int rows;
+    float max_half_extent = 0;
+    std::size_t count = 0;
+
+    std::vector<std::vector<entry>> cells;
+    std::vector<item> items; // indexed by scene::handle::index
+  };
+
+  // dense indices (ascending) of visible renderables overlapping v
+  void cull(
+    const scene::store &s, const grid &g, const aabb &v,
+    std::vector<std::uint32_t> &out
+  );
+};
+
+#endif // __SPATIAL_HPP__
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "spatial.hpp"
+#include "tilemap.hpp"
+
+tilemap::map::map(
+  const int width, const int height, const float tile_size,
+  const glm::vec2 origin
+) :
+  w(std::max(width, 0)), h(std::max(height, 0)),
+  cx((w + chunk_size - 1) / chunk_size), cy((h + chunk_size - 1) / chunk_size),
+  size(tile_size), org(origin), chunks(std::size_t(cx) * cy) {}
+
+tilemap::tile tilemap::map::get(const int x, const int y) const {
+  if (x < 0 || y < 0 || x >= w || y >= h) { return 0; }
+
+  const chunk &c = chunks[(y / chunk_size) * cx + x / chunk_size];
+  return c.tiles[(y % chunk_size) * chunk_size + x % chunk_size];
+}
+
+void tilemap::map::set(const int x, const int y, const tile t) {
+  if (x < 0 || y < 0 || x >= w || y >= h) { return; }
+
+  chunk &c = chunks[(y / chunk_size) * cx + x / chunk_size];
+  tile &old = c.tiles[(y % chunk_size) * chunk_size + x % chunk_size];
+  if (old == t) { return; }
+
+  c.filled += (t != 0) - (old != 0);
+  old = t;
+  ++c.version;
+}
+
+void tilemap::map::fill(
+  const int x0, const int y0, const int x1, const int y1, const tile t
+) {
+  const int tx0 = std::max(x0, 0);
+  const int ty0 = std::max(y0, 0);
+  const int tx1 = std::min(x1, w);
+  const int ty1 = std::min(y1, h);
+
+  // chunk by chunk so each version is bumped once
+  for (int ccy = ty0 / chunk_size; ccy * chunk_size < ty1; ++ccy) {
+    for (int ccx = tx0 / chunk_size; ccx * chunk_size < tx1; ++ccx) {
+      chunk &c = chunks[ccy * cx + ccx];
+      bool changed = false;
+
+      const int ly0 = std::max(ty0 - ccy * chunk_size, 0);
+      const int ly1 = std::min(ty1 - ccy * chunk_size, chunk_size);
+      const int lx0 = std::max(tx0 - ccx * chunk_size, 0);
+      const int lx1 = std::min(tx1 - ccx * chunk_size, chunk_size);
+      for (int ly = ly0; ly < ly1; ++ly) {
+        for (int lx = lx0; lx < lx1; ++lx) {
+          tile &old = c.tiles[ly * chunk_size + lx];
+          if (old == t) { continue; }
+
+          c.filled += (t != 0) - (old != 0);
+          old = t;
+          changed = true;
+        }
+      }
+
+      if (changed) { ++c.version; }
+    }
+  }
+}
+
+spatial::aabb tilemap::map::chunk_bounds(const int x, const int y) const {
+  const float extent = size * chunk_size;
+  const float x0 = org.x + x * extent;
+  const float y0 = org.y + y * extent;
+
+  return {x0, y0, x0 + extent, y0 + extent};
+}
+
+tilemap::chunk_range tilemap::map::visible(const spatial::aabb &view) const {
+  const float inv_extent = 1.0f / (size * chunk_size);
+
+  chunk_range r;
+  r.x0 = std::clamp(int(std::floor((view.x0 - org.x) * inv_extent)), 0, cx);
+  r.y0 = std::clamp(int(std::floor((view.y0 - org.y) * inv_extent)), 0, cy);
+  r.x1 = std::clamp(int(std::floor((view.x1 - org.x) * inv_extent)) + 1, 0, cx);
+  r.y1 = std::clamp(int(std::floor((view.y1 - org.y) * inv_extent)) + 1, 0, cy);
+
+  return r;
+}
+
+void tilemap::build_instances(const chunk &c, float *out) {
+  for (int i = 0; i < chunk_tiles; ++i) {
+    out[i] = float(c.tiles[i]) - 1.0f;
+  }
+}
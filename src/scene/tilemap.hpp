@@ -0,0 +1,86 @@
+#ifndef __TILEMAP_HPP__
+#define __TILEMAP_HPP__
+/*
+  chunked tile maps
+
+  tiles are stored in fixed `chunk_size` square blocks so a chunk is the
+  unit of upload and culling: every chunk carries a version that any change
+  to one of its tiles bumps, and the renderer re-uploads a chunk only when
+  the version it last uploaded is stale. tile (0, 0) sits at `origin`, rows
+  grow upwards like the ortho world space from `fullscreen_rect_matrices`.
+
+  a tile is 0 for empty, otherwise one more than the layer it samples in
+  the tileset texture array.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "spatial.hpp"
+
+namespace tilemap {
+  constexpr int chunk_size = 32;
+  constexpr int chunk_tiles = chunk_size * chunk_size;
+
+  using tile = std::uint16_t;
+
+  struct chunk {
+    tile tiles[chunk_tiles] = {}; // row major
+    std::uint32_t version = 1;
+    std::uint32_t filled = 0; // non-empty tiles
+  };
+
+  // chunk coordinates, [x0, x1) x [y0, y1)
+  struct chunk_range {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+  };
+
+  class map {
+  public:
+    map(const int width, const int height, const float tile_size,
+      const glm::vec2 origin=glm::vec2(0));
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int chunks_x() const { return cx; }
+    int chunks_y() const { return cy; }
+    float tile_size() const { return size; }
+    glm::vec2 origin() const { return org; }
+
+    tile get(const int x, const int y) const;
+    // out of range writes are ignored
+    void set(const int x, const int y, const tile t);
+    // every tile in [x0, x1) x [y0, y1), clamped to the map
+    void fill(const int x0, const int y0, const int x1, const int y1,
+      const tile t);
+
+    const chunk &chunk_at(const int x, const int y) const {
+      return chunks[y * cx + x];
+    }
+    // world space bounds of a chunk
+    spatial::aabb chunk_bounds(const int x, const int y) const;
+    // chunks overlapping `view`, clamped to the map
+    chunk_range visible(const spatial::aabb &view) const;
+
+  private:
+    int w;
+    int h;
+    int cx;
+    int cy;
+    float size;
+    glm::vec2 org;
+    std::vector<chunk> chunks;
+  };
+
+  // one float per tile in row major order: the array layer, or -1 for
+  // empty tiles, which the tilemap shader collapses
+  void build_instances(const chunk &c, float *out);
+};
+
+#endif // __TILEMAP_HPP__
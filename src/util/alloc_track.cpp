@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include <execinfo.h>
+
+#include "alloc_track.hpp"
+
+namespace {
+  // sits right before every tracked block
+  struct alignas(16) header {
+    std::size_t size;
+    std::uint32_t offset; // from the start of the underlying allocation
+    alloc::tag t;
+  };
+  static_assert(sizeof(header) == 16);
+
+  struct alignas(64) counters {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::int64_t> live{0};
+    std::atomic<std::int64_t> peak{0};
+  };
+
+  std::array<counters, std::size_t(alloc::tag::count)> per_tag;
+  counters total;
+
+  thread_local alloc::tag current = alloc::tag::untagged;
+  thread_local bool in_hook = false;
+  thread_local std::int64_t until_sample = alloc::sample_interval;
+
+  constexpr int max_frames = 10;
+  // sample and track, so stacks start at operator new or tracked_malloc
+  constexpr int skipped_frames = 2;
+  constexpr std::size_t max_sites = 1024;
+
+  struct site {
+    void *frames[max_frames];
+    int depth = 0;
+    alloc::tag t = alloc::tag::untagged;
+    std::uint64_t samples = 0;
+    std::uint64_t bytes = 0;
+  };
+
+  // samples are rare, so a lock is fine here
+  std::mutex sites_lock;
+  std::array<site, max_sites> sites;
+  std::uint64_t dropped_samples = 0;
+
+  void raise_peak(std::atomic<std::int64_t> &peak, const std::int64_t live) {
+    std::int64_t p = peak.load(std::memory_order_relaxed);
+    while (live > p && !peak.compare_exchange_weak(
+      p, live, std::memory_order_relaxed
+    )) {}
+  }
+
+  void add(counters &c, const std::size_t n) {
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(n, std::memory_order_relaxed);
+    const std::int64_t live =
+      c.live.fetch_add(n, std::memory_order_relaxed) + std::int64_t(n);
+    raise_peak(c.peak, live);
+  }
+
+  void remove(counters &c, const std::size_t n) {
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.live.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  // a large allocation can cross several intervals, `weight` of them
+  __attribute__((noinline)) void sample(
+    const alloc::tag t, const std::uint64_t weight
+  ) {
+    void *frames[max_frames + skipped_frames];
+    const int depth = backtrace(frames, max_frames + skipped_frames);
+    if (depth <= skipped_frames) { return; }
+
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (int i = skipped_frames; i < depth; ++i) {
+      h = (h ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 0x100000001b3ull;
+    }
+
+    std::lock_guard<std::mutex> lock(sites_lock);
+    for (std::size_t probe = 0; probe < max_sites; ++probe) {
+      site &s = sites[(h + probe) % max_sites];
+      const bool empty = s.depth == 0;
+      if (!empty && (s.depth != depth - skipped_frames || std::memcmp(
+        s.frames, frames + skipped_frames, s.depth * sizeof(void *)
+      ) != 0)) {
+        continue;
+      }
+
+      if (empty) {
+        s.depth = depth - skipped_frames;
+        std::memcpy(
+          s.frames, frames + skipped_frames, s.depth * sizeof(void *)
+        );
+        s.t = t;
+      }
+      ++s.samples;
+      s.bytes += weight * alloc::sample_interval;
+      return;
+    }
+
+    ++dropped_samples;
+  }
+
+  __attribute__((noinline)) void *track(
+    void *raw, const std::size_t n, const std::size_t offset
+  ) {
+    if (raw == nullptr) { return nullptr; }
+
+    auto *user = static_cast<std::byte *>(raw) + offset;
+    header *h = reinterpret_cast<header *>(user) - 1;
+    h->size = n;
+    h->offset = std::uint32_t(offset);
+    h->t = current;
+
+    add(per_tag[std::size_t(h->t)], n);
+    add(total, n);
+
+    until_sample -= std::int64_t(n);
+    if (until_sample <= 0) {
+      const std::uint64_t weight =
+        1 + std::uint64_t(-until_sample) / alloc::sample_interval;
+      until_sample += weight * alloc::sample_interval;
+
+      // backtrace may allocate the first time it is used
+      if (!in_hook) {
+        in_hook = true;
+        sample(h->t, weight);
+        in_hook = false;
+      }
+    }
+
+    return user;
+  }
+
+  header *header_of(void *p) {
+    return reinterpret_cast<header *>(p) - 1;
+  }
+
+  void *raw_of(void *p) {
+    return static_cast<std::byte *>(p) - header_of(p)->offset;
+  }
+
+  void untrack(void *p) {
+    const header *h = header_of(p);
+    remove(per_tag[std::size_t(h->t)], h->size);
+    remove(total, h->size);
+  }
+
+  void *tracked_new(const std::size_t n) {
+    return track(std::malloc(n + sizeof(header)), n, sizeof(header));
+  }
+
+#ifdef ALLOC_TRACK
+  // only operator new asks for alignment
+  void *tracked_new(const std::size_t n, const std::size_t align) {
+    if (align <= sizeof(header)) { return tracked_new(n); }
+
+    // the header takes a whole alignment unit before the block
+    const std::size_t bytes = (n + align + align - 1) / align * align;
+    return track(std::aligned_alloc(align, bytes), n, align);
+  }
+#endif
+
+  void tracked_delete(void *p) {
+    if (p == nullptr) { return; }
+
+    untrack(p);
+    std::free(raw_of(p));
+  }
+};
+
+const char *alloc::tag_name(const tag t) {
+  switch (t) {
+    case tag::untagged: return "untagged";
+    case tag::io: return "io";
+    case tag::paths: return "paths";
+    case tag::images: return "images";
+    case tag::textures: return "textures";
+    case tag::shaders: return "shaders";
+    case tag::text: return "text";
+    case tag::render: return "render";
+    default: return "?";
+  }
+}
+
+alloc::scope::scope(const tag t) : previous(current) {
+  current = t;
+}
+
+alloc::scope::~scope() {
+  current = previous;
+}
+
+void *alloc::tracked_malloc(const std::size_t n) {
+  return tracked_new(n);
+}
+
+void *alloc::tracked_realloc(void *p, const std::size_t n) {
+  if (p == nullptr) { return tracked_malloc(n); }
+  if (n == 0) {
+    tracked_free(p);
+    return nullptr;
+  }
+
+  const tag t = header_of(p)->t;
+  const std::size_t size = header_of(p)->size;
+  void *raw = std::realloc(raw_of(p), n + sizeof(header));
+  // the old block is still valid and still counted
+  if (raw == nullptr) { return nullptr; }
+
+  remove(per_tag[std::size_t(t)], size);
+  remove(total, size);
+  const tag saved = current;
+  current = t;
+  void *q = track(raw, n, sizeof(header));
+  current = saved;
+  return q;
+}
+
+void alloc::tracked_free(void *p) {
+  tracked_delete(p);
+}
+
+alloc::tag_stats alloc::stats(const tag t) {
+  const counters &c = per_tag[std::size_t(t)];
+
+  tag_stats s;
+  s.allocations = c.allocations.load(std::memory_order_relaxed);
+  s.frees = c.frees.load(std::memory_order_relaxed);
+  s.bytes = c.bytes.load(std::memory_order_relaxed);
+  s.live = c.live.load(std::memory_order_relaxed);
+  s.peak = c.peak.load(std::memory_order_relaxed);
+  return s;
+}
+
+void alloc::report(std::FILE *out, const std::size_t top) {
+  // the report itself allocates (symbol names), keep it out of the samples
+  in_hook = true;
+
+  std::fprintf(out, "allocations by tag\n");
+  std::fprintf(
+    out, "  %-10s %12s %12s %14s %12s %12s\n",
+    "tag", "allocations", "frees", "bytes", "live", "peak live"
+  );
+  for (std::size_t i = 0; i < std::size_t(tag::count); ++i) {
+    const tag_stats s = stats(tag(i));
+    if (s.allocations == 0) { continue; }
+
+    std::fprintf(
+      out, "  %-10s %12llu %12llu %14llu %12lld %12lld\n", tag_name(tag(i)),
+      (unsigned long long)s.allocations, (unsigned long long)s.frees,
+      (unsigned long long)s.bytes, (long long)s.live, (long long)s.peak
+    );
+  }
+  std::fprintf(
+    out, "  %-10s %12llu %12llu %14llu %12lld %12lld\n", "total",
+    (unsigned long long)total.allocations.load(),
+    (unsigned long long)total.frees.load(),
+    (unsigned long long)total.bytes.load(),
+    (long long)total.live.load(), (long long)total.peak.load()
+  );
+
+  std::lock_guard<std::mutex> lock(sites_lock);
+  std::array<const site *, max_sites> sorted;
+  std::size_t n = 0;
+  for (const site &s : sites) {
+    if (s.depth > 0) { sorted[n++] = &s; }
+  }
+  std::sort(sorted.begin(), sorted.begin() + n, [](auto a, auto b) {
+    return a->bytes > b->bytes;
+  });
+
+  std::fprintf(
+    out, "top call sites, sampled every %zu bytes (%llu samples dropped)\n",
+    sample_interval, (unsigned long long)dropped_samples
+  );
+  for (std::size_t i = 0; i < std::min(n, top); ++i) {
+    const site &s = *sorted[i];
+    std::fprintf(
+      out, "  #%zu ~%llu bytes, %llu samples, %s\n", i + 1,
+      (unsigned long long)s.bytes, (unsigned long long)s.samples,
+      tag_name(s.t)
+    );
+
+    char **symbols = backtrace_symbols(s.frames, s.depth);
+    for (int f = 0; f < s.depth; ++f) {
+      std::fprintf(out, "      %s\n", symbols ? symbols[f] : "?");
+    }
+    std::free(symbols);
+  }
+
+  in_hook = false;
+}
+
+#ifdef ALLOC_TRACK
+void *operator new(std::size_t n) {
+  if (void *p = tracked_new(n)) { return p; }
+  throw std::bad_alloc();
+}
+void *operator new[](std::size_t n) {
+  if (void *p = tracked_new(n)) { return p; }
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t n, std::align_val_t a) {
+  if (void *p = tracked_new(n, std::size_t(a))) { return p; }
+  throw std::bad_alloc();
+}
+void *operator new[](std::size_t n, std::align_val_t a) {
+  if (void *p = tracked_new(n, std::size_t(a))) { return p; }
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+  return tracked_new(n);
+}
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept {
+  return tracked_new(n);
+}
+void *operator new(
+  std::size_t n, std::align_val_t a, const std::nothrow_t &
+) noexcept {
+  return tracked_new(n, std::size_t(a));
+}
+void *operator new[](
+  std::size_t n, std::align_val_t a, const std::nothrow_t &
+) noexcept {
+  return tracked_new(n, std::size_t(a));
+}
+
+void operator delete(void *p) noexcept { tracked_delete(p); }
+void operator delete[](void *p) noexcept { tracked_delete(p); }
+void operator delete(void *p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete[](void *p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete(void *p, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  tracked_delete(p);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  tracked_delete(p);
+}
+#endif
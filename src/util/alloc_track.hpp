@@ -0,0 +1,79 @@
+#ifndef __ALLOC_TRACK_HPP__
+#define __ALLOC_TRACK_HPP__
+/*
+  allocation tracking, built in with `make ALLOC_TRACK=1`
+
+  global operator new/delete and stb_image's STBI_MALLOC/REALLOC/FREE are
+  replaced by versions that prefix every block with a small header (its
+  size and tag) and keep per-tag counts, bytes and peaks in atomics.
+  code marks what it allocates for with a scope, innermost wins:
+
+    ALLOC_SCOPE(textures);
+
+  call sites are sampled by bytes: roughly every `sample_interval` bytes a
+  thread allocates, the allocation's stack is recorded and weighted by the
+  interval, so the top sites by sampled bytes approximate where memory
+  goes without walking the stack on every allocation. `report` prints the
+  totals and the top sites; link with -rdynamic for symbol names.
+
+  without ALLOC_TRACK the scopes compile away and nothing is replaced.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace alloc {
+  enum class tag : std::uint8_t {
+    untagged,
+    io,
+    paths,
+    images,
+    textures,
+    shaders,
+    text,
+    render,
+    count
+  };
+
+  const char *tag_name(const tag t);
+
+  constexpr std::size_t sample_interval = 64 * 1024; // bytes
+
+  class scope {
+  public:
+    explicit scope(const tag t);
+    ~scope();
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+  private:
+    tag previous;
+  };
+
+  // for c allocators (stb_image), tagged with the current scope
+  void *tracked_malloc(const std::size_t n);
+  void *tracked_realloc(void *p, const std::size_t n);
+  void tracked_free(void *p);
+
+  struct tag_stats {
+    std::uint64_t allocations = 0;
+    std::uint64_t frees = 0;
+    std::uint64_t bytes = 0; // allocated in total
+    std::int64_t live = 0; // bytes not yet freed
+    std::int64_t peak = 0; // most live bytes at once
+  };
+  tag_stats stats(const tag t);
+
+  // totals per tag, then the `top` call sites by sampled bytes
+  void report(std::FILE *out, const std::size_t top=10);
+};
+
+#ifdef ALLOC_TRACK
+#define ALLOC_SCOPE(t) alloc::scope alloc_scope_(alloc::tag::t)
+#else
+#define ALLOC_SCOPE(t) do {} while (0)
+#endif
+
+#endif // __ALLOC_TRACK_HPP__
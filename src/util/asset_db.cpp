@@ -0,0 +1,474 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "asset_db.hpp"
+#include "file_io.hpp"
+#include "image_cache.hpp"
+
+namespace fs = std::filesystem;
+
+constexpr char magic[4] = {'Q', 'A', 'D', 'B'};
+constexpr std::uint32_t version = 1;
+
+static std::uint64_t hash(const std::string &s) {
+  return imgcache::hash(
+    reinterpret_cast<const std::uint8_t *>(s.data()), s.size()
+  );
+}
+
+// the same file always gets the same key, however it was named
+static std::string key(const fs::path &p) {
+  std::error_code ec;
+  fs::path c = fs::weakly_canonical(p, ec);
+  if (ec) { c = fs::absolute(p, ec).lexically_normal(); }
+
+  return c.string();
+}
+
+static std::uint64_t params_key(const assetdb::rule &r) {
+  return hash(r.tool + '\0' + r.params);
+}
+
+// content hash of `k`, read again only if its size or mtime changed (or
+// `force`, for files just written, whose mtime may not have moved)
+static std::optional<std::uint64_t> content(
+  assetdb::db &d, const std::string &k, const bool force=false
+) {
+  // one stat for both, a warm check of a whole tree is mostly this
+  struct stat st;
+  if (::stat(k.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    if (d.files.erase(k)) { d.changed = true; }
+    return {};
+  }
+
+  assetdb::file_state s;
+  s.size = st.st_size;
+  s.mtime = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+  auto it = d.files.find(k);
+  if (!force && it != d.files.end() && it->second.size == s.size &&
+    it->second.mtime == s.mtime) {
+    return it->second.content;
+  }
+
+  std::string data;
+  if (!fio::read(k, data)) { return {}; }
+  ++d.hashed;
+
+  s.content = hash(data);
+  d.files[k] = s;
+  d.changed = true;
+
+  return s.content;
+}
+
+/*
+  state file
+*/
+static void put(std::string &out, const void *v, const std::size_t size) {
+  out.append(static_cast<const char *>(v), size);
+}
+
+static void put32(std::string &out, const std::uint32_t v) {
+  put(out, &v, sizeof(v));
+}
+
+static void put64(std::string &out, const std::uint64_t v) {
+  put(out, &v, sizeof(v));
+}
+
+static void put_str(std::string &out, const std::string &s) {
+  put32(out, s.size());
+  out += s;
+}
+
+namespace {
+  // reads fields in order, `ok` goes false at the first one past the end
+  struct reader {
+    const std::string &data;
+    std::size_t at = 0;
+    bool ok = true;
+
+    void get(void *v, const std::size_t size) {
+      if (!ok || data.size() - at < size) {
+        ok = false;
+        std::memset(v, 0, size);
+        return;
+      }
+
+      std::memcpy(v, data.data() + at, size);
+      at += size;
+    }
+
+    std::uint32_t get32() {
+      std::uint32_t v;
+      get(&v, sizeof(v));
+      return v;
+    }
+
+    std::uint64_t get64() {
+      std::uint64_t v;
+      get(&v, sizeof(v));
+      return v;
+    }
+
+    std::string get_str() {
+      const std::uint32_t size = get32();
+      if (!ok || data.size() - at < size) {
+        ok = false;
+        return {};
+      }
+
+      std::string s = data.substr(at, size);
+      at += size;
+      return s;
+    }
+  };
+};
+
+static bool load(assetdb::db &d, const std::string &data) {
+  reader r{data};
+  char m[4];
+  r.get(m, sizeof(m));
+  if (!r.ok || std::memcmp(m, magic, sizeof(magic)) != 0 ||
+    r.get32() != version) {
+    return false;
+  }
+
+  const std::uint32_t files = r.get32();
+  for (std::uint32_t i = 0; i < files && r.ok; ++i) {
+    std::string p = r.get_str();
+    assetdb::file_state s;
+    s.size = r.get64();
+    s.mtime = std::int64_t(r.get64());
+    s.content = r.get64();
+    d.files.emplace(std::move(p), s);
+  }
+
+  auto get_files = [&r](
+    std::vector<std::string> &paths, std::vector<std::uint64_t> &contents
+  ) {
+    const std::uint32_t n = r.get32();
+    for (std::uint32_t i = 0; i < n && r.ok; ++i) {
+      paths.push_back(r.get_str());
+      contents.push_back(r.get64());
+    }
+  };
+
+  const std::uint32_t records = r.get32();
+  for (std::uint32_t i = 0; i < records && r.ok; ++i) {
+    assetdb::record rec;
+    rec.params = r.get64();
+    get_files(rec.inputs, rec.input_contents);
+    get_files(rec.outputs, rec.output_contents);
+    if (r.ok && !rec.outputs.empty()) {
+      d.records.emplace(rec.outputs[0], std::move(rec));
+    }
+  }
+
+  return r.ok && r.at == data.size();
+}
+
+std::optional<assetdb::db> assetdb::open(const path &file) {
+  std::error_code ec;
+  fs::create_directories(file.parent_path(), ec);
+  if (ec || !fs::is_directory(file.parent_path(), ec)) { return {}; }
+
+  db d;
+  d.file = file;
+
+  // a missing, old or damaged state file just means building everything
+  std::string data;
+  if (fio::read(file, data) && !load(d, data)) {
+    d.files.clear();
+    d.records.clear();
+  }
+
+  return d;
+}
+
+bool assetdb::save(db &d) {
+  if (!d.changed) { return true; }
+
+  std::string out;
+  put(out, magic, sizeof(magic));
+  put32(out, version);
+
+  put32(out, d.files.size());
+  for (const auto &[p, s] : d.files) {
+    put_str(out, p);
+    put64(out, s.size);
+    put64(out, std::uint64_t(s.mtime));
+    put64(out, s.content);
+  }
+
+  put32(out, d.records.size());
+  for (const auto &[first, rec] : d.records) {
+    put64(out, rec.params);
+    put32(out, rec.inputs.size());
+    for (std::size_t i = 0; i < rec.inputs.size(); ++i) {
+      put_str(out, rec.inputs[i]);
+      put64(out, rec.input_contents[i]);
+    }
+    put32(out, rec.outputs.size());
+    for (std::size_t i = 0; i < rec.outputs.size(); ++i) {
+      put_str(out, rec.outputs[i]);
+      put64(out, rec.output_contents[i]);
+    }
+  }
+
+  // written next to the state and renamed, so a crash keeps the old one.
+  // the temporary name is unique, so two saves never write into one file
+  const fs::path tmp = fio::temp_path(d.file);
+  const bool written = fio::write(tmp, out, true);
+
+  std::error_code rename_error;
+  if (written) { fs::rename(tmp, d.file, rename_error); }
+  if (!written || rename_error) {
+    std::error_code ec;
+    fs::remove(tmp, ec);
+    return false;
+  }
+
+  d.changed = false;
+  return true;
+}
+
+void assetdb::clear(db &d) {
+  d.files.clear();
+  d.records.clear();
+  d.changed = true;
+}
+
+bool assetdb::add(db &d, rule r) {
+  if (r.outputs.empty()) { return false; }
+
+  for (auto &p : r.inputs) { p = key(p); }
+  for (auto &p : r.outputs) {
+    p = key(p);
+    if (d.producers.count(p.string())) { return false; }
+  }
+
+  for (const auto &p : r.outputs) {
+    d.producers.emplace(p.string(), d.rules.size());
+  }
+  d.rules.push_back(std::move(r));
+
+  return true;
+}
+
+/*
+  building
+*/
+namespace {
+  enum class state_t : std::uint8_t {
+    pending,
+    visiting,
+    done,
+    failed
+  };
+
+  // one pass over the rules, each runs at most once
+  struct builder {
+    assetdb::db &d;
+    std::vector<state_t> states;
+
+    explicit builder(assetdb::db &d)
+      : d(d), states(d.rules.size(), state_t::pending) {}
+
+    bool make(const std::string &k) {
+      auto it = d.producers.find(k);
+      if (it == d.producers.end()) { return content(d, k).has_value(); }
+
+      return run(it->second);
+    }
+
+    bool run(const std::size_t i) {
+      // a rule found again while its inputs are being made is a cycle
+      if (states[i] == state_t::visiting) { return false; }
+      if (states[i] != state_t::pending) { return states[i] == state_t::done; }
+      states[i] = state_t::visiting;
+
+      const bool ok = update(d.rules[i]);
+      states[i] = ok ? state_t::done : state_t::failed;
+      if (!ok) { ++d.failed; }
+
+      return ok;
+    }
+
+    bool update(const assetdb::rule &r) {
+      assetdb::record next;
+      next.params = params_key(r);
+      for (const auto &p : r.inputs) {
+        const std::string k = p.string();
+        if (!make(k)) { return false; }
+
+        const auto c = content(d, k);
+        if (!c) { return false; }
+        next.inputs.push_back(k);
+        next.input_contents.push_back(*c);
+      }
+      for (const auto &p : r.outputs) { next.outputs.push_back(p.string()); }
+
+      auto it = d.records.find(next.outputs[0]);
+      bool dirty = it == d.records.end() ||
+        it->second.params != next.params ||
+        it->second.inputs != next.inputs ||
+        it->second.input_contents != next.input_contents ||
+        it->second.outputs != next.outputs;
+
+      // an output deleted or edited by hand is rebuilt too
+      for (std::size_t j = 0; !dirty && j < next.outputs.size(); ++j) {
+        const auto c = content(d, next.outputs[j]);
+        dirty = !c || *c != it->second.output_contents[j];
+      }
+
+      if (!dirty) {
+        ++d.skipped;
+        return true;
+      }
+
+      std::error_code ec;
+      for (const auto &p : r.outputs) {
+        fs::create_directories(p.parent_path(), ec);
+      }
+      if (!r.build || !r.build(r.inputs, r.outputs)) { return false; }
+
+      for (const auto &k : next.outputs) {
+        const auto c = content(d, k, true);
+        if (!c) { return false; }
+        next.output_contents.push_back(*c);
+      }
+
+      d.records[next.outputs[0]] = std::move(next);
+      d.changed = true;
+      ++d.built;
+
+      return true;
+    }
+  };
+};
+
+bool assetdb::build(db &d, const path &target) {
+  builder b(d);
+  return b.make(key(target));
+}
+
+bool assetdb::build_all(db &d) {
+  builder b(d);
+  bool ok = true;
+  for (std::size_t i = 0; i < d.rules.size(); ++i) {
+    if (!b.run(i)) { ok = false; }
+  }
+
+  return ok;
+}
+
+/*
+  queries
+*/
+// the record `k` is an output of, if any
+static const assetdb::record *find_record(
+  const assetdb::db &d, const std::string &k
+) {
+  auto it = d.records.find(k);
+  if (it != d.records.end()) { return &it->second; }
+
+  // only outputs after the first of a rule get here
+  for (const auto &[first, rec] : d.records) {
+    for (const auto &o : rec.outputs) {
+      if (o == k) { return &rec; }
+    }
+  }
+
+  return nullptr;
+}
+
+static bool current(
+  assetdb::db &d, const std::string &k, std::unordered_set<std::string> &seen
+) {
+  const assetdb::record *rec = find_record(d, k);
+  if (rec == nullptr) { return true; }
+  if (!seen.insert(rec->outputs[0]).second) { return true; }
+
+  for (std::size_t i = 0; i < rec->inputs.size(); ++i) {
+    if (!current(d, rec->inputs[i], seen)) { return false; }
+
+    const auto c = content(d, rec->inputs[i]);
+    if (!c || *c != rec->input_contents[i]) { return false; }
+  }
+  for (std::size_t i = 0; i < rec->outputs.size(); ++i) {
+    const auto c = content(d, rec->outputs[i]);
+    if (!c || *c != rec->output_contents[i]) { return false; }
+  }
+
+  return true;
+}
+
+bool assetdb::up_to_date(db &d, const path &target) {
+  std::unordered_set<std::string> seen;
+  return current(d, key(target), seen);
+}
+
+std::vector<assetdb::path> assetdb::dependents(
+  const db &d, const path &source
+) {
+  // output -> inputs, from the last builds and then the rules as they are
+  // now, which win where the two disagree
+  std::unordered_map<std::string, std::vector<std::string>> made_from;
+  for (const auto &[first, rec] : d.records) {
+    for (const auto &o : rec.outputs) { made_from[o] = rec.inputs; }
+  }
+  for (const auto &r : d.rules) {
+    std::vector<std::string> inputs;
+    for (const auto &p : r.inputs) { inputs.push_back(p.string()); }
+    for (const auto &o : r.outputs) { made_from[o.string()] = inputs; }
+  }
+
+  std::unordered_map<std::string, std::vector<std::string>> used_by;
+  for (const auto &[o, inputs] : made_from) {
+    for (const auto &i : inputs) { used_by[i].push_back(o); }
+  }
+
+  // everything downstream of `source`
+  std::unordered_set<std::string> affected;
+  std::vector<std::string> stack{key(source)};
+  while (!stack.empty()) {
+    const std::string k = std::move(stack.back());
+    stack.pop_back();
+
+    auto it = used_by.find(k);
+    if (it == used_by.end()) { continue; }
+    for (const auto &o : it->second) {
+      if (affected.insert(o).second) { stack.push_back(o); }
+    }
+  }
+
+  // inputs before the outputs made from them
+  std::vector<path> order;
+  std::unordered_set<std::string> placed;
+  std::function<void(const std::string &)> place = [&](const std::string &k) {
+    if (!affected.count(k) || !placed.insert(k).second) { return; }
+
+    for (const auto &i : made_from[k]) { place(i); }
+    order.emplace_back(k);
+  };
+  std::vector<std::string> keys(affected.begin(), affected.end());
+  std::sort(keys.begin(), keys.end());
+  for (const auto &k : keys) { place(k); }
+
+  return order;
+}
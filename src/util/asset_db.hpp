@@ -0,0 +1,117 @@
+#ifndef __ASSET_DB_HPP__
+#define __ASSET_DB_HPP__
+/*
+  dependency tracking for derived assets, a small build system for data/
+
+  a rule makes one or more output files from input files, which can be
+  sources or other rules' outputs. the db remembers, for every rule it has
+  built, the content hashes of its inputs and outputs and a hash of the
+  rule's tool and parameters; a rule runs again only when one of those
+  changed or an output is gone. outputs are hashed after every build too,
+  so a rebuild that produces the same bytes stops there and its dependents
+  stay as they are.
+
+  file hashes are cached by size and mtime as in imgcache, so a warm check
+  of an unchanged tree only stats each file. paths are compared after
+  canonicalisation. the state is saved to one file, normally under xdg
+  cache home, in native byte order:
+
+    assets.db := "QADB" u32:version u32:files file[files] u32:records
+                 record[records]
+    file := str:path u64:size i64:mtime u64:content
+    record := u64:params u32:inputs (str:path u64:content)[inputs]
+              u32:outputs (str:path u64:content)[outputs]
+    str := u32:length u8[length]
+
+  records outlive the process that registered the rules, so a program that
+  only loads baked files can still ask whether one is stale, without
+  knowing how it was made:
+
+    auto db = assetdb::open(cache_home / "qogl" / "assets.db");
+    if (db && !assetdb::up_to_date(*db, baked)) { load the source instead }
+
+  such a reader should not save: its db holds only what it loaded, and
+  writing that back could drop what a concurrent build has saved since.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace assetdb {
+  using path = std::filesystem::path;
+
+  // writes every output, false if it could not
+  using build_f = std::function<bool(
+    const std::vector<path> &inputs, const std::vector<path> &outputs
+  )>;
+
+  struct rule {
+    std::string tool; // the kind of step, e.g. "texcompress"
+    std::string params; // anything besides the inputs the result depends on
+    std::vector<path> inputs;
+    std::vector<path> outputs;
+    build_f build;
+  };
+
+  struct file_state {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    std::uint64_t content = 0;
+  };
+
+  // what the last successful build of a rule saw
+  struct record {
+    std::uint64_t params = 0; // hash of the tool and parameters
+    std::vector<std::string> inputs;
+    std::vector<std::uint64_t> input_contents;
+    std::vector<std::string> outputs;
+    std::vector<std::uint64_t> output_contents;
+  };
+
+  struct db {
+    path file;
+    std::vector<rule> rules;
+    std::unordered_map<std::string, std::size_t> producers; // output -> rule
+    std::unordered_map<std::string, file_state> files;
+    std::unordered_map<std::string, record> records; // by first output
+    bool changed = false; // since the last save
+
+    std::uint64_t hashed = 0; // files read to hash them
+    std::uint64_t built = 0;
+    std::uint64_t skipped = 0; // rules found up to date
+    std::uint64_t failed = 0;
+  };
+
+  // loads the state saved in `file` if there is any, creating its
+  // directory. returns nothing if that fails
+  std::optional<db> open(const path &file);
+  // writes the state if it changed
+  bool save(db &d);
+  // forgets every file and record
+  void clear(db &d);
+
+  // false if one of its outputs already has a rule
+  bool add(db &d, rule r);
+
+  // brings `target` and everything it is built from up to date. true if
+  // it is, a source only has to exist
+  bool build(db &d, const path &target);
+  // every rule, false if any failed
+  bool build_all(db &d);
+
+  // false when a recorded build of `target`, or of anything it is built
+  // from, no longer matches its inputs or outputs. needs no rules; a file
+  // the db never built is taken as it is
+  bool up_to_date(db &d, const path &target);
+  // outputs made from `source`, directly or through other outputs, in
+  // build order. what a hot reload of `source` has to rebuild
+  std::vector<path> dependents(const db &d, const path &source);
+};
+
+#endif // __ASSET_DB_HPP__
@@ -0,0 +1,71 @@
+#ifdef COROUTINES
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "async.hpp"
+
+namespace {
+  // threads that block on file reads, kept off the job system's workers
+  class io_pool {
+  public:
+    io_pool() {
+      for (int i = 0; i < async::io_threads; ++i) {
+        threads.emplace_back([this] { work(); });
+      }
+    }
+
+    ~io_pool() {
+      {
+        std::lock_guard<std::mutex> lock(queue_lock);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (auto &t : threads) { t.join(); }
+    }
+
+    void push(std::coroutine_handle<> h) {
+      {
+        std::lock_guard<std::mutex> lock(queue_lock);
+        queue.push_back(h);
+      }
+      wake.notify_one();
+    }
+
+  private:
+    void work() {
+      for (;;) {
+        std::coroutine_handle<> h;
+        {
+          std::unique_lock<std::mutex> lock(queue_lock);
+          wake.wait(lock, [this] { return stopping || !queue.empty(); });
+          if (queue.empty()) { return; }
+
+          h = queue.front();
+          queue.pop_front();
+        }
+
+        h.resume();
+      }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex queue_lock;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> queue;
+    bool stopping = false;
+  };
+
+  io_pool &pool() {
+    static io_pool p;
+    return p;
+  }
+};
+
+void async::detail::submit_io(std::coroutine_handle<> h) {
+  pool().push(h);
+}
+#endif
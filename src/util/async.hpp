@@ -0,0 +1,302 @@
+#ifndef __ASYNC_HPP__
+#define __ASYNC_HPP__
+/*
+  c++20 coroutine tasks over the job system, built with `make COROUTINES=1`
+
+  a task<T> is a lazy coroutine: nothing runs until it is awaited, and
+  awaiting it runs it to completion before the awaiter resumes with its
+  value. where a task runs is chosen by awaiting an executor:
+
+    co_await async::io(); // blocking file reads, a few dedicated threads
+    co_await async::workers(); // cpu work, jobs::global()'s workers
+    co_await async::main_thread(); // gl calls, drained by the main loop
+
+  so one function can read, decode and upload without blocking any of the
+  three on the others. `when_all` starts several tasks at once and resumes
+  when the last finishes, which is how independent loads overlap.
+  `sync_wait` blocks the main thread on a task, waking to run main thread
+  jobs as they are queued (or the task could never finish); `detach` starts
+  one and forgets it.
+
+  coroutine parameters live in the coroutine frame, so pass by value:
+  a reference parameter may be gone by the time the task resumes.
+  exceptions are not supported, a throwing task terminates.
+*/
+
+#ifdef COROUTINES
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "jobs.hpp"
+
+namespace async {
+  constexpr int io_threads = 2;
+
+  namespace detail {
+    // resumes whatever awaited the finished coroutine
+    struct final_awaiter {
+      bool await_ready() const noexcept { return false; }
+      template <typename P>
+      std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<P> h
+      ) noexcept {
+        std::coroutine_handle<> c = h.promise().continuation;
+        return c ? c : std::noop_coroutine();
+      }
+      void await_resume() const noexcept {}
+    };
+
+    void submit_io(std::coroutine_handle<> h);
+  };
+
+  template <typename T>
+  class task {
+  public:
+    struct promise_type {
+      std::optional<T> value;
+      std::coroutine_handle<> continuation;
+
+      task get_return_object() {
+        return task(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      detail::final_awaiter final_suspend() const noexcept { return {}; }
+      template <typename U>
+      void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+      void unhandled_exception() const { std::terminate(); }
+    };
+
+    task(task &&other) noexcept : h(std::exchange(other.h, {})) {}
+    task &operator=(task &&other) noexcept {
+      if (this != &other) {
+        if (h) { h.destroy(); }
+        h = std::exchange(other.h, {});
+      }
+
+      return *this;
+    }
+    ~task() {
+      if (h) { h.destroy(); }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> awaiter
+    ) noexcept {
+      h.promise().continuation = awaiter;
+      return h;
+    }
+    T await_resume() { return std::move(*h.promise().value); }
+
+  private:
+    explicit task(std::coroutine_handle<promise_type> h) : h(h) {}
+
+    std::coroutine_handle<promise_type> h;
+  };
+
+  /*
+    executors
+  */
+  struct io_executor {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const {
+      detail::submit_io(h);
+    }
+    void await_resume() const noexcept {}
+  };
+
+  struct worker_executor {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const {
+      jobs::global().run([h] { h.resume(); });
+    }
+    void await_resume() const noexcept {}
+  };
+
+  struct main_thread_executor {
+    // no hop when already there
+    bool await_ready() const { return jobs::global().on_main_thread(); }
+    void await_suspend(std::coroutine_handle<> h) const {
+      jobs::global().run(
+        [h] { h.resume(); }, nullptr, jobs::affinity_t::main_thread
+      );
+    }
+    void await_resume() const noexcept {}
+  };
+
+  inline io_executor io() { return {}; }
+  inline worker_executor workers() { return {}; }
+  inline main_thread_executor main_thread() { return {}; }
+
+  namespace detail {
+    struct latch {
+      std::atomic<std::size_t> remaining{0};
+      std::coroutine_handle<> waiter;
+    };
+
+    // runs one task of a when_all and counts down when it is done
+    class counted {
+    public:
+      struct promise_type {
+        latch *l = nullptr;
+
+        struct count_down {
+          bool await_ready() const noexcept { return false; }
+          std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<promise_type> h
+          ) noexcept {
+            latch &l = *h.promise().l;
+            return l.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1
+              ? l.waiter : std::noop_coroutine();
+          }
+          void await_resume() const noexcept {}
+        };
+
+        counted get_return_object() {
+          return counted(
+            std::coroutine_handle<promise_type>::from_promise(*this)
+          );
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        count_down final_suspend() const noexcept { return {}; }
+        void return_void() const {}
+        void unhandled_exception() const { std::terminate(); }
+      };
+
+      counted(counted &&other) noexcept : h(std::exchange(other.h, {})) {}
+      counted(const counted &) = delete;
+      ~counted() {
+        if (h) { h.destroy(); }
+      }
+
+      void start(latch &l) {
+        h.promise().l = &l;
+        h.resume();
+      }
+
+    private:
+      explicit counted(std::coroutine_handle<promise_type> h) : h(h) {}
+
+      std::coroutine_handle<promise_type> h;
+    };
+
+    template <typename T>
+    counted store(task<T> t, std::optional<T> &out) {
+      out.emplace(co_await t);
+    }
+
+    // starts every part and suspends until the last one is done. the
+    // latch starts one higher so nothing resumes the waiter before all
+    // parts are started
+    struct start_all {
+      std::vector<counted> &parts;
+      latch l;
+
+      bool await_ready() const noexcept { return parts.empty(); }
+      bool await_suspend(std::coroutine_handle<> waiter) {
+        l.remaining.store(parts.size() + 1, std::memory_order_relaxed);
+        l.waiter = waiter;
+        for (auto &p : parts) { p.start(l); }
+
+        return l.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+      }
+      void await_resume() const noexcept {}
+    };
+
+    // fire and forget, frees itself when done
+    struct detached {
+      struct promise_type {
+        detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const {}
+        void unhandled_exception() const { std::terminate(); }
+      };
+    };
+
+    template <typename T>
+    detached run(task<T> t) {
+      co_await t;
+    }
+
+    template <typename T>
+    detached signal(
+      task<T> &t, std::optional<T> &out, std::atomic<bool> &done
+    ) {
+      out.emplace(co_await t);
+      done.store(true, std::memory_order_release);
+      // wakes sync_wait, wherever the task finished
+      jobs::global().run([] {}, nullptr, jobs::affinity_t::main_thread);
+    }
+  };
+
+  template <typename... Ts>
+  task<std::tuple<Ts...>> when_all(task<Ts>... ts) {
+    std::tuple<std::optional<Ts>...> results;
+    std::vector<detail::counted> parts;
+    parts.reserve(sizeof...(Ts));
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (
+        parts.push_back(detail::store(std::move(ts), std::get<I>(results))),
+        ...
+      );
+    }(std::index_sequence_for<Ts...>{});
+
+    co_await detail::start_all{parts, {}};
+
+    co_return std::apply([](auto &...r) {
+      return std::tuple<Ts...>(std::move(*r)...);
+    }, results);
+  }
+
+  template <typename T>
+  task<std::vector<T>> when_all(std::vector<task<T>> ts) {
+    std::vector<std::optional<T>> results(ts.size());
+    std::vector<detail::counted> parts;
+    parts.reserve(ts.size());
+    for (std::size_t i = 0; i < ts.size(); ++i) {
+      parts.push_back(detail::store(std::move(ts[i]), results[i]));
+    }
+
+    co_await detail::start_all{parts, {}};
+
+    std::vector<T> out;
+    out.reserve(results.size());
+    for (auto &r : results) { out.push_back(std::move(*r)); }
+    co_return out;
+  }
+
+  // on the main thread only
+  template <typename T>
+  T sync_wait(task<T> t) {
+    // before the task starts, which may ask for the scheduler from another
+    // thread first and make that its main thread
+    jobs::scheduler &s = jobs::global();
+
+    std::optional<T> result;
+    std::atomic<bool> done{false};
+    detail::signal(t, result, done);
+
+    s.run_main_thread_jobs();
+    while (!done.load(std::memory_order_acquire)) {
+      s.wait_for_main_thread_jobs();
+      s.run_main_thread_jobs();
+    }
+
+    return std::move(*result);
+  }
+
+  template <typename T>
+  void detach(task<T> t) {
+    detail::run(std::move(t));
+  }
+};
+#endif
+
+#endif // __ASYNC_HPP__
@@ -0,0 +1,120 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "counters.hpp"
+
+namespace {
+  using namespace counters;
+
+  struct registry {
+    std::mutex lock;
+    std::deque<counter> counters; // ids stay valid as it grows
+    std::uint64_t frames = 0;
+
+    registry() {
+      push(*this, "gl.draw_calls", kind_t::frame, unit_t::count);
+      push(*this, "gl.state_changes", kind_t::frame, unit_t::count);
+      push(*this, "gl.bytes_streamed", kind_t::frame, unit_t::bytes);
+      push(*this, "gl.texture_uploads", kind_t::frame, unit_t::count);
+    }
+
+    static id push(
+      registry &r, const std::string_view name, const kind_t kind,
+      const unit_t unit
+    ) {
+      counter &c = r.counters.emplace_back();
+      c.name = name;
+      c.kind = kind;
+      c.unit = unit;
+      return id(r.counters.size() - 1);
+    }
+  };
+
+  // constructed on first use, so counters can be added during static
+  // initialisation of any translation unit
+  registry &instance() {
+    static registry r;
+    return r;
+  }
+
+  std::optional<id> find_locked(
+    const registry &r, const std::string_view name
+  ) {
+    for (std::size_t i = 0; i < r.counters.size(); ++i) {
+      if (r.counters[i].name == name) { return id(i); }
+    }
+
+    return std::nullopt;
+  }
+};
+
+counters::id counters::add(
+  const std::string_view name, const kind_t kind, const unit_t unit
+) {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  if (auto c = find_locked(r, name)) { return *c; }
+
+  return registry::push(r, name, kind, unit);
+}
+
+std::optional<counters::id> counters::find(const std::string_view name) {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  return find_locked(r, name);
+}
+
+void counters::count(const id c, const std::uint64_t n) {
+  instance().counters[c].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+void counters::set(const id c, const std::uint64_t value) {
+  instance().counters[c].value.store(value, std::memory_order_relaxed);
+}
+
+void counters::end_frame() {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  const std::size_t slot = r.frames % history_length;
+
+  // a frame counter is taken and reset in one step, so a count landing
+  // meanwhile goes into the next frame instead of being lost
+  for (counter &c : r.counters) {
+    c.history[slot] = c.kind == kind_t::frame
+      ? c.value.exchange(0, std::memory_order_relaxed)
+      : c.value.load(std::memory_order_relaxed);
+  }
+  ++r.frames;
+}
+
+std::uint64_t counters::frames() {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  return r.frames;
+}
+
+std::size_t counters::size() {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  return r.counters.size();
+}
+
+const counters::counter &counters::get(const id c) {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  return r.counters[c];
+}
+
+std::uint64_t counters::last(const id c) {
+  registry &r = instance();
+  std::lock_guard<std::mutex> guard(r.lock);
+  if (r.frames == 0) { return 0; }
+
+  return r.counters[c].history[(r.frames - 1) % history_length];
+}
@@ -0,0 +1,82 @@
+#ifndef __COUNTERS_HPP__
+#define __COUNTERS_HPP__
+/*
+  named per-frame counters and gauges
+
+  subsystems register a counter once, by name, and bump it as they work:
+
+    static const counters::id uploads = counters::add("gl.texture_uploads");
+    counters::count(uploads);
+
+  registering a name twice returns the same id, so several subsystems can
+  publish to one counter; the ones most of the renderer shares are already
+  registered under the ids in `counters::engine`. `end_frame` closes the
+  frame: each value goes into a history ring for graphs and frame counters
+  restart at zero, while gauges keep their level until set again.
+
+  `count` and `set` are relaxed atomic updates, so jobs can count from any
+  thread at the cost of an uncontended add. registering and `end_frame`
+  lock the registry; counters are registered at startup, before other
+  threads count. `get` and `last` are for the thread calling `end_frame`.
+*/
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace counters {
+  using id = std::uint32_t;
+
+  constexpr std::size_t history_length = 240; // frames
+
+  enum class kind_t {
+    frame, // work done this frame, e.g. draw calls
+    gauge // a level, e.g. bytes resident
+  };
+
+  enum class unit_t {
+    count,
+    bytes,
+    microseconds
+  };
+
+  struct counter {
+    std::string name;
+    kind_t kind;
+    unit_t unit;
+    std::atomic<std::uint64_t> value{0}; // the frame in progress
+    std::array<std::uint64_t, history_length> history{};
+  };
+
+  // registered before anything else, in this order
+  namespace engine {
+    constexpr id draw_calls = 0; // "gl.draw_calls"
+    constexpr id state_changes = 1; // "gl.state_changes", binds of any kind
+    constexpr id bytes_streamed = 2; // "gl.bytes_streamed"
+    constexpr id texture_uploads = 3; // "gl.texture_uploads"
+  };
+
+  id add(
+    const std::string_view name, const kind_t kind=kind_t::frame,
+    const unit_t unit=unit_t::count
+  );
+  std::optional<id> find(const std::string_view name);
+
+  void count(const id c, const std::uint64_t n=1);
+  void set(const id c, const std::uint64_t value);
+
+  void end_frame();
+  // completed frames, history[(frames() - 1) % history_length] is the last
+  std::uint64_t frames();
+
+  std::size_t size();
+  const counter &get(const id c);
+  // the value at the end of the last completed frame
+  std::uint64_t last(const id c);
+};
+
+#endif // __COUNTERS_HPP__
@@ -1,5 +1,6 @@
 #ifndef __ERROR_HPP__
 #define __ERROR_HPP__
+#include <type_traits>
 
 template <typename E>
 constexpr auto to_underlying(E e) noexcept {
@@ -9,6 +10,10 @@ constexpr auto to_underlying(E e) noexcept {
 enum class error_code_t {
   not_enough_args = 1,
   too_many_args = 2,
+  file_read_failed = 3,
+  file_write_failed = 4,
+  bad_arg = 5,
+  duplicate_output = 6,
   window_failed = 16,
   glad_failed = 17,
 
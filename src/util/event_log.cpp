@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "event_log.hpp"
+
+static std::unique_ptr<evlog::writer> global_writer;
+
+evlog::writer::writer(const std::filesystem::path &p)
+  : ofs(p, std::ios::out | std::ios::binary | std::ios::trunc),
+    start(std::chrono::steady_clock::now()) {
+  buffer.reserve(1 << 17);
+
+  const auto wall = std::chrono::system_clock::now().time_since_epoch();
+
+  buffer.insert(buffer.end(), magic, magic + sizeof(magic));
+  put(version);
+  put(static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count()
+  ));
+}
+
+evlog::writer::~writer() {
+  write_buffer();
+}
+
+void evlog::writer::flush() {
+  std::lock_guard<std::mutex> guard(lock);
+  write_buffer();
+}
+
+void evlog::writer::write_buffer() {
+  if (ofs && !buffer.empty()) {
+    ofs.write(buffer.data(), buffer.size());
+    ofs.flush();
+  }
+
+  buffer.clear();
+}
+
+std::uint16_t evlog::writer::intern(const char *fmt) {
+  auto it = string_ids.find(fmt);
+  if (it != string_ids.end()) {
+    return it->second;
+  }
+
+  const std::uint16_t id = string_ids.size();
+  const std::uint16_t len = std::min<std::size_t>(std::strlen(fmt), 0xffff);
+  string_ids.emplace(fmt, id);
+
+  put(record_t::string_def);
+  put(id);
+  put(len);
+  buffer.insert(buffer.end(), fmt, fmt + len);
+
+  return id;
+}
+
+void evlog::writer::put_arg(const std::int64_t v) {
+  put(arg_t::i64);
+  put(v);
+}
+
+void evlog::writer::put_arg(const std::uint64_t v) {
+  put(arg_t::u64);
+  put(v);
+}
+
+void evlog::writer::put_arg(const double v) {
+  put(arg_t::f64);
+  put(v);
+}
+
+void evlog::writer::put_arg(const std::string_view v) {
+  const std::uint16_t len = std::min<std::size_t>(v.size(), 0xffff);
+
+  put(arg_t::str);
+  put(len);
+  buffer.insert(buffer.end(), v.data(), v.data() + len);
+}
+
+void evlog::open(const std::filesystem::path &p) {
+  global_writer = std::make_unique<writer>(p);
+}
+
+void evlog::close() {
+  global_writer.reset();
+}
+
+evlog::writer *evlog::get() {
+  return global_writer.get();
+}
+
+namespace {
+  struct cursor {
+    const std::string &data;
+    std::size_t pos = 0;
+
+    template <typename T>
+    bool get(T &t) {
+      if (pos + sizeof(T) > data.size()) { return false; }
+      std::memcpy(&t, &data[pos], sizeof(T));
+      pos += sizeof(T);
+      return true;
+    }
+
+    bool get(std::string &s, const std::size_t len) {
+      if (pos + len > data.size()) { return false; }
+      s.assign(&data[pos], len);
+      pos += len;
+      return true;
+    }
+  };
+};
+
+std::optional<evlog::log> evlog::read(const std::filesystem::path &p) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  if (!ifs) { return {}; }
+
+  const std::string data(
+    (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+  );
+  cursor c{data};
+
+  char m[sizeof(magic)];
+  std::uint32_t v;
+  log l;
+  for (char &ch : m) {
+    if (!c.get(ch)) { return {}; }
+  }
+  if (std::memcmp(m, magic, sizeof(magic)) != 0) { return {}; }
+  if (!c.get(v) || v != version) { return {}; }
+  if (!c.get(l.wall_clock_ns)) { return {}; }
+
+  record_t kind;
+  while (c.get(kind)) {
+    if (kind == record_t::string_def) {
+      std::uint16_t id;
+      std::uint16_t len;
+      std::string s;
+      if (!c.get(id) || !c.get(len) || !c.get(s, len)) { break; }
+      if (l.strings.size() <= id) { l.strings.resize(id + 1); }
+      l.strings[id] = std::move(s);
+    } else if (kind == record_t::event) {
+      event e;
+      std::uint8_t argc;
+      if (!c.get(e.id) || !c.get(e.timestamp_ns) || !c.get(argc)) { break; }
+
+      bool ok = true;
+      for (int i = 0; ok && i < argc; ++i) {
+        arg_t type;
+        ok = c.get(type);
+        if (!ok) { break; }
+
+        switch (type) {
+          case arg_t::i64: {
+            std::int64_t x;
+            ok = c.get(x);
+            if (!ok) { break; }
+            e.args.emplace_back(x);
+          } break;
+          case arg_t::u64: {
+            std::uint64_t x;
+            ok = c.get(x);
+            if (!ok) { break; }
+            e.args.emplace_back(x);
+          } break;
+          case arg_t::f64: {
+            double x;
+            ok = c.get(x);
+            if (!ok) { break; }
+            e.args.emplace_back(x);
+          } break;
+          case arg_t::str: {
+            std::uint16_t len;
+            std::string x;
+            ok = c.get(len) && c.get(x, len);
+            if (!ok) { break; }
+            e.args.emplace_back(std::move(x));
+          } break;
+          default: ok = false;
+        }
+      }
+
+      // a truncated trailing event is dropped, everything before it is kept
+      if (!ok) { break; }
+      l.events.push_back(std::move(e));
+    } else {
+      break;
+    }
+  }
+
+  return l;
+}
+
+static std::string arg_to_string(
+  const std::variant<std::int64_t, std::uint64_t, double, std::string> &a
+) {
+  return std::visit([](const auto &x) -> std::string {
+    using T = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<T, std::string>) {
+      return x;
+    } else {
+      return std::to_string(x);
+    }
+  }, a);
+}
+
+std::string evlog::format(const log &l, const event &e) {
+  const std::string fmt = e.id < l.strings.size() ? l.strings[e.id] : "?";
+
+  std::string out;
+  std::size_t arg = 0;
+  std::size_t pos = 0;
+  std::size_t next;
+
+  while ((next = fmt.find("{}", pos)) != std::string::npos) {
+    out.append(fmt, pos, next - pos);
+    out += arg < e.args.size() ? arg_to_string(e.args[arg++]) : "{}";
+    pos = next + 2;
+  }
+  out.append(fmt, pos, std::string::npos);
+
+  for (; arg < e.args.size(); ++arg) {
+    out += " " + arg_to_string(e.args[arg]);
+  }
+
+  return out;
+}
@@ -0,0 +1,170 @@
+#ifndef __EVENT_LOG_HPP__
+#define __EVENT_LOG_HPP__
+/*
+  binary event log
+
+  file   := header record*
+  header := "QEVL" u32:version u64:wall_clock_ns
+  record := u8:kind (string_def | event)
+  string_def := u16:id u16:length char[length]
+  event      := u16:id u64:timestamp_ns u8:argc arg[argc]
+  arg        := u8:type payload
+
+  integers are in native byte order, so a log is read on a machine of the
+  writer's endianness. the id of an event is the id of its format string,
+  which is written once (the first time it is used) before the event that
+  references it. timestamps are relative to the header's wall clock time.
+
+  a writer can be shared between threads, each event is written whole under
+  the writer's lock.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace evlog {
+  constexpr char magic[4] = {'Q', 'E', 'V', 'L'};
+  constexpr std::uint32_t version = 1;
+
+  enum class record_t : std::uint8_t {
+    string_def = 1,
+    event = 2
+  };
+
+  enum class arg_t : std::uint8_t {
+    i64 = 1,
+    u64 = 2,
+    f64 = 3,
+    str = 4
+  };
+
+  class writer {
+  public:
+    writer(const std::filesystem::path &p);
+    ~writer();
+
+    writer(const writer &) = delete;
+    writer &operator=(const writer &) = delete;
+
+    // fmt must outlive the writer; ids are cached by pointer
+    template <typename... Args>
+    void emit(const char *fmt, const Args &... args);
+    void flush();
+
+  private:
+    void write_buffer(); // with `lock` held
+    std::uint16_t intern(const char *fmt);
+    void put_arg(const std::int64_t v);
+    void put_arg(const std::uint64_t v);
+    void put_arg(const double v);
+    void put_arg(const std::string_view v);
+
+    template <typename T>
+    void put(const T t);
+    template <typename T>
+    void pack(const T &t);
+
+    std::mutex lock; // guards everything below
+    std::ofstream ofs;
+    std::vector<char> buffer;
+    std::unordered_map<const char *, std::uint16_t> string_ids;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // process wide writer used by the EVLOG macro
+  void open(const std::filesystem::path &p);
+  void close();
+  writer *get();
+
+  struct event {
+    std::uint16_t id;
+    std::uint64_t timestamp_ns;
+    std::vector<std::variant<std::int64_t, std::uint64_t, double, std::string>>
+      args;
+  };
+
+  struct log {
+    std::uint64_t wall_clock_ns;
+    std::vector<std::string> strings;
+    std::vector<event> events;
+  };
+
+  std::optional<log> read(const std::filesystem::path &p);
+  std::string format(const log &l, const event &e);
+};
+
+template <typename T>
+void evlog::writer::put(const T t) {
+  const std::size_t pos = buffer.size();
+  buffer.resize(pos + sizeof(T));
+  std::memcpy(&buffer[pos], &t, sizeof(T));
+}
+
+template <typename T>
+void evlog::writer::pack(const T &t) {
+  if constexpr (std::is_same_v<T, bool>) {
+    put_arg(static_cast<std::uint64_t>(t));
+  } else if constexpr (std::is_enum_v<T>) {
+    put_arg(static_cast<std::int64_t>(t));
+  } else if constexpr (std::is_floating_point_v<T>) {
+    put_arg(static_cast<double>(t));
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    put_arg(static_cast<std::int64_t>(t));
+  } else if constexpr (std::is_integral_v<T>) {
+    put_arg(static_cast<std::uint64_t>(t));
+  } else if constexpr (std::is_pointer_v<T>) {
+    // c strings, including the `const GLubyte *` returned by glGetString,
+    // which is null when the query fails
+    const char *s = reinterpret_cast<const char *>(t);
+    put_arg(std::string_view(s ? s : "(null)"));
+  } else if constexpr (std::is_same_v<T, std::filesystem::path>) {
+    put_arg(std::string_view(t.native()));
+  } else {
+    put_arg(std::string_view(t));
+  }
+}
+
+template <typename... Args>
+void evlog::writer::emit(const char *fmt, const Args &... args) {
+  static_assert(sizeof...(Args) < 256, "too many event arguments");
+
+  std::lock_guard<std::mutex> guard(lock);
+  const std::uint16_t id = intern(fmt);
+  const auto now = std::chrono::steady_clock::now() - start;
+
+  put(record_t::event);
+  put(id);
+  put(static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()
+  ));
+  put(static_cast<std::uint8_t>(sizeof...(Args)));
+  (pack(args), ...);
+
+  if (buffer.size() >= (1 << 16)) {
+    write_buffer();
+  }
+}
+
+#ifdef EVENT_LOG
+#define EVLOG(...) \
+  do { \
+    if (auto *evlog_writer_ = evlog::get()) { \
+      evlog_writer_->emit(__VA_ARGS__); \
+    } \
+  } while (0)
+#else
+#define EVLOG(...) do {} while (0)
+#endif
+
+#endif // __EVENT_LOG_HPP__
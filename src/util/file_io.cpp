@@ -1,3 +1,5 @@
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
@@ -5,9 +7,20 @@
 #include <optional>
 #include <string>
 
+#include <unistd.h>
+
+#include "alloc_track.hpp"
 #include "file_io.hpp"
 
 std::optional<std::string> fio::read(const std::filesystem::path &p) {
+  std::string data;
+  if (read(p, data)) { return data; }
+
+  return {};
+}
+
+bool fio::read(const std::filesystem::path &p, std::string &out) {
+  ALLOC_SCOPE(io);
   std::ifstream ifs(p);
 
   if (ifs) {
@@ -15,14 +28,13 @@ std::optional<std::string> fio::read(const std::filesystem::path &p) {
     std::size_t filesize = ifs.tellg();
     ifs.seekg(0, std::ios::beg);
 
-    std::string data;
-    data.resize(filesize);
-    ifs.read(&data[0], filesize);
+    out.resize(filesize);
+    ifs.read(out.data(), filesize);
 
-    return data;
+    return bool(ifs);
   }
 
-  return {};
+  return false;
 }
 
 bool fio::write(
@@ -45,6 +57,15 @@ bool fio::write(
   return false;
 }
 
+std::filesystem::path fio::temp_path(const std::filesystem::path &p) {
+  static std::atomic<std::uint64_t> next{0};
+
+  std::filesystem::path tmp = p;
+  tmp += "." + std::to_string(getpid()) + "." + std::to_string(next++);
+  tmp += ".tmp";
+  return tmp;
+}
+
 #ifdef DEBUG
 fio::log_stream_f::log_stream_f(const std::string &s, const bool no_buf) {
   if (no_buf) { ofs.rdbuf()->pubsetbuf(0, 0); }
@@ -8,10 +8,15 @@
 
 namespace fio {
   std::optional<std::string> read(const std::filesystem::path &p);
+  // reads into `out`, reusing its capacity
+  bool read(const std::filesystem::path &p, std::string &out);
   bool write(
     const std::filesystem::path &p, const std::string &data,
     const bool trunc=false
   );
+  // a name next to `p` that no other process or thread is writing, to
+  // write a file in full and then rename it over `p`
+  std::filesystem::path temp_path(const std::filesystem::path &p);
 
   #ifdef DEBUG
   class log_stream_f {
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "alloc_track.hpp"
+#include "file_io.hpp"
+#include "image_cache.hpp"
+#include "image_decode.hpp"
+
+namespace fs = std::filesystem;
+
+constexpr char idx_magic[4] = {'Q', 'I', 'D', 'X'};
+constexpr char img_magic[4] = {'Q', 'I', 'M', 'G'};
+constexpr std::uint32_t version = 1;
+
+enum class compression_t : std::uint32_t {
+  none = 0,
+  lz4 = 1
+};
+
+struct index_entry {
+  char magic[4];
+  std::uint32_t version;
+  std::uint64_t size;
+  std::int64_t mtime;
+  std::uint64_t content;
+};
+
+struct image_header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t channels;
+  std::uint32_t options;
+  std::uint32_t compression;
+  std::uint32_t reserved;
+  std::uint64_t raw_size;
+  std::uint64_t stored_size;
+};
+
+static_assert(sizeof(index_entry) == 32);
+static_assert(sizeof(image_header) == 48);
+
+/*
+  hashing
+*/
+constexpr std::uint64_t k0 = 0x9e3779b97f4a7c15;
+constexpr std::uint64_t k1 = 0xc2b2ae3d27d4eb4f;
+
+static inline std::uint64_t rotl(const std::uint64_t x, const int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline std::uint64_t finalise(std::uint64_t h) {
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111eb;
+  return h ^ (h >> 31);
+}
+
+static inline std::uint64_t read64(const std::uint8_t *p) {
+  std::uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+std::uint64_t imgcache::hash(const std::uint8_t *data, const std::size_t size) {
+  // four independent lanes keep several multiplies in flight
+  std::uint64_t lanes[4] = {k0, k1, k0 ^ size, k1 ^ size};
+  std::size_t i = 0;
+
+  for (; i + 32 <= size; i += 32) {
+    for (int l = 0; l < 4; ++l) {
+      lanes[l] = rotl(lanes[l] ^ (read64(data + i + l * 8) * k1), 31) * k0;
+    }
+  }
+
+  std::uint64_t h = size;
+  for (const auto l : lanes) { h = rotl(h ^ finalise(l), 27) * k0; }
+
+  for (; i + 8 <= size; i += 8) { h = rotl(h ^ (read64(data + i) * k1), 31) * k0; }
+  for (; i < size; ++i) { h = rotl(h ^ (data[i] * k1), 11) * k0; }
+
+  return finalise(h);
+}
+
+static std::uint32_t options_key(const imgdec::options &opts) {
+  // threads only changes how the image is decoded, not the result
+  return std::uint32_t(opts.channels) | (opts.flip << 3) |
+    (opts.srgb_to_linear << 4) | (opts.premultiply << 5);
+}
+
+static std::string hex_name(const std::uint64_t key, const char *ext) {
+  char name[32];
+  std::snprintf(
+    name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(key), ext
+  );
+
+  return name;
+}
+
+/*
+  lz4 block format
+
+  sequence := token [literal length bytes] literals offset:u16le
+              [match length bytes]
+  the last sequence stops after its literals. matches are at least 4 bytes,
+  the last 5 bytes are always literals and the last match starts at least
+  12 bytes before the end.
+*/
+constexpr std::size_t lz4_min_match = 4;
+constexpr std::size_t lz4_last_literals = 5;
+constexpr std::size_t lz4_match_limit = 12;
+constexpr int lz4_hash_bits = 16;
+
+static inline std::uint32_t read32(const std::uint8_t *p) {
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static std::uint8_t *put_length(std::uint8_t *out, std::size_t n) {
+  for (; n >= 255; n -= 255) { *out++ = 255; }
+  *out++ = std::uint8_t(n);
+  return out;
+}
+
+static std::uint8_t *put_literals(
+  std::uint8_t *out, const std::uint8_t *lit, const std::size_t n,
+  const std::size_t match
+) {
+  *out++ = std::uint8_t((std::min<std::size_t>(n, 15) << 4) |
+    std::min<std::size_t>(match, 15));
+  if (n >= 15) { out = put_length(out, n - 15); }
+  if (n > 0) { std::memcpy(out, lit, n); }
+
+  return out + n;
+}
+
+std::size_t imgcache::lz4_bound(const std::size_t size) {
+  return size + size / 255 + 16;
+}
+
+std::size_t imgcache::lz4_compress(
+  const std::uint8_t *src, const std::size_t size, std::uint8_t *dst
+) {
+  std::uint8_t *out = dst;
+  std::size_t anchor = 0;
+
+  if (size > lz4_match_limit) {
+    std::vector<std::uint32_t> table(1 << lz4_hash_bits, 0);
+    const std::size_t limit = size - lz4_match_limit;
+    const std::size_t match_end = size - lz4_last_literals;
+
+    for (std::size_t ip = 1; ip < limit;) {
+      const std::uint32_t seq = read32(src + ip);
+      const std::uint32_t h = (seq * 2654435761u) >> (32 - lz4_hash_bits);
+      const std::size_t ref = table[h];
+      table[h] = ip;
+
+      if (ip - ref > 65535 || read32(src + ref) != seq) {
+        ++ip;
+        continue;
+      }
+
+      std::size_t end = ip + lz4_min_match;
+      while (end < match_end && src[end] == src[ref + end - ip]) { ++end; }
+
+      const std::size_t match = end - ip - lz4_min_match;
+      out = put_literals(out, src + anchor, ip - anchor, match);
+      *out++ = std::uint8_t(ip - ref);
+      *out++ = std::uint8_t((ip - ref) >> 8);
+      if (match >= 15) { out = put_length(out, match - 15); }
+
+      ip = anchor = end;
+    }
+  }
+
+  out = put_literals(out, src + anchor, size - anchor, 0);
+
+  return out - dst;
+}
+
+static bool get_length(
+  const std::uint8_t *src, const std::size_t size, std::size_t &pos,
+  std::size_t &n
+) {
+  std::uint8_t b;
+  do {
+    if (pos >= size) { return false; }
+    b = src[pos++];
+    n += b;
+  } while (b == 255);
+
+  return true;
+}
+
+bool imgcache::lz4_decompress(
+  const std::uint8_t *src, const std::size_t size, std::uint8_t *dst,
+  const std::size_t dst_size
+) {
+  std::size_t s = 0;
+  std::size_t d = 0;
+
+  while (s < size) {
+    const std::uint8_t token = src[s++];
+
+    std::size_t lit = token >> 4;
+    if (lit == 15 && !get_length(src, size, s, lit)) { return false; }
+    if (lit > size - s || lit > dst_size - d) { return false; }
+    if (lit > 0) { std::memcpy(dst + d, src + s, lit); }
+    s += lit;
+    d += lit;
+
+    if (s == size) { break; }
+
+    if (size - s < 2) { return false; }
+    const std::size_t offset = src[s] | (src[s + 1] << 8);
+    s += 2;
+    if (offset == 0 || offset > d) { return false; }
+
+    std::size_t match = token & 15;
+    if (match == 15 && !get_length(src, size, s, match)) { return false; }
+    match += lz4_min_match;
+    if (match > dst_size - d) { return false; }
+
+    // overlapping copies repeat the last `offset` bytes
+    if (offset >= match) {
+      std::memcpy(dst + d, dst + d - offset, match);
+    } else {
+      for (std::size_t i = 0; i < match; ++i) { dst[d + i] = dst[d + i - offset]; }
+    }
+    d += match;
+  }
+
+  return d == dst_size;
+}
+
+/*
+  entries
+*/
+std::optional<imgcache::cache> imgcache::open(const fs::path &dir) {
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  if (ec || !fs::is_directory(dir, ec)) { return {}; }
+
+  cache c;
+  c.dir = dir;
+
+  return c;
+}
+
+void imgcache::clear(cache &c) {
+  std::error_code ec;
+  for (const auto &e : fs::directory_iterator(c.dir, ec)) {
+    const auto ext = e.path().extension();
+    if (ext == ".idx" || ext == ".img") { fs::remove(e.path(), ec); }
+  }
+}
+
+// writes next to `p` and renames, so readers never see a partial entry.
+// the temporary name is unique, two writers of one entry each rename a
+// whole file and the last one wins
+static bool write_entry(
+  const fs::path &p, const void *header, const std::size_t header_size,
+  const std::uint8_t *data, const std::size_t size
+) {
+  const fs::path tmp = fio::temp_path(p);
+
+  bool written;
+  {
+    std::ofstream ofs(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs.write(static_cast<const char *>(header), header_size);
+    ofs.write(reinterpret_cast<const char *>(data), size);
+    ofs.close();
+    written = bool(ofs);
+  }
+
+  std::error_code rename_error;
+  if (written) { fs::rename(tmp, p, rename_error); }
+  if (!written || rename_error) {
+    std::error_code ec;
+    fs::remove(tmp, ec);
+    return false;
+  }
+
+  return true;
+}
+
+static std::optional<index_entry> read_index(const fs::path &p) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  if (!ifs) { return {}; }
+
+  index_entry e;
+  ifs.read(reinterpret_cast<char *>(&e), sizeof(e));
+  if (!ifs || std::memcmp(e.magic, idx_magic, sizeof(idx_magic)) != 0 ||
+    e.version != version) {
+    return {};
+  }
+
+  return e;
+}
+
+static std::optional<imgdec::info> read_image(
+  const fs::path &p, const std::uint32_t options,
+  std::vector<std::uint8_t> &out
+) {
+  const int fd = ::open(p.c_str(), O_RDONLY);
+  if (fd < 0) { return {}; }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof(image_header)) {
+    close(fd);
+    return {};
+  }
+
+  const std::size_t size = st.st_size;
+  void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) { return {}; }
+
+  const auto *bytes = static_cast<const std::uint8_t *>(map);
+  image_header h;
+  std::memcpy(&h, bytes, sizeof(h));
+
+  std::optional<imgdec::info> info;
+  const bool valid =
+    std::memcmp(h.magic, img_magic, sizeof(img_magic)) == 0 &&
+    h.version == version && h.options == options &&
+    h.stored_size == size - sizeof(h) &&
+    h.raw_size == std::uint64_t(h.width) * h.height * h.channels;
+
+  if (valid) {
+    const std::uint8_t *data = bytes + sizeof(h);
+    out.resize(h.raw_size);
+
+    bool ok = false;
+    switch (compression_t(h.compression)) {
+      case compression_t::none:
+        ok = h.stored_size == h.raw_size;
+        if (ok) { std::memcpy(out.data(), data, h.raw_size); }
+        break;
+      case compression_t::lz4:
+        ok = imgcache::lz4_decompress(data, h.stored_size, out.data(), h.raw_size);
+        break;
+    }
+
+    if (ok) {
+      info = imgdec::info();
+      info->width = h.width;
+      info->height = h.height;
+      info->channels = h.channels;
+      info->chunks = 0; // nothing was decoded
+    }
+  }
+
+  munmap(map, size);
+
+  return info;
+}
+
+static bool write_image(
+  const fs::path &p, const std::uint32_t options, const imgdec::info &info,
+  const std::vector<std::uint8_t> &pixels, const bool compress
+) {
+  image_header h;
+  std::memcpy(h.magic, img_magic, sizeof(img_magic));
+  h.version = version;
+  h.width = info.width;
+  h.height = info.height;
+  h.channels = info.channels;
+  h.options = options;
+  h.compression = std::uint32_t(compression_t::none);
+  h.reserved = 0;
+  h.raw_size = pixels.size();
+  h.stored_size = pixels.size();
+
+  if (compress) {
+    std::vector<std::uint8_t> packed(imgcache::lz4_bound(pixels.size()));
+    const std::size_t n = imgcache::lz4_compress(
+      pixels.data(), pixels.size(), packed.data()
+    );
+
+    // incompressible images are cheaper to read back raw
+    if (n < pixels.size()) {
+      h.compression = std::uint32_t(compression_t::lz4);
+      h.stored_size = n;
+      return write_entry(p, &h, sizeof(h), packed.data(), n);
+    }
+  }
+
+  return write_entry(p, &h, sizeof(h), pixels.data(), pixels.size());
+}
+
+static bool read_file(const fs::path &p, std::vector<std::uint8_t> &file) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  if (!ifs) { return false; }
+
+  ifs.seekg(0, std::ios::end);
+  file.resize(ifs.tellg());
+  ifs.seekg(0, std::ios::beg);
+  ifs.read(reinterpret_cast<char *>(file.data()), file.size());
+
+  return bool(ifs);
+}
+
+std::optional<imgdec::info> imgcache::decode(
+  cache &c, const fs::path &p, const imgdec::options &opts,
+  std::vector<std::uint8_t> &file, std::vector<std::uint8_t> &out
+) {
+  ALLOC_SCOPE(images);
+  std::error_code size_error;
+  std::error_code mtime_error;
+  const auto size = fs::file_size(p, size_error);
+  const auto mtime = fs::last_write_time(p, mtime_error);
+  if (size_error || mtime_error) { return imgdec::decode(p, opts, file, out); }
+
+  const std::uint32_t options = options_key(opts);
+  std::error_code ec;
+  const std::string source = fs::absolute(p, ec).string();
+  const fs::path idx_path = c.dir / hex_name(
+    hash(reinterpret_cast<const std::uint8_t *>(source.data()), source.size()),
+    ".idx"
+  );
+  auto img_path = [&](const std::uint64_t content) {
+    return c.dir / hex_name(finalise(content ^ (options * k1)), ".img");
+  };
+
+  const auto idx = read_index(idx_path);
+  const bool unchanged = idx && idx->size == size &&
+    idx->mtime == mtime.time_since_epoch().count();
+
+  if (unchanged) {
+    if (auto info = read_image(img_path(idx->content), options, out)) {
+      ++c.hits;
+      return info;
+    }
+  }
+
+  if (!read_file(p, file)) { return {}; }
+
+  const std::uint64_t content = hash(file.data(), file.size());
+  if (!unchanged) {
+    if (idx) { ++c.rehashes; }
+
+    index_entry e;
+    std::memcpy(e.magic, idx_magic, sizeof(idx_magic));
+    e.version = version;
+    e.size = size;
+    e.mtime = mtime.time_since_epoch().count();
+    e.content = content;
+    write_entry(idx_path, &e, sizeof(e), nullptr, 0);
+
+    // touched but identical, or the same image under another path
+    if (auto info = read_image(img_path(content), options, out)) {
+      ++c.hits;
+      return info;
+    }
+  }
+
+  ++c.misses;
+  auto info = imgdec::decode(file.data(), file.size(), opts, out);
+  if (info) { write_image(img_path(content), options, *info, out, c.compress); }
+
+  return info;
+}
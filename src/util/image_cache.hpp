@@ -0,0 +1,66 @@
+#ifndef __IMAGE_CACHE_HPP__
+#define __IMAGE_CACHE_HPP__
+/*
+  persistent cache of decoded images
+
+  decoded pixels (after flip and conversion) are stored under the cache
+  directory, keyed by a hash of the source file's contents and the decode
+  options, and read back through mmap instead of decoding again. a small
+  index entry per source path remembers its size, mtime and content hash, so
+  a warm lookup only stats the source; a source whose mtime changed is
+  hashed again and still hits if its contents did not.
+
+  entries are written in native byte order, the cache is never shared
+  between machines. data can optionally be lz4 (block format) compressed.
+
+    <hash(path)>.idx := "QIDX" u32:version u64:size i64:mtime u64:content
+    <hash(content, options)>.img := "QIMG" u32:version u32:width u32:height
+      u32:channels u32:options u32:compression u32:reserved u64:raw_size
+      u64:stored_size u8[stored_size]
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "image_decode.hpp"
+
+namespace imgcache {
+  struct cache {
+    std::filesystem::path dir;
+    bool compress = false; // lz4 new entries
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t rehashes = 0; // sources whose mtime or size changed
+  };
+
+  // creates `dir` if needed, returns nothing if that fails
+  std::optional<cache> open(const std::filesystem::path &dir);
+  // removes every entry
+  void clear(cache &c);
+
+  // decoded pixels of `p` from the cache, decoding (and storing the result)
+  // on a miss. same contract as imgdec::decode
+  std::optional<imgdec::info> decode(
+    cache &c, const std::filesystem::path &p, const imgdec::options &opts,
+    std::vector<std::uint8_t> &file, std::vector<std::uint8_t> &out
+  );
+
+  std::uint64_t hash(const std::uint8_t *data, const std::size_t size);
+
+  // lz4 block format, without the frame
+  std::size_t lz4_bound(const std::size_t size);
+  std::size_t lz4_compress(
+    const std::uint8_t *src, const std::size_t size, std::uint8_t *dst
+  );
+  // returns false on malformed input or if it does not fill `dst` exactly
+  bool lz4_decompress(
+    const std::uint8_t *src, const std::size_t size, std::uint8_t *dst,
+    const std::size_t dst_size
+  );
+};
+
+#endif // __IMAGE_CACHE_HPP__
@@ -0,0 +1,578 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IMGDEC_X86 1
+#include <immintrin.h>
+#endif
+
+#include "alloc_track.hpp"
+
+#ifdef ALLOC_TRACK
+#define STBI_MALLOC(n) alloc::tracked_malloc(n)
+#define STBI_REALLOC(p, n) alloc::tracked_realloc(p, n)
+#define STBI_FREE(p) alloc::tracked_free(p)
+#endif
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "image_decode.hpp"
+#include "jobs.hpp"
+
+#if defined(IMGDEC_X86) && (defined(__GNUC__) || defined(__clang__))
+#define IMGDEC_SIMD 1
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/*
+  row kernels
+*/
+static std::array<std::uint8_t, 256> make_srgb_lut() {
+  std::array<std::uint8_t, 256> lut;
+  for (int i = 0; i < 256; ++i) {
+    const double c = i / 255.0;
+    const double l = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    lut[i] = std::uint8_t(std::lround(l * 255));
+  }
+
+  return lut;
+}
+
+static const std::array<std::uint8_t, 256> srgb_lut = make_srgb_lut();
+
+static inline std::uint8_t mul_div255(const unsigned x, const unsigned a) {
+  const unsigned p = x * a + 128;
+  return (p + (p >> 8)) >> 8;
+}
+
+static void expand_scalar(
+  const std::uint8_t *src, const int width, const int src_channels,
+  std::uint8_t *dst, int i
+) {
+  for (; i < width; ++i) {
+    const std::uint8_t *s = src + i * src_channels;
+    std::uint8_t *d = dst + i * 4;
+
+    switch (src_channels) {
+      case 1: d[0] = d[1] = d[2] = s[0]; d[3] = 255; break;
+      case 2: d[0] = d[1] = d[2] = s[0]; d[3] = s[1]; break;
+      case 3: d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = 255; break;
+      default: std::memcpy(d, s, 4);
+    }
+  }
+}
+
+static void premultiply_scalar(std::uint8_t *row, const int width, int i) {
+  for (; i < width; ++i) {
+    std::uint8_t *p = row + i * 4;
+    p[0] = mul_div255(p[0], p[3]);
+    p[1] = mul_div255(p[1], p[3]);
+    p[2] = mul_div255(p[2], p[3]);
+  }
+}
+
+static void expand_row_scalar(
+  const std::uint8_t *src, const int width, const int src_channels,
+  std::uint8_t *dst
+) {
+  expand_scalar(src, width, src_channels, dst, 0);
+}
+
+static void premultiply_row_scalar(std::uint8_t *row, const int width) {
+  premultiply_scalar(row, width, 0);
+}
+
+#ifdef IMGDEC_SIMD
+TARGET_SSSE3 static void expand_row_ssse3(
+  const std::uint8_t *src, const int width, const int src_channels,
+  std::uint8_t *dst
+) {
+  int i = 0;
+
+  if (src_channels == 3) {
+    const __m128i shuffle = _mm_setr_epi8(
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+    // 16 byte loads of 12 byte groups, stop before reading past the row
+    for (; i + 6 <= width; i += 4) {
+      const __m128i v = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(src + i * 3)
+      );
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(dst + i * 4),
+        _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha)
+      );
+    }
+  } else if (src_channels == 1) {
+    const __m128i ones = _mm_set1_epi8(-1);
+
+    for (; i + 16 <= width; i += 16) {
+      const __m128i g = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(src + i)
+      );
+      const __m128i gg[2] = {_mm_unpacklo_epi8(g, g), _mm_unpackhi_epi8(g, g)};
+      const __m128i ga[2] = {
+        _mm_unpacklo_epi8(g, ones), _mm_unpackhi_epi8(g, ones)
+      };
+
+      __m128i *d = reinterpret_cast<__m128i *>(dst + i * 4);
+      for (int h = 0; h < 2; ++h) {
+        _mm_storeu_si128(d++, _mm_unpacklo_epi16(gg[h], ga[h]));
+        _mm_storeu_si128(d++, _mm_unpackhi_epi16(gg[h], ga[h]));
+      }
+    }
+  }
+
+  expand_scalar(src, width, src_channels, dst, i);
+}
+
+TARGET_SSSE3 static void premultiply_row_ssse3(
+  std::uint8_t *row, const int width
+) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+  int i = 0;
+
+  for (; i + 4 <= width; i += 4) {
+    __m128i *p = reinterpret_cast<__m128i *>(row + i * 4);
+    const __m128i v = _mm_loadu_si128(p);
+
+    __m128i c[2] = {_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)};
+    for (auto &x : c) {
+      const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xff), 0xff);
+      x = _mm_add_epi16(_mm_mullo_epi16(x, a), round);
+      x = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    const __m128i packed = _mm_packus_epi16(c[0], c[1]);
+    _mm_storeu_si128(p, _mm_or_si128(
+      _mm_andnot_si128(alpha_mask, packed), _mm_and_si128(alpha_mask, v)
+    ));
+  }
+
+  premultiply_scalar(row, width, i);
+}
+
+TARGET_AVX2 static void expand_row_avx2(
+  const std::uint8_t *src, const int width, const int src_channels,
+  std::uint8_t *dst
+) {
+  int i = 0;
+
+  if (src_channels == 3) {
+    const __m256i shuffle = _mm256_setr_epi8(
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    // move bytes 12..27 into the upper lane
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i alpha = _mm256_set1_epi32(0xff000000);
+
+    for (; i + 11 <= width; i += 8) {
+      __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(src + i * 3)
+      );
+      v = _mm256_permutevar8x32_epi32(v, spread);
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + i * 4),
+        _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha)
+      );
+    }
+  }
+
+  // the remaining pixels and the other channel counts
+  expand_row_ssse3(src + i * src_channels, width - i, src_channels, dst + i * 4);
+}
+
+TARGET_AVX2 static void premultiply_row_avx2(
+  std::uint8_t *row, const int width
+) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i round = _mm256_set1_epi16(128);
+  const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+  int i = 0;
+
+  for (; i + 8 <= width; i += 8) {
+    __m256i *p = reinterpret_cast<__m256i *>(row + i * 4);
+    const __m256i v = _mm256_loadu_si256(p);
+
+    __m256i c[2] = {
+      _mm256_unpacklo_epi8(v, zero), _mm256_unpackhi_epi8(v, zero)
+    };
+    for (auto &x : c) {
+      const __m256i a = _mm256_shufflehi_epi16(
+        _mm256_shufflelo_epi16(x, 0xff), 0xff
+      );
+      x = _mm256_add_epi16(_mm256_mullo_epi16(x, a), round);
+      x = _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+    }
+
+    // unpack/pack work per lane, so the pixel order survives the round trip
+    const __m256i packed = _mm256_packus_epi16(c[0], c[1]);
+    _mm256_storeu_si256(p, _mm256_or_si256(
+      _mm256_andnot_si256(alpha_mask, packed), _mm256_and_si256(alpha_mask, v)
+    ));
+  }
+
+  premultiply_row_ssse3(row + i * 4, width - i);
+}
+#endif // IMGDEC_SIMD
+
+struct kernels {
+  imgdec::isa_t isa;
+  void (*expand)(const std::uint8_t *, int, int, std::uint8_t *);
+  void (*premultiply)(std::uint8_t *, int);
+};
+
+static kernels kernels_for(const imgdec::isa_t isa) {
+  switch (isa) {
+    #ifdef IMGDEC_SIMD
+    case imgdec::isa_t::avx2:
+      if (__builtin_cpu_supports("avx2")) {
+        return {isa, expand_row_avx2, premultiply_row_avx2};
+      }
+      [[fallthrough]];
+    case imgdec::isa_t::ssse3:
+      if (__builtin_cpu_supports("ssse3")) {
+        return {imgdec::isa_t::ssse3, expand_row_ssse3, premultiply_row_ssse3};
+      }
+      [[fallthrough]];
+    #endif
+    default:
+      return {imgdec::isa_t::scalar, expand_row_scalar, premultiply_row_scalar};
+  }
+}
+
+static kernels &active() {
+  static kernels k = kernels_for(imgdec::isa_t::avx2);
+  return k;
+}
+
+imgdec::isa_t imgdec::active_isa() {
+  return active().isa;
+}
+
+void imgdec::set_isa(const isa_t isa) {
+  active() = kernels_for(isa);
+}
+
+const char *imgdec::isa_name(const isa_t isa) {
+  switch (isa) {
+    case isa_t::avx2: return "avx2";
+    case isa_t::ssse3: return "ssse3";
+    default: return "scalar";
+  }
+}
+
+void imgdec::convert_rows(
+  const std::uint8_t *src, const int width, const int rows,
+  const int src_channels, const options &opts,
+  std::uint8_t *dst, const std::ptrdiff_t dst_stride
+) {
+  const kernels &k = active();
+  const int dst_channels = opts.channels == 0 ? src_channels : 4;
+  const std::size_t src_row = std::size_t(width) * src_channels;
+  const bool has_alpha = dst_channels == 2 || dst_channels == 4;
+
+  for (int y = 0; y < rows; ++y, src += src_row, dst += dst_stride) {
+    if (dst_channels == src_channels) {
+      std::memcpy(dst, src, src_row);
+    } else {
+      k.expand(src, width, src_channels, dst);
+    }
+
+    // the row is still in l1, so the remaining steps cost no extra traffic
+    if (opts.srgb_to_linear) {
+      const int colour = has_alpha ? dst_channels - 1 : dst_channels;
+      for (int i = 0; i < width; ++i) {
+        std::uint8_t *p = dst + i * dst_channels;
+        for (int c = 0; c < colour; ++c) { p[c] = srgb_lut[p[c]]; }
+      }
+    }
+
+    if (opts.premultiply && dst_channels == 4) {
+      k.premultiply(dst, width);
+    } else if (opts.premultiply && dst_channels == 2) {
+      for (int i = 0; i < width; ++i) {
+        dst[i * 2] = mul_div255(dst[i * 2], dst[i * 2 + 1]);
+      }
+    }
+  }
+}
+
+/*
+  restart interval splitting
+*/
+namespace {
+  struct jpeg_layout {
+    std::size_t header_end = 0; // first byte of entropy coded data
+    std::size_t height_pos = 0; // of the frame height in the sof segment
+    int width = 0;
+    int height = 0;
+    int components = 0;
+    int mcu_height = 0;
+    int rows_per_interval = 0; // mcu rows
+    std::vector<std::pair<std::size_t, std::size_t>> intervals;
+  };
+};
+
+static int be16(const std::uint8_t *p) {
+  return (p[0] << 8) | p[1];
+}
+
+static std::optional<jpeg_layout> parse_restart_layout(
+  const std::uint8_t *data, const std::size_t size
+) {
+  if (size < 4 || data[0] != 0xff || data[1] != 0xd8) { return {}; }
+
+  jpeg_layout l;
+  int restart_interval = 0;
+  int hmax = 0;
+  int vmax = 0;
+  std::size_t pos = 2;
+
+  while (l.header_end == 0) {
+    if (pos + 4 > size || data[pos] != 0xff) { return {}; }
+    const int marker = data[pos + 1];
+    if (marker == 0xff) { ++pos; continue; }
+
+    const std::size_t len = be16(data + pos + 2);
+    if (pos + 2 + len > size) { return {}; }
+    const std::uint8_t *seg = data + pos + 4;
+
+    if (marker == 0xc0 || marker == 0xc1) {
+      l.height_pos = pos + 5;
+      l.height = be16(seg + 1);
+      l.width = be16(seg + 3);
+      l.components = seg[5];
+      if (l.components != 1 && l.components != 3) { return {}; }
+      if (len < std::size_t(8 + 3 * l.components)) { return {}; }
+      for (int c = 0; c < l.components; ++c) {
+        hmax = std::max(hmax, seg[7 + c * 3] >> 4);
+        vmax = std::max(vmax, seg[7 + c * 3] & 15);
+      }
+    } else if (marker >= 0xc2 && marker <= 0xcf &&
+      marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+      // progressive, lossless and arithmetic coded frames
+      return {};
+    } else if (marker == 0xdd) {
+      restart_interval = be16(seg);
+    } else if (marker == 0xda) {
+      // a single scan holding every component
+      if (l.components == 0 || seg[0] != l.components) { return {}; }
+      l.header_end = pos + 2 + len;
+    }
+
+    pos += 2 + len;
+  }
+
+  if (restart_interval == 0 || l.height == 0 || hmax == 0 || vmax == 0) {
+    return {};
+  }
+
+  const int mcus_per_row = (l.width + 8 * hmax - 1) / (8 * hmax);
+  if (restart_interval % mcus_per_row != 0) { return {}; }
+  l.mcu_height = 8 * vmax;
+  l.rows_per_interval = restart_interval / mcus_per_row;
+
+  // split the entropy coded data at rst markers, stop at eoi
+  std::size_t start = l.header_end;
+  for (pos = l.header_end; pos + 1 < size; ++pos) {
+    if (data[pos] != 0xff || data[pos + 1] == 0x00 || data[pos + 1] == 0xff) {
+      continue;
+    }
+
+    const int marker = data[pos + 1];
+    if (marker >= 0xd0 && marker <= 0xd7) {
+      l.intervals.push_back({start, pos});
+      start = pos + 2;
+      ++pos;
+    } else if (marker == 0xd9) {
+      l.intervals.push_back({start, pos});
+      break;
+    } else {
+      return {};
+    }
+  }
+
+  const int mcu_rows = (l.height + l.mcu_height - 1) / l.mcu_height;
+  const int expected = (mcu_rows + l.rows_per_interval - 1) / l.rows_per_interval;
+  if (int(l.intervals.size()) != expected) { return {}; }
+
+  return l;
+}
+
+// a standalone jpeg holding intervals [first, last)
+static std::vector<std::uint8_t> build_chunk(
+  const std::uint8_t *data, const jpeg_layout &l, const int first,
+  const int last, const int height
+) {
+  std::vector<std::uint8_t> chunk(data, data + l.header_end);
+  chunk[l.height_pos] = height >> 8;
+  chunk[l.height_pos + 1] = height & 0xff;
+
+  for (int i = first; i < last; ++i) {
+    if (i != first) {
+      chunk.push_back(0xff);
+      chunk.push_back(0xd0 + (i - first - 1) % 8);
+    }
+    chunk.insert(
+      chunk.end(), data + l.intervals[i].first, data + l.intervals[i].second
+    );
+  }
+  chunk.push_back(0xff);
+  chunk.push_back(0xd9);
+
+  return chunk;
+}
+
+// stb only vectorises jpeg colour conversion when writing 4 channels, so
+// let it produce rgba directly rather than expanding afterwards
+static int jpeg_request(const imgdec::options &opts) {
+  return opts.channels == 4 ? 4 : 0;
+}
+
+static bool is_jpeg(const std::uint8_t *data, const std::size_t size) {
+  return size >= 2 && data[0] == 0xff && data[1] == 0xd8;
+}
+
+static std::optional<imgdec::info> decode_split(
+  const std::uint8_t *data, const jpeg_layout &l, const imgdec::options &opts,
+  const int threads, std::vector<std::uint8_t> &out
+) {
+  const int intervals = l.intervals.size();
+  const int chunks = std::min(threads, intervals);
+  const int per_chunk = (intervals + chunks - 1) / chunks;
+  const int rows_per_interval = l.rows_per_interval * l.mcu_height;
+
+  imgdec::info info;
+  info.width = l.width;
+  info.height = l.height;
+  info.channels = opts.channels == 0 ? l.components : 4;
+  info.chunks = 0;
+
+  const std::ptrdiff_t row_bytes = std::ptrdiff_t(l.width) * info.channels;
+  out.resize(row_bytes * l.height);
+
+  std::atomic<bool> failed = false;
+  auto work = [&](const int first, const int last) {
+    ALLOC_SCOPE(images); // workers start untagged
+    // decode one extra interval either side so chroma upsampling at the
+    // seams sees the same neighbours as a whole image decode
+    const int ctx_first = std::max(first - 1, 0);
+    const int ctx_last = std::min(last + 1, intervals);
+    const int ctx_y0 = ctx_first * rows_per_interval;
+    const int ctx_y1 = std::min(ctx_last * rows_per_interval, l.height);
+    const int y0 = first * rows_per_interval;
+    const int y1 = std::min(last * rows_per_interval, l.height);
+    const auto chunk = build_chunk(data, l, ctx_first, ctx_last, ctx_y1 - ctx_y0);
+
+    int w;
+    int h;
+    int c;
+    unsigned char *px = stbi_load_from_memory(
+      chunk.data(), chunk.size(), &w, &h, &c, jpeg_request(opts)
+    );
+    c = jpeg_request(opts) == 0 ? c : 4;
+    if (px == nullptr || w != l.width || h != ctx_y1 - ctx_y0 ||
+      (jpeg_request(opts) == 0 && c != l.components)) {
+      failed = true;
+    } else {
+      std::uint8_t *dst = opts.flip
+        ? out.data() + (l.height - 1 - y0) * row_bytes
+        : out.data() + y0 * row_bytes;
+      imgdec::convert_rows(
+        px + std::size_t(y0 - ctx_y0) * w * c, w, y1 - y0, c, opts, dst,
+        opts.flip ? -row_bytes : row_bytes
+      );
+    }
+
+    stbi_image_free(px);
+  };
+
+  jobs::scheduler &scheduler = jobs::global();
+  jobs::counter done;
+  for (int first = per_chunk; first < intervals; first += per_chunk) {
+    const int last = std::min(first + per_chunk, intervals);
+    scheduler.run([&work, first, last] { work(first, last); }, &done);
+    ++info.chunks;
+  }
+  work(0, std::min(per_chunk, intervals));
+  ++info.chunks;
+  scheduler.wait(done);
+
+  if (failed) { return {}; }
+
+  return info;
+}
+
+std::optional<imgdec::info> imgdec::decode(
+  const std::uint8_t *data, const std::size_t size, const options &opts,
+  std::vector<std::uint8_t> &out
+) {
+  ALLOC_SCOPE(images);
+  const int threads = opts.threads > 0 ? opts.threads
+    : std::max(1u, std::thread::hardware_concurrency());
+
+  // splitting only pays off for large images
+  if (threads > 1) {
+    auto layout = parse_restart_layout(data, size);
+    if (layout && std::size_t(layout->width) * layout->height >= (1 << 20)) {
+      if (auto info = decode_split(data, *layout, opts, threads, out)) {
+        return info;
+      }
+    }
+  }
+
+  info i;
+  int c;
+  const int request = is_jpeg(data, size) ? jpeg_request(opts) : 0;
+  unsigned char *px = stbi_load_from_memory(
+    data, size, &i.width, &i.height, &c, request
+  );
+  if (px == nullptr) { return {}; }
+  c = request == 0 ? c : request;
+
+  i.channels = opts.channels == 0 ? c : 4;
+  const std::ptrdiff_t row_bytes = std::ptrdiff_t(i.width) * i.channels;
+  out.resize(row_bytes * i.height);
+
+  std::uint8_t *dst = opts.flip
+    ? out.data() + (i.height - 1) * row_bytes : out.data();
+  convert_rows(
+    px, i.width, i.height, c, opts, dst, opts.flip ? -row_bytes : row_bytes
+  );
+  stbi_image_free(px);
+
+  return i;
+}
+
+std::optional<imgdec::info> imgdec::decode(
+  const std::filesystem::path &p, const options &opts,
+  std::vector<std::uint8_t> &file, std::vector<std::uint8_t> &out
+) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  if (!ifs) { return {}; }
+
+  ifs.seekg(0, std::ios::end);
+  file.resize(ifs.tellg());
+  ifs.seekg(0, std::ios::beg);
+  ifs.read(reinterpret_cast<char *>(file.data()), file.size());
+  if (!ifs) { return {}; }
+
+  return decode(file.data(), file.size(), opts, out);
+}
@@ -0,0 +1,68 @@
+#ifndef __IMAGE_DECODE_HPP__
+#define __IMAGE_DECODE_HPP__
+/*
+  image decoding around stb_image
+
+  stb decodes without flipping, to the native channel count (jpegs go
+  straight to rgba when that is requested, where stb's colour conversion is
+  vectorised); every other step (channel expansion, srgb to linear,
+  premultiplied alpha, vertical flip) happens in a single pass over the rows
+  that writes straight into a caller-owned buffer. buffers keep their capacity, so repeated loads reuse
+  the same memory.
+
+  baseline jpegs with a restart interval covering whole mcu rows are split
+  at restart markers and the pieces decoded as jobs on jobs::global().
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace imgdec {
+  struct options {
+    int channels = 0; // 0 keeps the source channel count, otherwise 4
+    bool flip = true; // first row in memory is the bottom of the image
+    bool srgb_to_linear = false;
+    bool premultiply = false;
+    int threads = 0; // for split jpegs, 0 uses every hardware thread
+  };
+
+  struct info {
+    int width = 0;
+    int height = 0;
+    int channels = 0; // of the output
+    int chunks = 1; // number of pieces the image was decoded in
+  };
+
+  std::optional<info> decode(
+    const std::uint8_t *data, const std::size_t size, const options &opts,
+    std::vector<std::uint8_t> &out
+  );
+  // `file` is scratch space for the encoded bytes
+  std::optional<info> decode(
+    const std::filesystem::path &p, const options &opts,
+    std::vector<std::uint8_t> &file, std::vector<std::uint8_t> &out
+  );
+
+  // the fused conversion pass. `dst` points at the output row for the first
+  // source row, `dst_stride` may be negative to flip
+  void convert_rows(
+    const std::uint8_t *src, const int width, const int rows,
+    const int src_channels, const options &opts,
+    std::uint8_t *dst, const std::ptrdiff_t dst_stride
+  );
+
+  enum class isa_t {
+    scalar,
+    ssse3,
+    avx2
+  };
+
+  isa_t active_isa();
+  void set_isa(const isa_t isa);
+  const char *isa_name(const isa_t isa);
+};
+
+#endif // __IMAGE_DECODE_HPP__
@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "jobs.hpp"
+
+namespace {
+  constexpr std::int64_t deque_mask = jobs::deque_capacity - 1;
+  static_assert((jobs::deque_capacity & deque_mask) == 0);
+
+  // rounds of looking for work before a worker goes to sleep
+  constexpr int idle_spins = 64;
+  // pool slots tried before helping out with queued jobs instead
+  constexpr int pool_probes = 16;
+
+  struct thread_state {
+    const jobs::scheduler *owner = nullptr;
+    int index = -1;
+  };
+  thread_local thread_state current;
+};
+
+/*
+  work_deque, after Lê et al., "correct and efficient work-stealing for weak
+  memory models"
+*/
+bool jobs::work_deque::push(job *j) {
+  const std::int64_t b = bottom.load(std::memory_order_relaxed);
+  const std::int64_t t = top.load(std::memory_order_acquire);
+  if (b - t >= std::int64_t(deque_capacity)) { return false; }
+
+  slots[b & deque_mask].store(j, std::memory_order_relaxed);
+  bottom.store(b + 1, std::memory_order_release);
+  return true;
+}
+
+jobs::job *jobs::work_deque::pop() {
+  // seq_cst orders the store to bottom before the load of top, against
+  // the same pair in reverse in `steal`
+  const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_seq_cst);
+  std::int64_t t = top.load(std::memory_order_seq_cst);
+
+  if (t > b) {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  job *j = slots[b & deque_mask].load(std::memory_order_relaxed);
+  if (t == b) {
+    // the last job, a thief may be after it too
+    if (!top.compare_exchange_strong(
+      t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+    )) {
+      j = nullptr;
+    }
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  return j;
+}
+
+jobs::job *jobs::work_deque::steal() {
+  std::int64_t t = top.load(std::memory_order_seq_cst);
+  const std::int64_t b = bottom.load(std::memory_order_seq_cst);
+  if (t >= b) { return nullptr; }
+
+  job *j = slots[t & deque_mask].load(std::memory_order_relaxed);
+  if (!top.compare_exchange_strong(
+    t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+  )) {
+    return nullptr;
+  }
+
+  return j;
+}
+
+/*
+  scheduler
+*/
+jobs::scheduler::scheduler(const int workers) {
+  const int n = workers >= 0 ? workers
+    : std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+  for (int i = 0; i <= n; ++i) {
+    workers_.push_back(std::make_unique<worker>());
+  }
+
+  for (int i = 1; i <= n; ++i) {
+    threads_.emplace_back([this, i] { work(i); });
+  }
+}
+
+jobs::scheduler::~scheduler() {
+  // anything still queued runs before the workers go
+  const int self = index();
+  while (job *j = find(self)) { execute(j); }
+  run_main_thread_jobs();
+
+  {
+    std::lock_guard<std::mutex> lock(sleep_lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &t : threads_) { t.join(); }
+}
+
+int jobs::scheduler::index() const {
+  if (current.owner == this) { return current.index; }
+
+  return std::this_thread::get_id() == main_thread ? 0 : -1;
+}
+
+bool jobs::scheduler::on_main_thread() const {
+  return index() == 0;
+}
+
+jobs::job *jobs::scheduler::allocate() {
+  const int self = index();
+  if (self < 0) {
+    job *j = new job;
+    j->heap = true;
+    return j;
+  }
+
+  worker &w = *workers_[self];
+  auto claim = [](job &j) {
+    if (j.busy.load(std::memory_order_acquire)) { return false; }
+
+    j.busy.store(true, std::memory_order_relaxed);
+    return true;
+  };
+
+  for (;;) {
+    for (int tries = 0; tries < pool_probes; ++tries) {
+      job &j = w.pool[w.next];
+      w.next = (w.next + 1) % pool_size;
+      if (claim(j)) { return &j; }
+    }
+
+    // the pool is backed up with queued jobs: run one, and take its slot
+    // if it was ours (our own pops are the newest, so usually it is)
+    if (job *j = find(self)) {
+      const bool ours = j >= w.pool.get() && j < w.pool.get() + pool_size;
+      execute(j);
+      if (ours && claim(*j)) { return j; }
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void jobs::scheduler::submit(job *j) {
+  if (j->affinity == affinity_t::main_thread) {
+    std::lock_guard<std::mutex> lock(main_lock);
+    main_jobs.push_back(j);
+    main_ready.notify_one();
+    return;
+  }
+
+  const int self = index();
+  if (self >= 0) {
+    if (!workers_[self]->deque.push(j)) {
+      // a full deque means plenty of queued work already
+      execute(j);
+      return;
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(injected_lock);
+    injected.push_back(j);
+  }
+
+  queued.fetch_add(1);
+  if (sleepers.load() > 0) {
+    std::lock_guard<std::mutex> lock(sleep_lock);
+    wake.notify_one();
+  }
+  // with no workers the main thread runs everything
+  if (threads_.empty()) {
+    std::lock_guard<std::mutex> lock(main_lock);
+    main_ready.notify_one();
+  }
+}
+
+void jobs::scheduler::defer(counter &deps, job *j) {
+  {
+    std::lock_guard<std::mutex> lock(deps.lock);
+    if (deps.pending.load(std::memory_order_acquire) > 0) {
+      deps.continuations.push_back(j);
+      return;
+    }
+  }
+
+  submit(j);
+}
+
+void jobs::scheduler::finish(counter &c) {
+  int v = c.pending.load(std::memory_order_relaxed);
+  while (v > 1) {
+    if (c.pending.compare_exchange_weak(v, v - 1, std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+
+  // possibly the last one: the continuations are taken under the lock so
+  // none is attached after the count reaches zero and then never run
+  std::vector<job *> ready;
+  {
+    std::lock_guard<std::mutex> lock(c.lock);
+    if (c.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ready.swap(c.continuations);
+    }
+  }
+
+  for (job *j : ready) { submit(j); }
+}
+
+void jobs::scheduler::execute(job *j) {
+  j->invoke(*j);
+  j->destroy(*j);
+
+  counter *done = j->done;
+  if (j->heap) {
+    delete j;
+  } else {
+    j->busy.store(false, std::memory_order_release);
+  }
+
+  executed.fetch_add(1, std::memory_order_relaxed);
+  if (done) { finish(*done); }
+}
+
+jobs::job *jobs::scheduler::find(const int self) {
+  if (self >= 0) {
+    if (job *j = workers_[self]->deque.pop()) {
+      queued.fetch_sub(1);
+      return j;
+    }
+  }
+
+  if (self == 0) {
+    std::lock_guard<std::mutex> lock(main_lock);
+    if (!main_jobs.empty()) {
+      job *j = main_jobs.front();
+      main_jobs.pop_front();
+      return j;
+    }
+  }
+
+  // nothing left anywhere else either
+  if (queued.load() <= 0) { return nullptr; }
+
+  {
+    std::lock_guard<std::mutex> lock(injected_lock);
+    if (!injected.empty()) {
+      job *j = injected.front();
+      injected.pop_front();
+      queued.fetch_sub(1);
+      return j;
+    }
+  }
+
+  const int n = workers_.size();
+  const int start = self >= 0 ? self : 0;
+  for (int k = 1; k <= n; ++k) {
+    const int victim = (start + k) % n;
+    if (victim == self) { continue; }
+
+    if (job *j = workers_[victim]->deque.steal()) {
+      queued.fetch_sub(1);
+      stolen.fetch_add(1, std::memory_order_relaxed);
+      return j;
+    }
+  }
+
+  return nullptr;
+}
+
+void jobs::scheduler::wait(counter &c) {
+  const int self = index();
+  while (c.pending.load(std::memory_order_acquire) > 0) {
+    if (job *j = find(self)) {
+      execute(j);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  // the last job to finish may still be holding the counter's lock, and
+  // `c` is often about to go out of scope
+  std::lock_guard<std::mutex> lock(c.lock);
+}
+
+void jobs::scheduler::run_main_thread_jobs() {
+  if (!on_main_thread()) { return; }
+
+  std::deque<job *> ready;
+  {
+    std::lock_guard<std::mutex> lock(main_lock);
+    ready.swap(main_jobs);
+  }
+
+  // jobs queued while these run wait for the next call
+  for (job *j : ready) { execute(j); }
+
+  // with no workers, nobody else would ever take the queued jobs
+  if (threads_.empty()) {
+    while (job *j = find(0)) { execute(j); }
+  }
+}
+
+void jobs::scheduler::wait_for_main_thread_jobs() {
+  if (!on_main_thread()) { return; }
+
+  std::unique_lock<std::mutex> lock(main_lock);
+  main_ready.wait(lock, [this] {
+    return !main_jobs.empty() || (threads_.empty() && queued.load() > 0);
+  });
+}
+
+void jobs::scheduler::work(const int self) {
+  current = {this, self};
+
+  int idle = 0;
+  while (!stopping.load(std::memory_order_relaxed)) {
+    if (job *j = find(self)) {
+      execute(j);
+      idle = 0;
+      continue;
+    }
+
+    if (++idle < idle_spins) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_lock);
+    sleepers.fetch_add(1);
+    wake.wait(lock, [this] { return queued.load() > 0 || stopping.load(); });
+    sleepers.fetch_sub(1);
+    idle = 0;
+  }
+}
+
+jobs::scheduler &jobs::global() {
+  static scheduler s;
+  return s;
+}
@@ -0,0 +1,231 @@
+#ifndef __JOBS_HPP__
+#define __JOBS_HPP__
+/*
+  a job system with per-thread work-stealing deques
+
+  a scheduler runs one worker thread per extra core; the thread that
+  creates it takes part too and is its main thread. a job is any callable,
+  kept inline in a slot of the submitting thread's job pool (no allocation
+  for captures up to `inline_bytes`). a thread pushes the jobs it submits
+  onto the bottom of its own deque and pops them from there, most recent
+  first; idle workers steal the oldest from the top of someone else's.
+
+  completion is tracked by counters. every job submitted with a counter
+  adds one to it and takes one off when it finishes, so
+
+    jobs::counter done;
+    for (auto &chunk : chunks) { s.run([&] { work(chunk); }, &done); }
+    s.wait(done);
+
+  waits for all of them. a waiting thread runs other jobs instead of
+  blocking, which is what lets jobs wait on jobs without fibers. `run_after`
+  holds a job back until a counter reaches zero, for graphs of tasks.
+
+  jobs that must run on the main thread (anything touching gl) go on a
+  separate queue that only the main thread takes from, in
+  `run_main_thread_jobs` and whenever it waits. threads other than the
+  scheduler's own can submit too, through a shared injection queue.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jobs {
+  constexpr std::size_t inline_bytes = 48;
+  constexpr std::size_t deque_capacity = 4096; // jobs, a power of two
+  constexpr std::size_t pool_size = 4096; // jobs per thread
+
+  enum class affinity_t : std::uint8_t {
+    any,
+    main_thread
+  };
+
+  struct job;
+
+  class counter {
+  public:
+    counter() = default;
+    counter(const counter &) = delete;
+    counter &operator=(const counter &) = delete;
+
+    // jobs still to finish
+    int value() const { return pending.load(std::memory_order_acquire); }
+
+  private:
+    friend class scheduler;
+
+    std::atomic<int> pending{0};
+    std::mutex lock; // guards `continuations`
+    std::vector<job *> continuations;
+  };
+
+  struct job {
+    void (*invoke)(job &) = nullptr;
+    void (*destroy)(job &) = nullptr;
+    counter *done = nullptr;
+    affinity_t affinity = affinity_t::any;
+    bool heap = false; // submitted from outside the scheduler
+    std::atomic<bool> busy{false}; // pool slot in use
+    alignas(std::max_align_t) unsigned char storage[inline_bytes];
+
+    template <typename F>
+    static F *callable(job &j) {
+      return std::launder(reinterpret_cast<F *>(j.storage));
+    }
+
+    template <typename F>
+    void set(F &&f) {
+      using fn = std::decay_t<F>;
+      if constexpr (
+        sizeof(fn) <= inline_bytes && alignof(fn) <= alignof(std::max_align_t)
+      ) {
+        new (storage) fn(std::forward<F>(f));
+        invoke = [](job &j) { (*callable<fn>(j))(); };
+        destroy = [](job &j) { callable<fn>(j)->~fn(); };
+      } else {
+        // big captures are boxed
+        new (storage) fn *(new fn(std::forward<F>(f)));
+        invoke = [](job &j) { (**reinterpret_cast<fn **>(j.storage))(); };
+        destroy = [](job &j) { delete *reinterpret_cast<fn **>(j.storage); };
+      }
+    }
+  };
+
+  // chase-lev deque: the owner pushes and pops at the bottom, thieves take
+  // from the top
+  class work_deque {
+  public:
+    // false when full
+    bool push(job *j);
+    job *pop();
+    job *steal();
+
+  private:
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+    alignas(64) std::atomic<job *> slots[deque_capacity] = {};
+  };
+
+  class scheduler {
+  public:
+    // `workers` extra threads, by default one per core beyond this one
+    explicit scheduler(const int workers=-1);
+    ~scheduler();
+
+    scheduler(const scheduler &) = delete;
+    scheduler &operator=(const scheduler &) = delete;
+
+    template <typename F>
+    void run(
+      F &&f, counter *done=nullptr, const affinity_t a=affinity_t::any
+    ) {
+      job *j = make(std::forward<F>(f), done, a);
+      submit(j);
+    }
+
+    // `f` runs once `deps` has reached zero
+    template <typename F>
+    void run_after(
+      counter &deps, F &&f, counter *done=nullptr,
+      const affinity_t a=affinity_t::any
+    ) {
+      job *j = make(std::forward<F>(f), done, a);
+      defer(deps, j);
+    }
+
+    // runs other jobs until `c` reaches zero
+    void wait(counter &c);
+
+    // f(begin, end) over [0, n) in pieces of at most `grain`, waiting for
+    // all of them
+    template <typename F>
+    void parallel_for(const std::size_t n, const std::size_t grain, F &&f) {
+      if (n == 0) { return; }
+
+      counter done;
+      const std::size_t step = grain ? grain : 1;
+      for (std::size_t begin = step; begin < n; begin += step) {
+        const std::size_t end = std::min(begin + step, n);
+        run([&f, begin, end] { f(begin, end); }, &done);
+      }
+      f(std::size_t(0), std::min(step, n));
+      wait(done);
+    }
+
+    // call from the main thread, e.g. once a frame
+    void run_main_thread_jobs();
+    // blocks the main thread until run_main_thread_jobs has something to
+    // run
+    void wait_for_main_thread_jobs();
+    bool on_main_thread() const;
+
+    int threads() const { return int(threads_.size()) + 1; }
+
+    std::atomic<std::uint64_t> executed{0};
+    std::atomic<std::uint64_t> stolen{0};
+
+  private:
+    struct worker {
+      work_deque deque;
+      std::unique_ptr<job[]> pool{new job[pool_size]};
+      std::size_t next = 0; // pool slot to try first
+    };
+
+    template <typename F>
+    job *make(F &&f, counter *done, const affinity_t a) {
+      job *j = allocate();
+      j->set(std::forward<F>(f));
+      j->done = done;
+      j->affinity = a;
+      if (done) { done->pending.fetch_add(1, std::memory_order_relaxed); }
+
+      return j;
+    }
+
+    int index() const; // of the calling thread, -1 if not ours
+    job *allocate();
+    void submit(job *j);
+    void defer(counter &deps, job *j);
+    void finish(counter &c);
+    void execute(job *j);
+    // one job for thread `self` to run, or nullptr
+    job *find(const int self);
+    void work(const int self);
+
+    std::vector<std::unique_ptr<worker>> workers_; // 0 is the main thread
+    std::vector<std::thread> threads_;
+    // workers know their index from a thread local, the main thread is
+    // told apart by id so it can be the main thread of several schedulers
+    const std::thread::id main_thread = std::this_thread::get_id();
+
+    std::mutex injected_lock;
+    std::deque<job *> injected; // from threads outside the scheduler
+    std::mutex main_lock;
+    std::deque<job *> main_jobs;
+    std::condition_variable main_ready;
+
+    // sleeping workers are woken when `queued` goes up
+    std::atomic<std::int64_t> queued{0};
+    std::atomic<int> sleepers{0};
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+  };
+
+  // process wide scheduler, created on first use; the thread that first
+  // asks for it becomes its main thread
+  scheduler &global();
+};
+
+#endif // __JOBS_HPP__
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "memory.hpp"
+
+constexpr std::size_t frame_arena_size = std::size_t(1) << 20;
+
+static std::size_t alignUp(const std::size_t n, const std::size_t align) {
+  return (n + align - 1) & ~(align - 1);
+}
+
+mem::arena::arena(
+  const std::size_t capacity, std::pmr::memory_resource *upstream
+) :
+  upstream(upstream), block_size(alignUp(capacity, alignof(std::max_align_t)))
+{
+  if (block_size > 0) {
+    block = static_cast<std::byte *>(
+      upstream->allocate(block_size, alignof(std::max_align_t))
+    );
+  }
+}
+
+mem::arena::~arena() {
+  for (const auto &b : extra) { upstream->deallocate(b.p, b.bytes, b.align); }
+  if (block) {
+    upstream->deallocate(block, block_size, alignof(std::max_align_t));
+  }
+}
+
+void *mem::arena::do_allocate(
+  const std::size_t bytes, const std::size_t align
+) {
+  ++allocations;
+
+  const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block);
+  const std::size_t start = alignUp(base + head, align) - base;
+  if (block && start + bytes <= block_size) {
+    used_bytes += start + bytes - head;
+    head = start + bytes;
+    return block + start;
+  }
+
+  ++overflows;
+  void *p = upstream->allocate(bytes, align);
+  extra.push_back({p, bytes, align});
+  used_bytes += bytes;
+  return p;
+}
+
+bool mem::arena::do_is_equal(
+  const std::pmr::memory_resource &other
+) const noexcept {
+  return this == &other;
+}
+
+void mem::arena::reset() {
+  peak = std::max(peak, used_bytes);
+  ++resets;
+
+  if (!extra.empty()) {
+    for (const auto &b : extra) { upstream->deallocate(b.p, b.bytes, b.align); }
+    extra.clear();
+
+    // regrow to what this frame needed, with headroom, so the next fits
+    if (block) {
+      upstream->deallocate(block, block_size, alignof(std::max_align_t));
+    }
+    block_size = alignUp(used_bytes + used_bytes / 2, 4096);
+    block = static_cast<std::byte *>(
+      upstream->allocate(block_size, alignof(std::max_align_t))
+    );
+    ++grows;
+  }
+
+  head = 0;
+  used_bytes = 0;
+}
+
+mem::arena &mem::frame_arena() {
+  static arena a(frame_arena_size);
+  return a;
+}
+
+mem::pool_resource::pool_resource(
+  const std::size_t block_size, const std::size_t blocks_per_chunk,
+  std::pmr::memory_resource *upstream
+) :
+  upstream(upstream),
+  size(alignUp(
+    std::max(block_size, sizeof(free_block)), alignof(std::max_align_t)
+  )),
+  per_chunk(std::max<std::size_t>(blocks_per_chunk, 1)) {}
+
+mem::pool_resource::~pool_resource() {
+  for (void *c : chunk_list) {
+    upstream->deallocate(c, size * per_chunk, alignof(std::max_align_t));
+  }
+}
+
+void *mem::pool_resource::do_allocate(
+  const std::size_t bytes, const std::size_t align
+) {
+  ++allocations;
+
+  if (!fits(bytes, align)) {
+    ++fallbacks;
+    return upstream->allocate(bytes, align);
+  }
+
+  if (free_list == nullptr) {
+    auto *chunk = static_cast<std::byte *>(
+      upstream->allocate(size * per_chunk, alignof(std::max_align_t))
+    );
+    chunk_list.push_back(chunk);
+    ++chunks;
+
+    // thread the new blocks onto the free list, first block on top
+    for (std::size_t i = per_chunk; i-- > 0;) {
+      free_list = new (chunk + i * size) free_block{free_list};
+    }
+  }
+
+  free_block *b = free_list;
+  free_list = b->next;
+  peak_in_use = std::max(peak_in_use, ++in_use);
+  return b;
+}
+
+void mem::pool_resource::do_deallocate(
+  void *p, const std::size_t bytes, const std::size_t align
+) {
+  if (!fits(bytes, align)) {
+    upstream->deallocate(p, bytes, align);
+    return;
+  }
+
+  free_list = new (p) free_block{free_list};
+  --in_use;
+}
+
+bool mem::pool_resource::do_is_equal(
+  const std::pmr::memory_resource &other
+) const noexcept {
+  return this == &other;
+}
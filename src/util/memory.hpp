@@ -0,0 +1,148 @@
+#ifndef __MEMORY_HPP__
+#define __MEMORY_HPP__
+/*
+  arena and pool allocators, usable by std::pmr containers
+
+  `arena` hands out memory by bumping a pointer through one block and frees
+  everything at once on `reset`. when a frame needs more than the block,
+  extra blocks come from upstream; the next reset frees them and regrows
+  the block to the peak, so a steady frame ends up allocating nothing.
+  `frame_arena()` is reset after every buffer swap: anything allocated from
+  it is gone by the next frame.
+
+  `pool_resource` serves one block size from a free list carved out of
+  larger chunks, and passes anything bigger upstream; `object_pool<T>` is a
+  typed wrapper for handle-like objects. neither is thread safe.
+
+    std::pmr::vector<GLuint> ids(&mem::frame_arena());
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mem {
+  class arena : public std::pmr::memory_resource {
+  public:
+    explicit arena(
+      const std::size_t capacity,
+      std::pmr::memory_resource *upstream=std::pmr::new_delete_resource()
+    );
+    ~arena() override;
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    void reset();
+
+    std::size_t used() const { return used_bytes; }
+    std::size_t capacity() const { return block_size; }
+
+    std::uint64_t allocations = 0;
+    std::uint64_t overflows = 0; // allocations that went upstream
+    std::uint64_t resets = 0;
+    std::uint64_t grows = 0;
+    std::size_t peak = 0; // most bytes used between two resets
+
+  protected:
+    void *do_allocate(const std::size_t bytes, const std::size_t align)
+      override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override;
+
+  private:
+    struct overflow_block {
+      void *p;
+      std::size_t bytes;
+      std::size_t align;
+    };
+
+    std::pmr::memory_resource *upstream;
+    std::byte *block = nullptr;
+    std::size_t block_size = 0;
+    std::size_t head = 0;
+    std::size_t used_bytes = 0; // including overflow blocks
+    std::vector<overflow_block> extra;
+  };
+
+  // the per-frame arena, reset once a frame after the swap
+  arena &frame_arena();
+
+  class pool_resource : public std::pmr::memory_resource {
+  public:
+    explicit pool_resource(
+      const std::size_t block_size, const std::size_t blocks_per_chunk=64,
+      std::pmr::memory_resource *upstream=std::pmr::new_delete_resource()
+    );
+    ~pool_resource() override;
+
+    pool_resource(const pool_resource &) = delete;
+    pool_resource &operator=(const pool_resource &) = delete;
+
+    std::size_t block_size() const { return size; }
+
+    std::uint64_t allocations = 0;
+    std::uint64_t fallbacks = 0; // too big or too aligned for a block
+    std::size_t in_use = 0; // blocks
+    std::size_t peak_in_use = 0;
+    std::size_t chunks = 0;
+
+  protected:
+    void *do_allocate(const std::size_t bytes, const std::size_t align)
+      override;
+    void do_deallocate(
+      void *p, const std::size_t bytes, const std::size_t align
+    ) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override;
+
+  private:
+    struct free_block {
+      free_block *next;
+    };
+
+    bool fits(const std::size_t bytes, const std::size_t align) const {
+      return bytes <= size && align <= alignof(std::max_align_t);
+    }
+
+    std::pmr::memory_resource *upstream;
+    std::size_t size;
+    std::size_t per_chunk;
+    free_block *free_list = nullptr;
+    std::vector<void *> chunk_list;
+  };
+
+  template <typename T>
+  class object_pool {
+  public:
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    explicit object_pool(const std::size_t objects_per_chunk=64) :
+      pool(sizeof(T), objects_per_chunk) {}
+
+    template <typename... Args>
+    T *create(Args &&... args) {
+      void *p = pool.allocate(sizeof(T), alignof(T));
+      return new (p) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *t) {
+      if (t == nullptr) { return; }
+
+      t->~T();
+      pool.deallocate(t, sizeof(T), alignof(T));
+    }
+
+    std::size_t size() const { return pool.in_use; }
+    const pool_resource &resource() const { return pool; }
+
+  private:
+    pool_resource pool;
+  };
+};
+
+#endif // __MEMORY_HPP__
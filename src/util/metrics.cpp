@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "file_io.hpp"
+#include "metrics.hpp"
+
+namespace {
+  namespace fs = std::filesystem;
+
+  enum class kind_t {
+    counter,
+    gauge,
+    histogram
+  };
+
+  struct entry {
+    std::string name;
+    std::string help;
+    kind_t kind;
+    double scale = 1;
+    std::unique_ptr<metrics::counter> c;
+    std::unique_ptr<metrics::gauge> g;
+    std::unique_ptr<metrics::histogram> h;
+  };
+
+  // only registration and rendering lock, updates go straight to the
+  // metric objects, which never move
+  struct registry {
+    std::mutex m;
+    std::deque<entry> entries;
+  };
+
+  registry &instance() {
+    static registry r;
+    return r;
+  }
+
+  entry &add(
+    const std::string_view name, const std::string_view help,
+    const kind_t kind
+  ) {
+    registry &r = instance();
+    std::lock_guard<std::mutex> lock(r.m);
+
+    for (entry &e : r.entries) {
+      if (e.name != name) { continue; }
+
+      // the caller would be handed a metric of another kind, a bug in the
+      // names rather than anything to recover from
+      if (e.kind != kind) {
+        std::fprintf(
+          stderr, "metrics: %s is already registered as another kind\n",
+          e.name.c_str()
+        );
+        std::abort();
+      }
+      return e;
+    }
+
+    entry &e = r.entries.emplace_back();
+    e.name = name;
+    e.help = help;
+    e.kind = kind;
+    switch (kind) {
+      case kind_t::counter:
+        e.c = std::make_unique<metrics::counter>();
+        break;
+      case kind_t::gauge:
+        e.g = std::make_unique<metrics::gauge>();
+        break;
+      case kind_t::histogram:
+        e.h = std::make_unique<metrics::histogram>();
+        break;
+    }
+
+    return e;
+  }
+
+  constexpr double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+  void append(std::string &out, const char *fmt, const double v) {
+    char s[64];
+    std::snprintf(s, sizeof(s), fmt, v);
+    out += s;
+  }
+
+  void append_json_string(std::string &out, const std::string_view s) {
+    out += '"';
+    for (const char c : s) {
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char u[8];
+        std::snprintf(u, sizeof(u), "\\u%04x", unsigned(c));
+        out += u;
+      } else {
+        out += c;
+      }
+    }
+    out += '"';
+  }
+
+  void render_prometheus(const entry &e, std::string &out) {
+    out += "# HELP " + e.name + " ";
+    for (const char c : e.help) {
+      if (c == '\\') {
+        out += "\\\\";
+      } else if (c == '\n') {
+        out += "\\n";
+      } else {
+        out += c;
+      }
+    }
+    out += "\n";
+
+    switch (e.kind) {
+      case kind_t::counter:
+        out += "# TYPE " + e.name + " counter\n" + e.name;
+        out += " " + std::to_string(e.c->value()) + "\n";
+        break;
+      case kind_t::gauge:
+        out += "# TYPE " + e.name + " gauge\n" + e.name;
+        out += " " + std::to_string(e.g->value()) + "\n";
+        break;
+      case kind_t::histogram: {
+        // exported as a summary: hdr buckets are too many to send as
+        // prometheus buckets, quantiles computed here are exact to a bucket
+        const auto snap = e.h->read();
+        out += "# TYPE " + e.name + " summary\n";
+        for (const double q : quantiles) {
+          out += e.name;
+          append(out, "{quantile=\"%g\"}", q);
+          append(out, " %.10g\n", snap.quantile(q) * e.scale);
+        }
+        out += e.name + "_sum";
+        append(out, " %.10g\n", snap.sum * e.scale);
+        out += e.name + "_count " + std::to_string(snap.count) + "\n";
+        // a summary has no max sample, so it is a family of its own
+        out += "# HELP " + e.name + "_max largest value recorded\n";
+        out += "# TYPE " + e.name + "_max gauge\n" + e.name + "_max";
+        append(out, " %.10g\n", snap.max * e.scale);
+        break;
+      }
+    }
+  }
+
+  void render_json(const entry &e, std::string &out) {
+    out += "{\"name\":";
+    append_json_string(out, e.name);
+    out += ",\"help\":";
+    append_json_string(out, e.help);
+
+    switch (e.kind) {
+      case kind_t::counter:
+        out += ",\"type\":\"counter\",\"value\":";
+        out += std::to_string(e.c->value());
+        break;
+      case kind_t::gauge:
+        out += ",\"type\":\"gauge\",\"value\":";
+        out += std::to_string(e.g->value());
+        break;
+      case kind_t::histogram: {
+        const auto snap = e.h->read();
+        out += ",\"type\":\"histogram\",\"count\":";
+        out += std::to_string(snap.count);
+        out += ",\"sum\":";
+        append(out, "%.10g", snap.sum * e.scale);
+        out += ",\"max\":";
+        append(out, "%.10g", snap.max * e.scale);
+        out += ",\"quantiles\":{";
+        for (const double q : quantiles) {
+          if (q != quantiles[0]) { out += ','; }
+          append(out, "\"%g\":", q);
+          append(out, "%.10g", snap.quantile(q) * e.scale);
+        }
+        out += '}';
+        break;
+      }
+    }
+
+    out += '}';
+  }
+};
+
+std::size_t metrics::shard_index() {
+  static std::atomic<std::size_t> next{0};
+  thread_local const std::size_t index =
+    next.fetch_add(1, std::memory_order_relaxed) % shards;
+
+  return index;
+}
+
+std::uint64_t metrics::counter::value() const {
+  std::uint64_t total = 0;
+  for (const shard &x : s) { total += x.v.load(std::memory_order_relaxed); }
+
+  return total;
+}
+
+std::size_t metrics::histogram::bucket(const std::uint64_t v) {
+  if (v < sub_buckets) { return std::size_t(v); }
+
+  // the top sub_bits + 1 bits of v: an exponent and a linear sub-bucket
+  const int e = 63 - __builtin_clzll(v);
+  const std::size_t sub = std::size_t(v >> (e - sub_bits)) - sub_buckets;
+
+  return (e - sub_bits + 1) * sub_buckets + sub;
+}
+
+std::uint64_t metrics::histogram::bucket_lower(const std::size_t i) {
+  if (i < sub_buckets) { return i; }
+
+  const int e = int(i / sub_buckets) + sub_bits - 1;
+  const std::uint64_t m = i % sub_buckets + sub_buckets;
+  return m << (e - sub_bits);
+}
+
+void metrics::histogram::record(const std::uint64_t v) {
+  buckets[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(v, std::memory_order_relaxed);
+
+  std::uint64_t m = max.load(std::memory_order_relaxed);
+  while (v > m && !max.compare_exchange_weak(
+    m, v, std::memory_order_relaxed
+  )) {}
+}
+
+metrics::histogram::snapshot metrics::histogram::read() const {
+  snapshot s;
+  s.buckets.resize(bucket_count);
+
+  // not atomic as a whole; count is taken from the buckets so quantiles
+  // stay consistent with them
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    s.count += s.buckets[i];
+  }
+  s.sum = sum.load(std::memory_order_relaxed);
+  s.max = max.load(std::memory_order_relaxed);
+
+  return s;
+}
+
+std::uint64_t metrics::histogram::snapshot::quantile(const double q) const {
+  if (count == 0) { return 0; }
+
+  const std::uint64_t rank = std::max<std::uint64_t>(
+    1, std::uint64_t(std::ceil(std::clamp(q, 0.0, 1.0) * count))
+  );
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen < rank) { continue; }
+
+    const std::uint64_t upper = i + 1 < bucket_count ?
+      bucket_lower(i + 1) - 1 : ~std::uint64_t(0);
+    return std::min(upper, max);
+  }
+
+  return max;
+}
+
+metrics::timer::~timer() {
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  h.record(std::uint64_t(
+    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()
+  ));
+}
+
+metrics::counter &metrics::add_counter(
+  const std::string_view name, const std::string_view help
+) {
+  return *add(name, help, kind_t::counter).c;
+}
+
+metrics::gauge &metrics::add_gauge(
+  const std::string_view name, const std::string_view help
+) {
+  return *add(name, help, kind_t::gauge).g;
+}
+
+metrics::histogram &metrics::add_histogram(
+  const std::string_view name, const std::string_view help,
+  const double scale
+) {
+  entry &e = add(name, help, kind_t::histogram);
+  e.scale = scale;
+
+  return *e.h;
+}
+
+std::string metrics::render(const format_t f) {
+  registry &r = instance();
+  std::lock_guard<std::mutex> lock(r.m);
+
+  std::string out;
+  if (f == format_t::json) {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    out += "{\"timestamp_ms\":" + std::to_string(
+      std::chrono::duration_cast<std::chrono::milliseconds>(now).count()
+    );
+    out += ",\"metrics\":[";
+  }
+
+  for (const entry &e : r.entries) {
+    if (f == format_t::json) {
+      if (&e != &r.entries.front()) { out += ','; }
+      render_json(e, out);
+    } else {
+      render_prometheus(e, out);
+    }
+  }
+
+  if (f == format_t::json) { out += "]}\n"; }
+  return out;
+}
+
+bool metrics::write(const fs::path &p, const format_t f) {
+  const std::string data = render(f);
+
+  std::error_code ec;
+  fs::create_directories(p.parent_path(), ec);
+
+  const fs::path tmp = fio::temp_path(p);
+  bool written;
+  {
+    std::ofstream ofs(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs.write(data.data(), data.size());
+    ofs.close();
+    written = bool(ofs);
+  }
+
+  std::error_code rename_error;
+  if (written) { fs::rename(tmp, p, rename_error); }
+  if (!written || rename_error) {
+    fs::remove(tmp, ec);
+    return false;
+  }
+
+  return true;
+}
+
+metrics::exporter::exporter(
+  std::vector<std::pair<fs::path, format_t>> outputs,
+  const std::chrono::milliseconds interval
+) :
+  outputs(std::move(outputs)), interval(interval),
+  worker([this]() { run(); }) {}
+
+metrics::exporter::~exporter() {
+  {
+    std::lock_guard<std::mutex> lock(m);
+    stopping = true;
+  }
+  wake.notify_one();
+  worker.join();
+
+  dump();
+}
+
+void metrics::exporter::dump() {
+  for (const auto &[path, format] : outputs) {
+    if (write(path, format)) {
+      ++dumps;
+    } else {
+      ++failures;
+    }
+  }
+}
+
+void metrics::exporter::run() {
+  std::unique_lock<std::mutex> lock(m);
+  while (!wake.wait_for(lock, interval, [this]() { return stopping; })) {
+    lock.unlock();
+    dump();
+    lock.lock();
+  }
+}
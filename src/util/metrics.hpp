@@ -0,0 +1,164 @@
+#ifndef __METRICS_HPP__
+#define __METRICS_HPP__
+/*
+  process-wide metrics for scraping
+
+  counters, gauges and latency histograms registered by name and safe to
+  update from any thread without locks. a counter is split into
+  cache-line sized shards, one per thread (threads past `shards` share),
+  so threads counting the same thing never write the same line; reading
+  sums the shards.
+
+  histograms are hdr-style: 16 linear sub-buckets per power of two give
+  every recorded value a bucket within 1/16 of it, from 1 to 2^64, in
+  976 buckets. values are integers (microseconds for latencies) and are
+  scaled on export, so `_seconds` histograms record microseconds.
+
+  an `exporter` thread periodically renders the registry as prometheus
+  text or json and replaces its files atomically, so a scraper never reads
+  half a dump.
+*/
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+  constexpr std::size_t cache_line = 64;
+  constexpr std::size_t shards = 16;
+
+  // this thread's shard, assigned round robin on first use
+  std::size_t shard_index();
+
+  class counter {
+  public:
+    void add(const std::uint64_t n=1) {
+      s[shard_index()].v.fetch_add(n, std::memory_order_relaxed);
+    }
+    std::uint64_t value() const;
+
+  private:
+    struct alignas(cache_line) shard {
+      std::atomic<std::uint64_t> v{0};
+    };
+    std::array<shard, shards> s;
+  };
+
+  class gauge {
+  public:
+    void set(const std::int64_t x) { v.store(x, std::memory_order_relaxed); }
+    void add(const std::int64_t x) {
+      v.fetch_add(x, std::memory_order_relaxed);
+    }
+    std::int64_t value() const { return v.load(std::memory_order_relaxed); }
+
+  private:
+    alignas(cache_line) std::atomic<std::int64_t> v{0};
+  };
+
+  class histogram {
+  public:
+    static constexpr int sub_bits = 4;
+    static constexpr std::size_t sub_buckets = 1 << sub_bits;
+    static constexpr std::size_t bucket_count = sub_buckets * (65 - sub_bits);
+
+    static std::size_t bucket(const std::uint64_t v);
+    // smallest value landing in bucket `i`
+    static std::uint64_t bucket_lower(const std::size_t i);
+
+    void record(const std::uint64_t v);
+
+    struct snapshot {
+      std::uint64_t count = 0;
+      std::uint64_t sum = 0;
+      std::uint64_t max = 0;
+      std::vector<std::uint64_t> buckets;
+
+      // upper estimate of the value at quantile q (0 to 1)
+      std::uint64_t quantile(const double q) const;
+    };
+    snapshot read() const;
+
+  private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+    alignas(cache_line) std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> max{0};
+  };
+
+  // records the microseconds between construction and destruction
+  class timer {
+  public:
+    explicit timer(histogram &h) :
+      h(h), start(std::chrono::steady_clock::now()) {}
+    ~timer();
+
+    timer(const timer &) = delete;
+    timer &operator=(const timer &) = delete;
+
+  private:
+    histogram &h;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // names follow prometheus ([a-zA-Z_:][a-zA-Z0-9_:]*); adding a name again
+  // returns the metric already registered. a name is one kind of metric:
+  // asking for it as another kind aborts. a histogram also exports a
+  // `<name>_max` gauge, so that name is not free for another metric
+  counter &add_counter(
+    const std::string_view name, const std::string_view help
+  );
+  gauge &add_gauge(const std::string_view name, const std::string_view help);
+  histogram &add_histogram(
+    const std::string_view name, const std::string_view help,
+    const double scale=1e-6
+  );
+
+  enum class format_t {
+    prometheus,
+    json
+  };
+
+  std::string render(const format_t f);
+  // writes next to `p` and renames over it
+  bool write(const std::filesystem::path &p, const format_t f);
+
+  class exporter {
+  public:
+    exporter(
+      std::vector<std::pair<std::filesystem::path, format_t>> outputs,
+      const std::chrono::milliseconds interval
+    );
+    // writes a final dump
+    ~exporter();
+
+    exporter(const exporter &) = delete;
+    exporter &operator=(const exporter &) = delete;
+
+    std::atomic<std::uint64_t> dumps{0};
+    std::atomic<std::uint64_t> failures{0};
+
+  private:
+    void dump();
+    void run();
+
+    std::vector<std::pair<std::filesystem::path, format_t>> outputs;
+    std::chrono::milliseconds interval;
+    std::mutex m;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+  };
+};
+
+#endif // __METRICS_HPP__
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "alloc_track.hpp"
+#include "text.hpp"
+
+namespace {
+  // one entry per glyph from ' ': strokes separated by spaces, each a
+  // polyline of (x, y) digit pairs. a single point is a dot
+  const char *const strokes[text::glyph_count] = {
+    "", // ' '
+    "2924 22", "1917 3937", "1318 3338 0646 0444",
+    "483919080716354443321203 2921", "0249 08 43",
+    "4207081929380403122244", "2927", "39171432", "19373412",
+    "2824 0844 0448", "2824 0646", "2311", "0545", "22", "0249",
+    "120308193948433212 0348", "182922 1232", "08193948460242",
+    "08193948473616 364543321203", "32390444", "490906364543321203",
+    "39190803123243453606", "094912",
+    "16070819394847361605031232434536", "46160708193948433212",
+    "26 23", "26 2311", "480542", "0646 0444", "084502",
+    "08193948472524 22", "34141636344448391908031242",
+    "022942 1535", "02093948473606 3645433202", "4839190803123243",
+    "02092947442202", "49090242 0636", "490902 0636",
+    "48391908031232434525", "0209 4249 0646", "1939 2922 1232",
+    "4943321203", "0209 4905 1642", "090242", "0209254942", "02094249",
+    "120308193948433212", "02093948463505", "120308193948433212 2442",
+    "02093948463505 2542", "483919080716354443321203", "0949 2922",
+    "090312324349", "092249", "0912263249", "0942 0249", "092549 2522",
+    "09494202",
+    "39191131", "0942", "19393111", "072947", "0141", "1928",
+    "16364542 441403123243", "0902 0516364543321203", "461605031242",
+    "4942 4536160503123243", "044445361605031242", "4839291812 0636",
+    "4536160504133344 4641301001", "0902 0516364542", "2622 28",
+    "3631201001 38", "0902 3603 1432", "19292332",
+    "0206 05162522 25364542", "0206 0516364542", "120305163645433212",
+    "0600 0516364543321203", "4640 4536160503123243", "0602 042646",
+    "4616051434433202", "18132232 0636", "0603123243 4642", "062246",
+    "0612253246", "0642 0246", "0622 4610", "06464202",
+    "39282615242231", "2921", "19282635242211", "05163445"
+  };
+
+  struct segment {
+    float ax;
+    float ay;
+    float dx;
+    float dy;
+    float inv_len2; // 0 for a dot
+  };
+
+  void glyph_segments(const int glyph, std::vector<segment> &out) {
+    out.clear();
+
+    const char *s = strokes[glyph];
+    while (*s) {
+      if (*s == ' ') { ++s; continue; }
+
+      float px = s[0] - '0';
+      float py = s[1] - '0';
+      s += 2;
+      if (*s == '\0' || *s == ' ') {
+        out.push_back({px, py, 0, 0, 0});
+        continue;
+      }
+
+      for (; *s && *s != ' '; s += 2) {
+        const float x = s[0] - '0';
+        const float y = s[1] - '0';
+        const float dx = x - px;
+        const float dy = y - py;
+        out.push_back({px, py, dx, dy, 1 / (dx * dx + dy * dy)});
+        px = x;
+        py = y;
+      }
+    }
+  }
+
+  std::uint64_t hash(const std::string_view s, const float size) {
+    // fnv-1a, with the size folded in last
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (const char c : s) {
+      h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    }
+
+    std::uint32_t bits;
+    std::memcpy(&bits, &size, sizeof(bits));
+    return (h ^ bits) * 0x100000001b3ull;
+  }
+};
+
+void text::rasterise(const int glyph, std::uint8_t *out) {
+  static thread_local std::vector<segment> segments;
+  glyph_segments(glyph, segments);
+
+  constexpr float scale = 127 / spread;
+  for (int py = 0; py < cell_height; ++py) {
+    const float y = (py + 0.5f) / unit_px - pad;
+    for (int px = 0; px < cell_width; ++px) {
+      const float x = (px + 0.5f) / unit_px - pad;
+
+      float d2 = spread * spread * 4;
+      for (const segment &s : segments) {
+        const float rx = x - s.ax;
+        const float ry = y - s.ay;
+        const float t = std::clamp(
+          (rx * s.dx + ry * s.dy) * s.inv_len2, 0.0f, 1.0f
+        );
+        const float ex = rx - t * s.dx;
+        const float ey = ry - t * s.dy;
+        d2 = std::min(d2, ex * ex + ey * ey);
+      }
+
+      const float d = std::sqrt(d2) - stroke;
+      out[py * cell_width + px] = std::uint8_t(
+        std::clamp(128 - d * scale, 0.0f, 255.0f)
+      );
+    }
+  }
+}
+
+text::shelf_packer::shelf_packer(const int width, const int height) :
+  width(width), height(height) {}
+
+std::optional<text::rect> text::shelf_packer::pack(const int w, const int h) {
+  if (w <= 0 || h <= 0 || w > width) { return std::nullopt; }
+
+  shelf *best = nullptr;
+  for (shelf &s : shelves) {
+    if (s.h < h || s.h > h + h / 3 || width - s.x < w) { continue; }
+    if (!best || s.h < best->h) { best = &s; }
+  }
+
+  if (!best) {
+    if (height - top < h) { return std::nullopt; }
+    shelves.push_back({top, h, 0});
+    top += h;
+    best = &shelves.back();
+  }
+
+  const rect r{best->x, best->y, w, h};
+  best->x += w;
+  return r;
+}
+
+void text::shelf_packer::clear() {
+  shelves.clear();
+  top = 0;
+}
+
+void text::layout(const std::string_view s, const float size, run &out) {
+  ALLOC_SCOPE(text);
+  out.quads.clear();
+  out.width = 0;
+  out.lines = 1;
+
+  const float k = size / em;
+  const float left = -pad * k;
+  const float right = (glyph_width + pad) * k;
+  const float bottom = (-pad - baseline) * k;
+  const float top = (em + pad - baseline) * k;
+
+  float x = 0;
+  float y = 0;
+  for (const char c : s) {
+    if (c == '\n') {
+      out.width = std::max(out.width, x);
+      x = 0;
+      y -= line_height * k;
+      ++out.lines;
+      continue;
+    }
+
+    if (c != ' ') {
+      out.quads.push_back({
+        x + left, y + bottom, x + right, y + top,
+        std::uint16_t(glyph_index(c))
+      });
+    }
+    x += advance * k;
+  }
+
+  out.width = std::max(out.width, x);
+}
+
+text::run_cache::map::iterator text::run_cache::find(
+  map &m, const std::uint64_t key, const std::string_view s, const float size
+) {
+  auto [first, last] = m.equal_range(key);
+  for (; first != last; ++first) {
+    const entry &e = first->second;
+    if (e.size == size && e.text == s) { return first; }
+  }
+
+  return m.end();
+}
+
+const text::run &text::run_cache::get(
+  const std::string_view s, const float size
+) {
+  ALLOC_SCOPE(text);
+  const std::uint64_t key = hash(s, size);
+  if (auto i = find(current, key, s, size); i != current.end()) {
+    ++hits;
+    return i->second.r;
+  }
+
+  if (current.size() >= cap) {
+    previous.swap(current);
+    current.clear();
+  }
+
+  if (auto i = find(previous, key, s, size); i != previous.end()) {
+    ++hits;
+    entry &e = current.emplace(key, std::move(i->second))->second;
+    previous.erase(i);
+    return e.r;
+  }
+
+  ++misses;
+  entry &e = current.emplace(key, entry{std::string(s), size, {}})->second;
+  layout(s, size, e.r);
+  return e.r;
+}
+
+void text::run_cache::clear() {
+  current.clear();
+  previous.clear();
+}
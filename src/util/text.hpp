@@ -0,0 +1,132 @@
+#ifndef __TEXT_HPP__
+#define __TEXT_HPP__
+/*
+  signed distance field text, cpu side
+
+  glyphs come from a built-in stroke font (printable ascii, polylines on a
+  4 x 9 unit grid, baseline at y = 2), so their distance fields are exact:
+  the distance to the nearest segment minus half the stroke width. one
+  cell per glyph covers every text size. anything outside ascii draws as
+  '?'.
+
+  layout turns a string into quads in pixels relative to the baseline at
+  the start of the first line, and `run_cache` keeps the results for
+  strings laid out again (every hud label, every frame).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace text {
+  constexpr int first_glyph = 32;
+  constexpr int glyph_count = 95; // ' ' to '~'
+
+  // font units
+  constexpr float glyph_width = 4;
+  constexpr float em = 10; // descender to above the ascender
+  constexpr float baseline = 2;
+  constexpr float advance = 6;
+  constexpr float line_height = 12;
+
+  // distance field cell layout
+  constexpr int unit_px = 4;
+  constexpr int pad = 2; // units around the glyph box, covers the spread
+  constexpr int cell_width = (int(glyph_width) + 2 * pad) * unit_px;
+  constexpr int cell_height = (int(em) + 2 * pad) * unit_px;
+  constexpr float stroke = 0.5f; // half width, units
+  constexpr float spread = 2; // units from the outline to 0 or 255
+
+  inline int glyph_index(const char c) {
+    const int i = static_cast<unsigned char>(c) - first_glyph;
+    return i >= 0 && i < glyph_count ? i : '?' - first_glyph;
+  }
+
+  // writes cell_width * cell_height bytes, bottom row first: 128 on the
+  // outline, higher inside
+  void rasterise(const int glyph, std::uint8_t *out);
+
+  struct rect {
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    int h = 0;
+  };
+
+  // shelf packing for the glyph atlas: rects go left to right on the
+  // lowest shelf tall enough (and not wasting more than a quarter of it),
+  // a new shelf opens above when none fits
+  class shelf_packer {
+  public:
+    shelf_packer(const int width, const int height);
+
+    std::optional<rect> pack(const int w, const int h);
+    void clear();
+
+  private:
+    struct shelf {
+      int y;
+      int h;
+      int x;
+    };
+
+    int width;
+    int height;
+    int top = 0;
+    std::vector<shelf> shelves;
+  };
+
+  struct glyph_quad {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    std::uint16_t glyph;
+  };
+
+  struct run {
+    std::vector<glyph_quad> quads;
+    float width = 0;
+    int lines = 1;
+  };
+
+  // `size` is the em height in pixels; '\n' starts a new line below
+  void layout(const std::string_view s, const float size, run &out);
+
+  class run_cache {
+  public:
+    explicit run_cache(const std::size_t capacity=1024) : cap(capacity) {}
+
+    // valid until the next call
+    const run &get(const std::string_view s, const float size);
+    void clear();
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+  private:
+    struct entry {
+      std::string text;
+      float size;
+      run r;
+    };
+    using map = std::unordered_multimap<std::uint64_t, entry>;
+
+    map::iterator find(
+      map &m, const std::uint64_t key, const std::string_view s,
+      const float size
+    );
+
+    // two generations approximate lru without touching entries on a hit:
+    // anything not used since the last flip is dropped on the next one
+    std::size_t cap;
+    map current;
+    map previous;
+  };
+};
+
+#endif // __TEXT_HPP__
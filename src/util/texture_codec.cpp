@@ -0,0 +1,703 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "texture_codec.hpp"
+
+constexpr char magic[4] = {'Q', 'T', 'E', 'X'};
+constexpr std::uint32_t version = 1;
+
+using block_t = std::uint8_t[16][4]; // 4x4 texels, rgba
+
+texc::format_t texc::choose_format(const int channels, const caps &c) {
+  switch (channels) {
+    case 1: return format_t::bc4;
+    case 2: return format_t::bc5;
+    case 3:
+      if (c.bptc) { return format_t::bc7; }
+      if (c.s3tc) { return format_t::bc1; }
+      return format_t::rgb8;
+    default:
+      if (c.bptc) { return format_t::bc7; }
+      if (c.s3tc) { return format_t::bc3; }
+      return format_t::rgba8;
+  }
+}
+
+bool texc::is_block_format(const format_t f) {
+  return f >= format_t::bc1;
+}
+
+std::size_t texc::unit_size(const format_t f) {
+  switch (f) {
+    case format_t::r8: return 1;
+    case format_t::rg8: return 2;
+    case format_t::rgb8: return 3;
+    case format_t::rgba8: return 4;
+    case format_t::bc1: return 8;
+    case format_t::bc4: return 8;
+    default: return 16;
+  }
+}
+
+int texc::format_channels(const format_t f) {
+  switch (f) {
+    case format_t::r8: case format_t::bc4: return 1;
+    case format_t::rg8: case format_t::bc5: return 2;
+    case format_t::rgb8: case format_t::bc1: return 3;
+    default: return 4;
+  }
+}
+
+std::size_t texc::data_size(
+  const format_t f, const int width, const int height
+) {
+  if (is_block_format(f)) {
+    return std::size_t((width + 3) / 4) * ((height + 3) / 4) * unit_size(f);
+  }
+
+  return std::size_t(width) * height * unit_size(f);
+}
+
+const char *texc::format_name(const format_t f) {
+  switch (f) {
+    case format_t::r8: return "r8";
+    case format_t::rg8: return "rg8";
+    case format_t::rgb8: return "rgb8";
+    case format_t::rgba8: return "rgba8";
+    case format_t::bc1: return "bc1";
+    case format_t::bc3: return "bc3";
+    case format_t::bc4: return "bc4";
+    case format_t::bc5: return "bc5";
+    case format_t::bc7: return "bc7";
+  }
+
+  return "?";
+}
+
+std::optional<texc::format_t> texc::format_from_name(const char *name) {
+  for (std::uint32_t i = 0; i <= std::uint32_t(format_t::bc7); ++i) {
+    if (std::strcmp(name, format_name(format_t(i))) == 0) {
+      return format_t(i);
+    }
+  }
+
+  return {};
+}
+
+/*
+  helpers
+*/
+static void fetch_block(
+  const texc::image &img, const int bx, const int by, block_t &b
+) {
+  for (int y = 0; y < 4; ++y) {
+    const int sy = std::min(by * 4 + y, img.height - 1);
+    for (int x = 0; x < 4; ++x) {
+      const int sx = std::min(bx * 4 + x, img.width - 1);
+      const std::uint8_t *p =
+        &img.pixels[(std::size_t(sy) * img.width + sx) * img.channels];
+      std::uint8_t *t = b[y * 4 + x];
+
+      t[0] = p[0];
+      t[1] = img.channels > 1 ? p[1] : 0;
+      t[2] = img.channels > 2 ? p[2] : 0;
+      t[3] = img.channels > 3 ? p[3] : 255;
+    }
+  }
+}
+
+static void store_block(
+  texc::image &img, const int bx, const int by, const block_t &b
+) {
+  for (int y = 0; y < 4 && by * 4 + y < img.height; ++y) {
+    for (int x = 0; x < 4 && bx * 4 + x < img.width; ++x) {
+      std::uint8_t *p = &img.pixels[
+        (std::size_t(by * 4 + y) * img.width + bx * 4 + x) * 4
+      ];
+      std::memcpy(p, b[y * 4 + x], 4);
+    }
+  }
+}
+
+// principal axis of `n` dimensional points, returns false if they coincide
+static bool principal_axis(
+  const float (*pts)[4], const int dims, float mean[4], float axis[4]
+) {
+  float cov[4][4] = {};
+  for (int d = 0; d < dims; ++d) {
+    mean[d] = 0;
+    for (int i = 0; i < 16; ++i) { mean[d] += pts[i][d]; }
+    mean[d] /= 16;
+  }
+
+  for (int i = 0; i < 16; ++i) {
+    for (int a = 0; a < dims; ++a) {
+      for (int b = 0; b < dims; ++b) {
+        cov[a][b] += (pts[i][a] - mean[a]) * (pts[i][b] - mean[b]);
+      }
+    }
+  }
+
+  for (int d = 0; d < dims; ++d) { axis[d] = 1; }
+  for (int iter = 0; iter < 8; ++iter) {
+    float next[4] = {};
+    float len = 0;
+    for (int a = 0; a < dims; ++a) {
+      for (int b = 0; b < dims; ++b) { next[a] += cov[a][b] * axis[b]; }
+      len += next[a] * next[a];
+    }
+
+    if (len < 1e-12f) { return false; }
+    len = 1 / std::sqrt(len);
+    for (int d = 0; d < dims; ++d) { axis[d] = next[d] * len; }
+  }
+
+  return true;
+}
+
+static void bit_write(
+  std::uint8_t *out, int &pos, const std::uint32_t v, const int bits
+) {
+  for (int i = 0; i < bits; ++i, ++pos) {
+    if ((v >> i) & 1) { out[pos >> 3] |= 1 << (pos & 7); }
+  }
+}
+
+static std::uint32_t bit_read(const std::uint8_t *in, int &pos, const int bits) {
+  std::uint32_t v = 0;
+  for (int i = 0; i < bits; ++i, ++pos) {
+    v |= std::uint32_t((in[pos >> 3] >> (pos & 7)) & 1) << i;
+  }
+
+  return v;
+}
+
+/*
+  bc4: one channel, two 8 bit endpoints and 3 bit indices
+*/
+static void bc4_palette(const std::uint8_t r0, const std::uint8_t r1, int p[8]) {
+  p[0] = r0;
+  p[1] = r1;
+  if (r0 > r1) {
+    for (int i = 2; i < 8; ++i) { p[i] = ((8 - i) * r0 + (i - 1) * r1) / 7; }
+  } else {
+    for (int i = 2; i < 6; ++i) { p[i] = ((6 - i) * r0 + (i - 1) * r1) / 5; }
+    p[6] = 0;
+    p[7] = 255;
+  }
+}
+
+static void encode_bc4(const block_t &b, const int c, std::uint8_t out[8]) {
+  std::uint8_t lo = 255;
+  std::uint8_t hi = 0;
+  for (int i = 0; i < 16; ++i) {
+    lo = std::min(lo, b[i][c]);
+    hi = std::max(hi, b[i][c]);
+  }
+
+  int p[8];
+  bc4_palette(hi, lo, p);
+
+  std::memset(out, 0, 8);
+  out[0] = hi;
+  out[1] = lo;
+
+  int pos = 16;
+  for (int i = 0; i < 16; ++i) {
+    int best = 0;
+    for (int k = 1; k < 8; ++k) {
+      if (std::abs(p[k] - b[i][c]) < std::abs(p[best] - b[i][c])) { best = k; }
+    }
+    bit_write(out, pos, best, 3);
+  }
+}
+
+static void decode_bc4(const std::uint8_t in[8], block_t &b, const int c) {
+  int p[8];
+  bc4_palette(in[0], in[1], p);
+
+  int pos = 16;
+  for (int i = 0; i < 16; ++i) {
+    b[i][c] = p[bit_read(in, pos, 3)];
+  }
+}
+
+/*
+  bc1: rgb565 endpoints and 2 bit indices
+*/
+static std::uint16_t to_565(const float c[3]) {
+  const int r = std::clamp(int(std::lround(c[0] * 31 / 255)), 0, 31);
+  const int g = std::clamp(int(std::lround(c[1] * 63 / 255)), 0, 63);
+  const int b = std::clamp(int(std::lround(c[2] * 31 / 255)), 0, 31);
+
+  return (r << 11) | (g << 5) | b;
+}
+
+static void from_565(const std::uint16_t v, int c[3]) {
+  const int r = (v >> 11) & 31;
+  const int g = (v >> 5) & 63;
+  const int b = v & 31;
+  c[0] = (r << 3) | (r >> 2);
+  c[1] = (g << 2) | (g >> 4);
+  c[2] = (b << 3) | (b >> 2);
+}
+
+static void bc1_palette(
+  const std::uint16_t c0, const std::uint16_t c1, const bool four_colour,
+  int p[4][4]
+) {
+  from_565(c0, p[0]);
+  from_565(c1, p[1]);
+  p[0][3] = p[1][3] = 255;
+
+  for (int k = 0; k < 3; ++k) {
+    if (four_colour || c0 > c1) {
+      p[2][k] = (2 * p[0][k] + p[1][k]) / 3;
+      p[3][k] = (p[0][k] + 2 * p[1][k]) / 3;
+    } else {
+      p[2][k] = (p[0][k] + p[1][k]) / 2;
+      p[3][k] = 0;
+    }
+  }
+  p[2][3] = 255;
+  p[3][3] = (four_colour || c0 > c1) ? 255 : 0;
+}
+
+// picks indices for the endpoints, returns the squared error
+static int bc1_indices(
+  const block_t &b, const std::uint16_t c0, const std::uint16_t c1,
+  int idx[16]
+) {
+  int p[4][4];
+  bc1_palette(c0, c1, true, p);
+
+  int total = 0;
+  for (int i = 0; i < 16; ++i) {
+    int best_err = std::numeric_limits<int>::max();
+    for (int k = 0; k < 4; ++k) {
+      int err = 0;
+      for (int ch = 0; ch < 3; ++ch) {
+        const int d = p[k][ch] - b[i][ch];
+        err += d * d;
+      }
+      if (err < best_err) {
+        best_err = err;
+        idx[i] = k;
+      }
+    }
+    total += best_err;
+  }
+
+  return total;
+}
+
+static void encode_bc1(const block_t &b, std::uint8_t out[8]) {
+  float pts[16][4];
+  for (int i = 0; i < 16; ++i) {
+    for (int ch = 0; ch < 3; ++ch) { pts[i][ch] = b[i][ch]; }
+  }
+
+  float mean[4];
+  float axis[4];
+  std::uint16_t c0;
+  std::uint16_t c1;
+  int idx[16] = {};
+
+  if (!principal_axis(pts, 3, mean, axis)) {
+    c0 = c1 = to_565(mean);
+  } else {
+    float tmin = std::numeric_limits<float>::max();
+    float tmax = -tmin;
+    for (int i = 0; i < 16; ++i) {
+      float t = 0;
+      for (int ch = 0; ch < 3; ++ch) { t += (pts[i][ch] - mean[ch]) * axis[ch]; }
+      tmin = std::min(tmin, t);
+      tmax = std::max(tmax, t);
+    }
+
+    float e0[3];
+    float e1[3];
+    for (int ch = 0; ch < 3; ++ch) {
+      e0[ch] = mean[ch] + axis[ch] * tmax;
+      e1[ch] = mean[ch] + axis[ch] * tmin;
+    }
+    c0 = to_565(e0);
+    c1 = to_565(e1);
+    int err = bc1_indices(b, c0, c1, idx);
+
+    // one least squares pass over the chosen indices
+    constexpr float weight[4] = {0, 1, 1.0f / 3, 2.0f / 3};
+    float aa = 0;
+    float ab = 0;
+    float bb = 0;
+    float ax[3] = {};
+    float bx[3] = {};
+    for (int i = 0; i < 16; ++i) {
+      const float t = weight[idx[i]];
+      aa += (1 - t) * (1 - t);
+      ab += (1 - t) * t;
+      bb += t * t;
+      for (int ch = 0; ch < 3; ++ch) {
+        ax[ch] += (1 - t) * pts[i][ch];
+        bx[ch] += t * pts[i][ch];
+      }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) > 1e-6f) {
+      for (int ch = 0; ch < 3; ++ch) {
+        e0[ch] = (ax[ch] * bb - bx[ch] * ab) / det;
+        e1[ch] = (bx[ch] * aa - ax[ch] * ab) / det;
+      }
+
+      int refined_idx[16];
+      const std::uint16_t r0 = to_565(e0);
+      const std::uint16_t r1 = to_565(e1);
+      if (bc1_indices(b, r0, r1, refined_idx) < err) {
+        c0 = r0;
+        c1 = r1;
+        std::memcpy(idx, refined_idx, sizeof(idx));
+      }
+    }
+  }
+
+  // four colour mode needs c0 > c1
+  if (c0 < c1) {
+    std::swap(c0, c1);
+    for (int &i : idx) { i ^= 1; }
+  } else if (c0 == c1) {
+    for (int &i : idx) { i = 0; }
+  }
+
+  std::memset(out, 0, 8);
+  std::memcpy(out, &c0, 2);
+  std::memcpy(out + 2, &c1, 2);
+  int pos = 32;
+  for (int i = 0; i < 16; ++i) { bit_write(out, pos, idx[i], 2); }
+}
+
+static void decode_bc1(
+  const std::uint8_t in[8], block_t &b, const bool four_colour
+) {
+  std::uint16_t c0;
+  std::uint16_t c1;
+  std::memcpy(&c0, in, 2);
+  std::memcpy(&c1, in + 2, 2);
+
+  int p[4][4];
+  bc1_palette(c0, c1, four_colour, p);
+
+  int pos = 32;
+  for (int i = 0; i < 16; ++i) {
+    const int k = bit_read(in, pos, 2);
+    for (int ch = 0; ch < 4; ++ch) { b[i][ch] = p[k][ch]; }
+  }
+}
+
+/*
+  bc7 mode 6: one subset, rgba 7.7.7.7 endpoints with a p-bit each and
+  4 bit indices
+*/
+constexpr int bc7_weights[16] = {
+  0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+static int bc7_interp(const int e0, const int e1, const int w) {
+  return ((64 - w) * e0 + w * e1 + 32) >> 6;
+}
+
+static int bc7_indices(const block_t &b, const int e[2][4], int idx[16]) {
+  int p[16][4];
+  for (int k = 0; k < 16; ++k) {
+    for (int ch = 0; ch < 4; ++ch) {
+      p[k][ch] = bc7_interp(e[0][ch], e[1][ch], bc7_weights[k]);
+    }
+  }
+
+  int total = 0;
+  for (int i = 0; i < 16; ++i) {
+    int best_err = std::numeric_limits<int>::max();
+    for (int k = 0; k < 16; ++k) {
+      int err = 0;
+      for (int ch = 0; ch < 4; ++ch) {
+        const int d = p[k][ch] - b[i][ch];
+        err += d * d;
+      }
+      if (err < best_err) {
+        best_err = err;
+        idx[i] = k;
+      }
+    }
+    total += best_err;
+  }
+
+  return total;
+}
+
+static void encode_bc7(const block_t &b, std::uint8_t out[16]) {
+  float pts[16][4];
+  for (int i = 0; i < 16; ++i) {
+    for (int ch = 0; ch < 4; ++ch) { pts[i][ch] = b[i][ch]; }
+  }
+
+  float mean[4];
+  float axis[4];
+  float ends[2][4];
+  if (principal_axis(pts, 4, mean, axis)) {
+    float tmin = std::numeric_limits<float>::max();
+    float tmax = -tmin;
+    for (int i = 0; i < 16; ++i) {
+      float t = 0;
+      for (int ch = 0; ch < 4; ++ch) { t += (pts[i][ch] - mean[ch]) * axis[ch]; }
+      tmin = std::min(tmin, t);
+      tmax = std::max(tmax, t);
+    }
+    for (int ch = 0; ch < 4; ++ch) {
+      ends[0][ch] = mean[ch] + axis[ch] * tmin;
+      ends[1][ch] = mean[ch] + axis[ch] * tmax;
+    }
+  } else {
+    for (int ch = 0; ch < 4; ++ch) { ends[0][ch] = ends[1][ch] = mean[ch]; }
+  }
+
+  // try every p-bit combination and keep the best
+  int best_q[2][4] = {};
+  int best_p[2] = {};
+  int best_idx[16] = {};
+  int best_err = std::numeric_limits<int>::max();
+  for (int pb = 0; pb < 4; ++pb) {
+    const int p[2] = {pb & 1, pb >> 1};
+    int q[2][4];
+    int e[2][4];
+    for (int j = 0; j < 2; ++j) {
+      for (int ch = 0; ch < 4; ++ch) {
+        q[j][ch] = std::clamp(
+          int(std::lround((ends[j][ch] - p[j]) / 2)), 0, 127
+        );
+        e[j][ch] = (q[j][ch] << 1) | p[j];
+      }
+    }
+
+    int idx[16];
+    const int err = bc7_indices(b, e, idx);
+    if (err < best_err) {
+      best_err = err;
+      std::memcpy(best_q, q, sizeof(q));
+      std::memcpy(best_p, p, sizeof(p));
+      std::memcpy(best_idx, idx, sizeof(idx));
+    }
+  }
+
+  // the anchor index is stored with its top bit implied to be zero
+  if (best_idx[0] >= 8) {
+    for (int ch = 0; ch < 4; ++ch) { std::swap(best_q[0][ch], best_q[1][ch]); }
+    std::swap(best_p[0], best_p[1]);
+    for (int &i : best_idx) { i = 15 - i; }
+  }
+
+  std::memset(out, 0, 16);
+  int pos = 0;
+  bit_write(out, pos, 1 << 6, 7);
+  for (int ch = 0; ch < 4; ++ch) {
+    bit_write(out, pos, best_q[0][ch], 7);
+    bit_write(out, pos, best_q[1][ch], 7);
+  }
+  bit_write(out, pos, best_p[0], 1);
+  bit_write(out, pos, best_p[1], 1);
+  for (int i = 0; i < 16; ++i) {
+    bit_write(out, pos, best_idx[i], i == 0 ? 3 : 4);
+  }
+}
+
+static bool decode_bc7(const std::uint8_t in[16], block_t &b) {
+  // only mode 6 blocks, which is all this encoder writes
+  if ((in[0] & 0x7f) != (1 << 6)) { return false; }
+
+  int pos = 7;
+  int e[2][4];
+  for (int ch = 0; ch < 4; ++ch) {
+    e[0][ch] = bit_read(in, pos, 7) << 1;
+    e[1][ch] = bit_read(in, pos, 7) << 1;
+  }
+  const int p0 = bit_read(in, pos, 1);
+  const int p1 = bit_read(in, pos, 1);
+  for (int ch = 0; ch < 4; ++ch) {
+    e[0][ch] |= p0;
+    e[1][ch] |= p1;
+  }
+
+  for (int i = 0; i < 16; ++i) {
+    const int w = bc7_weights[bit_read(in, pos, i == 0 ? 3 : 4)];
+    for (int ch = 0; ch < 4; ++ch) {
+      b[i][ch] = bc7_interp(e[0][ch], e[1][ch], w);
+    }
+  }
+
+  return true;
+}
+
+/*
+  whole images
+*/
+texc::compressed_image texc::encode(const image &img, const format_t f) {
+  compressed_image c;
+  c.format = f;
+  c.width = img.width;
+  c.height = img.height;
+  c.channels = img.channels;
+  c.data.resize(data_size(f, img.width, img.height));
+
+  if (!is_block_format(f)) {
+    const int n = format_channels(f);
+    for (std::size_t i = 0; i < std::size_t(img.width) * img.height; ++i) {
+      for (int ch = 0; ch < n; ++ch) {
+        c.data[i * n + ch] = ch < img.channels ? img.pixels[i * img.channels + ch]
+          : ch == 3 ? 255 : 0;
+      }
+    }
+
+    return c;
+  }
+
+  const int bw = (img.width + 3) / 4;
+  const int bh = (img.height + 3) / 4;
+  std::uint8_t *out = c.data.data();
+  block_t b;
+
+  for (int by = 0; by < bh; ++by) {
+    for (int bx = 0; bx < bw; ++bx) {
+      fetch_block(img, bx, by, b);
+
+      switch (f) {
+        case format_t::bc1: encode_bc1(b, out); break;
+        case format_t::bc3: encode_bc4(b, 3, out); encode_bc1(b, out + 8); break;
+        case format_t::bc4: encode_bc4(b, 0, out); break;
+        case format_t::bc5: encode_bc4(b, 0, out); encode_bc4(b, 1, out + 8); break;
+        case format_t::bc7: encode_bc7(b, out); break;
+        default: break;
+      }
+
+      out += unit_size(f);
+    }
+  }
+
+  return c;
+}
+
+std::optional<texc::image> texc::decode(const compressed_image &c) {
+  if (c.data.size() < data_size(c.format, c.width, c.height)) { return {}; }
+
+  image img;
+  img.width = c.width;
+  img.height = c.height;
+  img.channels = 4;
+  img.pixels.resize(std::size_t(c.width) * c.height * 4);
+
+  if (!is_block_format(c.format)) {
+    const int n = format_channels(c.format);
+    for (std::size_t i = 0; i < std::size_t(c.width) * c.height; ++i) {
+      for (int ch = 0; ch < 4; ++ch) {
+        img.pixels[i * 4 + ch] = ch < n ? c.data[i * n + ch]
+          : ch == 3 ? 255 : 0;
+      }
+    }
+
+    return img;
+  }
+
+  const int bw = (c.width + 3) / 4;
+  const int bh = (c.height + 3) / 4;
+  const std::uint8_t *in = c.data.data();
+  block_t b;
+
+  for (int by = 0; by < bh; ++by) {
+    for (int bx = 0; bx < bw; ++bx) {
+      for (auto &t : b) { t[0] = t[1] = t[2] = 0; t[3] = 255; }
+
+      switch (c.format) {
+        case format_t::bc1: decode_bc1(in, b, false); break;
+        case format_t::bc3: decode_bc1(in + 8, b, true); decode_bc4(in, b, 3); break;
+        case format_t::bc4: decode_bc4(in, b, 0); break;
+        case format_t::bc5: decode_bc4(in, b, 0); decode_bc4(in + 8, b, 1); break;
+        case format_t::bc7:
+          if (!decode_bc7(in, b)) { return {}; }
+          break;
+        default: break;
+      }
+
+      store_block(img, bx, by, b);
+      in += unit_size(c.format);
+    }
+  }
+
+  return img;
+}
+
+bool texc::write(const std::filesystem::path &p, const compressed_image &c) {
+  std::ofstream ofs(p, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!ofs) { return false; }
+
+  const std::uint32_t header[6] = {
+    version, std::uint32_t(c.format), std::uint32_t(c.width),
+    std::uint32_t(c.height), std::uint32_t(c.channels),
+    std::uint32_t(c.data.size())
+  };
+  ofs.write(magic, sizeof(magic));
+  ofs.write(reinterpret_cast<const char *>(header), sizeof(header));
+  ofs.write(reinterpret_cast<const char *>(c.data.data()), c.data.size());
+
+  return bool(ofs);
+}
+
+std::optional<texc::compressed_image> texc::read(
+  const std::filesystem::path &p
+) {
+  std::ifstream ifs(p, std::ios::in | std::ios::binary);
+  if (!ifs) { return {}; }
+
+  char m[sizeof(magic)];
+  std::uint32_t header[6];
+  ifs.read(m, sizeof(m));
+  ifs.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (!ifs || std::memcmp(m, magic, sizeof(magic)) != 0) { return {}; }
+  if (header[0] != version || header[1] > std::uint32_t(format_t::bc7)) {
+    return {};
+  }
+
+  compressed_image c;
+  c.format = format_t(header[1]);
+  c.width = header[2];
+  c.height = header[3];
+  c.channels = header[4];
+  if (header[5] != data_size(c.format, c.width, c.height)) { return {}; }
+
+  c.data.resize(header[5]);
+  ifs.read(reinterpret_cast<char *>(c.data.data()), c.data.size());
+  if (!ifs) { return {}; }
+
+  return c;
+}
+
+double texc::psnr(const image &a, const image &b, const int channels) {
+  double sum = 0;
+  const std::size_t n = std::size_t(a.width) * a.height;
+  for (std::size_t i = 0; i < n; ++i) {
+    for (int ch = 0; ch < channels; ++ch) {
+      const double d = double(a.pixels[i * a.channels + ch])
+        - double(b.pixels[i * b.channels + ch]);
+      sum += d * d;
+    }
+  }
+
+  const double mse = sum / (double(n) * channels);
+  if (mse == 0) { return std::numeric_limits<double>::infinity(); }
+
+  return 10 * std::log10(255.0 * 255.0 / mse);
+}
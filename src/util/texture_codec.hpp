@@ -0,0 +1,75 @@
+#ifndef __TEXTURE_CODEC_HPP__
+#define __TEXTURE_CODEC_HPP__
+/*
+  cpu block compression for gpu texture formats
+
+  bc4/bc5 (rgtc, core in gl 3.0), bc1/bc3 (s3tc) and bc7 (bptc, mode 6 only)
+  encoders and decoders, plus the `.qtex` container written by the offline
+  `texcompress` and `bake` tools. nothing here touches gl, so it builds and
+  runs without a gpu.
+
+  qtex := "QTEX" u32:version u32:format u32:width u32:height u32:channels
+          u32:size u8[size]
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace texc {
+  enum class format_t : std::uint32_t {
+    r8 = 0,
+    rg8 = 1,
+    rgb8 = 2,
+    rgba8 = 3,
+    bc1 = 4, // s3tc dxt1, rgb
+    bc3 = 5, // s3tc dxt5, rgba
+    bc4 = 6, // rgtc1, r
+    bc5 = 7, // rgtc2, rg
+    bc7 = 8 // bptc unorm, rgba
+  };
+
+  struct caps {
+    bool s3tc = false;
+    bool bptc = false;
+  };
+
+  struct image {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<std::uint8_t> pixels; // tightly packed rows
+  };
+
+  struct compressed_image {
+    format_t format = format_t::rgba8;
+    int width = 0;
+    int height = 0;
+    int channels = 0; // of the source image
+    std::vector<std::uint8_t> data;
+  };
+
+  // best format for `channels` given what the target supports
+  format_t choose_format(const int channels, const caps &c);
+  bool is_block_format(const format_t f);
+  // bytes per 4x4 block, or per pixel for the uncompressed formats
+  std::size_t unit_size(const format_t f);
+  int format_channels(const format_t f);
+  std::size_t data_size(const format_t f, const int width, const int height);
+  const char *format_name(const format_t f);
+  std::optional<format_t> format_from_name(const char *name);
+
+  compressed_image encode(const image &img, const format_t f);
+  // always returns rgba8 pixels
+  std::optional<image> decode(const compressed_image &c);
+
+  bool write(const std::filesystem::path &p, const compressed_image &c);
+  std::optional<compressed_image> read(const std::filesystem::path &p);
+
+  // peak signal to noise ratio over the first `channels` channels, in db
+  double psnr(const image &a, const image &b, const int channels);
+};
+
+#endif // __TEXTURE_CODEC_HPP__
@@ -1,24 +1,34 @@
+#include <algorithm>
 #include <fstream>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "alloc_track.hpp"
+#include "metrics.hpp"
 #include "xdg.hpp"
 
-std::vector<xdg::path> split_dirs(std::string s) {
+static metrics::histogram &resolve_time = metrics::add_histogram(
+  "qogl_path_resolve_seconds", "time to resolve a data path"
+);
+static metrics::counter &resolve_misses = metrics::add_counter(
+  "qogl_path_resolve_misses_total", "data paths found in no directory"
+);
+
+std::vector<xdg::path> split_dirs(const std::string_view s) {
   std::vector<xdg::path> dirs;
+  dirs.reserve(std::count(s.begin(), s.end(), ':') + 1);
 
-  std::size_t pos = 0;
-  std::string dir;
+  std::size_t start = 0;
+  while (true) {
+    const std::size_t end = s.find(':', start);
+    dirs.emplace_back(s.substr(start, end - start));
+    if (end == std::string_view::npos) { break; }
 
-  while ((pos = s.find(":")) != std::string::npos) {
-    dir = s.substr(0, pos);
-    dirs.push_back(dir);
-    s.erase(0, pos + 1);
+    start = end + 1;
   }
 
-  dirs.push_back(s);
-
   return dirs;
 }
 
@@ -75,6 +85,9 @@ xdg::base xdg::get_base_directories() {
 std::optional<xdg::path> xdg::get_data_path(
   const base &b, const std::string &name, const path &p, const bool create
 ) {
+  ALLOC_SCOPE(paths);
+  metrics::timer timer(resolve_time);
+
   path home_path = b.xdg_data_home / name / p;
   if (fs::is_regular_file(home_path)) {
     return fs::canonical(home_path);
@@ -101,5 +114,6 @@ std::optional<xdg::path> xdg::get_data_path(
     return fs::canonical(cwd_path);
   }
 
+  resolve_misses.add();
   return {};
 }
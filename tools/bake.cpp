@@ -0,0 +1,174 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "../src/util/asset_db.hpp"
+#include "../src/util/error.hpp"
+#include "../src/util/image_decode.hpp"
+#include "../src/util/texture_codec.hpp"
+#include "../src/util/xdg.hpp"
+
+namespace fs = std::filesystem;
+
+void usage(const char *name);
+bool is_image(const fs::path &p);
+bool compress(
+  const fs::path &in, const fs::path &out, const texc::caps &caps,
+  const std::optional<texc::format_t> format
+);
+
+// bakes a `.qtex` next to every image under a data directory, rebuilding
+// only the ones whose source or settings changed since the last run
+int main(int argc, const char *argv[]) {
+  texc::caps caps{true, true};
+  std::optional<texc::format_t> format;
+  bool force = false;
+  std::optional<fs::path> db_path;
+  const char *data_dir = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--force") == 0) {
+      force = true;
+    } else if (std::strcmp(argv[i], "--no-s3tc") == 0) {
+      caps.s3tc = false;
+    } else if (std::strcmp(argv[i], "--no-bptc") == 0) {
+      caps.bptc = false;
+    } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      format = texc::format_from_name(argv[++i]);
+      if (!format) {
+        std::cerr << "unknown format: " << argv[i] << "\n";
+        usage(argv[0]);
+        return to_underlying(error_code_t::bad_arg);
+      }
+    } else if (std::strcmp(argv[i], "--db") == 0 && i + 1 < argc) {
+      db_path = argv[++i];
+    } else if (data_dir == nullptr) {
+      data_dir = argv[i];
+    } else {
+      usage(argv[0]);
+      return to_underlying(error_code_t::too_many_args);
+    }
+  }
+
+  if (data_dir == nullptr) {
+    usage(argv[0]);
+    return to_underlying(error_code_t::not_enough_args);
+  }
+
+  if (!db_path) {
+    db_path = xdg::get_base_directories().xdg_cache_home / "qogl" /
+      "assets.db";
+  }
+  auto db = assetdb::open(*db_path);
+  if (!db) {
+    std::cerr << "could not open: " << *db_path << "\n";
+    return to_underlying(error_code_t::file_write_failed);
+  }
+  if (force) { assetdb::clear(*db); }
+
+  // everything the output depends on besides the source
+  std::string params = std::string("s3tc=") + (caps.s3tc ? "1" : "0");
+  params += std::string(" bptc=") + (caps.bptc ? "1" : "0");
+  params += " format=";
+  params += format ? texc::format_name(*format) : "auto";
+
+  // sources that share a stem, say foo.png and foo.jpg, would both bake
+  // to foo.qtex; only the first found is baked and the run fails
+  std::uint64_t duplicates = 0;
+  std::error_code ec;
+  for (const auto &e : fs::recursive_directory_iterator(data_dir, ec)) {
+    if (!e.is_regular_file() || !is_image(e.path())) { continue; }
+
+    assetdb::rule r;
+    r.tool = "texcompress";
+    r.params = params;
+    r.inputs = {e.path()};
+    r.outputs = {fs::path(e.path()).replace_extension(".qtex")};
+    r.build = [caps, format](
+      const std::vector<fs::path> &in, const std::vector<fs::path> &out
+    ) {
+      return compress(in[0], out[0], caps, format);
+    };
+    const fs::path out = r.outputs[0];
+    if (!assetdb::add(*db, std::move(r))) {
+      std::cerr << "skipping " << e.path() << ": another source already ";
+      std::cerr << "bakes to " << out << "\n";
+      ++duplicates;
+    }
+  }
+  if (ec) {
+    std::cerr << "could not read: " << data_dir << "\n";
+    return to_underlying(error_code_t::file_read_failed);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  const bool ok = assetdb::build_all(*db);
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << db->built << " built, " << db->skipped << " up to date, ";
+  std::cout << db->failed << " failed, " << db->hashed << " files hashed in ";
+  std::cout << std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << " ms\n";
+  if (duplicates > 0) {
+    std::cerr << duplicates << " source(s) skipped for a duplicate output\n";
+  }
+
+  if (!assetdb::save(*db)) {
+    std::cerr << "could not write: " << *db_path << "\n";
+    return to_underlying(error_code_t::file_write_failed);
+  }
+
+  if (!ok) { return to_underlying(error_code_t::file_read_failed); }
+
+  return duplicates > 0 ? to_underlying(error_code_t::duplicate_output) : 0;
+}
+
+void usage(const char *name) {
+  std::cerr << "usage: " << name;
+  std::cerr << " [--format r8|rg8|rgb8|rgba8|bc1|bc3|bc4|bc5|bc7]";
+  std::cerr << " [--no-s3tc] [--no-bptc] [--force] [--db <assets.db>]";
+  std::cerr << " <data dir>\n";
+}
+
+bool is_image(const fs::path &p) {
+  const std::string ext = p.extension().string();
+  return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" ||
+    ext == ".tga";
+}
+
+bool compress(
+  const fs::path &in, const fs::path &out, const texc::caps &caps,
+  const std::optional<texc::format_t> format
+) {
+  // as texcompress: source channels, flipped to match loadTexture
+  imgdec::options opts;
+  std::vector<std::uint8_t> file;
+  texc::image img;
+  const auto info = imgdec::decode(in, opts, file, img.pixels);
+  if (!info) {
+    std::cerr << "could not load image: " << in << "\n";
+    return false;
+  }
+  img.width = info->width;
+  img.height = info->height;
+  img.channels = info->channels;
+
+  const texc::format_t f = format ? *format
+    : texc::choose_format(img.channels, caps);
+  const texc::compressed_image c = texc::encode(img, f);
+  if (!texc::write(out, c)) {
+    std::cerr << "could not write: " << out << "\n";
+    return false;
+  }
+
+  std::cout << in.string() << " -> " << texc::format_name(f) << ", ";
+  std::cout << c.data.size() << " bytes\n";
+
+  return true;
+}
@@ -0,0 +1,72 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "../src/util/error.hpp"
+#include "../src/util/event_log.hpp"
+
+// quote a field for csv output if it contains a separator, quote or newline
+std::string csv_field(const std::string &s);
+
+int main(int argc, const char *argv[]) {
+  bool csv = false;
+  const char *path = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (path == nullptr) {
+      path = argv[i];
+    } else {
+      return to_underlying(error_code_t::too_many_args);
+    }
+  }
+
+  if (path == nullptr) {
+    std::cerr << "usage: " << argv[0] << " [--csv] <file.evlog>\n";
+    return to_underlying(error_code_t::not_enough_args);
+  }
+
+  auto log = evlog::read(path);
+  if (!log) {
+    std::cerr << "could not read event log: " << path << "\n";
+    return to_underlying(error_code_t::file_read_failed);
+  }
+
+  if (csv) {
+    std::cout << "timestamp_ns,event_id,format,message\n";
+  }
+
+  for (const auto &e : log->events) {
+    const std::string msg = evlog::format(*log, e);
+
+    if (csv) {
+      const std::string fmt =
+        e.id < log->strings.size() ? log->strings[e.id] : "";
+      std::cout << e.timestamp_ns << "," << e.id << ",";
+      std::cout << csv_field(fmt) << "," << csv_field(msg) << "\n";
+    } else {
+      std::cout << "[" << std::fixed << std::setprecision(6);
+      std::cout << std::setw(12) << e.timestamp_ns / 1e9 << "] " << msg << "\n";
+    }
+  }
+
+  return 0;
+}
+
+std::string csv_field(const std::string &s) {
+  if (s.find_first_of(",\"\n") == std::string::npos) {
+    return s;
+  }
+
+  std::string out = "\"";
+  for (const char c : s) {
+    if (c == '"') { out += '"'; }
+    out += c;
+  }
+  out += "\"";
+
+  return out;
+}
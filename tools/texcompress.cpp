@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "../src/util/error.hpp"
+#include "../src/util/texture_codec.hpp"
+
+void usage(const char *name);
+
+int main(int argc, const char *argv[]) {
+  texc::caps caps{true, true};
+  std::optional<texc::format_t> format;
+  const char *in_path = nullptr;
+  const char *out_path = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--no-s3tc") == 0) {
+      caps.s3tc = false;
+    } else if (std::strcmp(argv[i], "--no-bptc") == 0) {
+      caps.bptc = false;
+    } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      format = texc::format_from_name(argv[++i]);
+      if (!format) {
+        std::cerr << "unknown format: " << argv[i] << "\n";
+        usage(argv[0]);
+        return to_underlying(error_code_t::bad_arg);
+      }
+    } else if (in_path == nullptr) {
+      in_path = argv[i];
+    } else if (out_path == nullptr) {
+      out_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return to_underlying(error_code_t::too_many_args);
+    }
+  }
+
+  if (out_path == nullptr) {
+    usage(argv[0]);
+    return to_underlying(error_code_t::not_enough_args);
+  }
+
+  // match loadTexture, which flips on load
+  stbi_set_flip_vertically_on_load(true);
+
+  texc::image img;
+  unsigned char *data = stbi_load(
+    in_path, &img.width, &img.height, &img.channels, 0
+  );
+  if (data == nullptr) {
+    std::cerr << "could not load image: " << in_path << "\n";
+    return to_underlying(error_code_t::file_read_failed);
+  }
+  img.pixels.assign(
+    data, data + std::size_t(img.width) * img.height * img.channels
+  );
+  stbi_image_free(data);
+
+  if (!format) {
+    format = texc::choose_format(img.channels, caps);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  const texc::compressed_image c = texc::encode(img, *format);
+  auto end = std::chrono::steady_clock::now();
+
+  if (!texc::write(out_path, c)) {
+    std::cerr << "could not write: " << out_path << "\n";
+    return to_underlying(error_code_t::file_write_failed);
+  }
+
+  std::cout << in_path << ": " << img.width << "x" << img.height << "x";
+  std::cout << img.channels << " -> " << texc::format_name(*format) << ", ";
+  std::cout << c.data.size() << " bytes in ";
+  std::cout << std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << " ms";
+
+  if (auto decoded = texc::decode(c)) {
+    const int channels = std::min(
+      img.channels, texc::format_channels(*format)
+    );
+    std::cout << ", psnr " << texc::psnr(img, *decoded, channels) << " db";
+  }
+  std::cout << "\n";
+
+  return 0;
+}
+
+void usage(const char *name) {
+  std::cerr << "usage: " << name;
+  std::cerr << " [--format r8|rg8|rgb8|rgba8|bc1|bc3|bc4|bc5|bc7]";
+  std::cerr << " [--no-s3tc] [--no-bptc] <image> <out.qtex>\n";
+}